@@ -0,0 +1,32 @@
+#include "audio_clip.h"
+#include <format>
+#include <fstream>
+#include "wav_file.h"
+#include "../core/memory_tracker.h"
+
+namespace TriHarder {
+
+    Result<SharedPtr<AudioClip>> AudioClip::load(const String& path) {
+        MemoryTagScope scope(MemoryTag::Assets);
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return Result<SharedPtr<AudioClip>>::error(std::format("Failed to open {}", path));
+        }
+
+        auto format = readWavHeader(file);
+        if (format.is_error()) {
+            return Result<SharedPtr<AudioClip>>::error(std::format("{}: {}", path, format.unwrap_err()));
+        }
+
+        auto wav = format.unwrap();
+        std::vector<float> samples(wav.FrameCount * wav.Channels);
+        std::vector<uint8_t> scratch;
+        size_t frames = readWavFrames(file, wav, samples.data(), wav.FrameCount, scratch);
+        samples.resize(frames * wav.Channels);
+        return Result<SharedPtr<AudioClip>>::ok(fromSamples(std::move(samples), wav.Channels, wav.SampleRate));
+    }
+
+    SharedPtr<AudioClip> AudioClip::fromSamples(std::vector<float> samples, uint32_t channels, uint32_t sampleRate) {
+        return SharedPtr<AudioClip>(new AudioClip(std::move(samples), channels, sampleRate));
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../triharder.h"
+#include "../core/result.h"
+
+namespace TriHarder {
+
+    //! @class AudioClip
+    //! @brief A short sound fully decoded to interleaved float samples.
+    //!
+    //! Clips keep their original sample rate, the mixer resamples them while playing.
+    //! Use an AudioStream for long tracks that should not be held in memory.
+    class AudioClip {
+    public:
+        //! Decodes a WAV file, see readWavHeader() for the supported formats.
+        static Result<SharedPtr<AudioClip>> load(const String& path);
+
+        //! Creates a clip from interleaved samples, e.g. procedurally generated sounds.
+        static SharedPtr<AudioClip> fromSamples(std::vector<float> samples, uint32_t channels, uint32_t sampleRate);
+
+        [[nodiscard]] const float* getSamples() const { return samples_.data(); }
+        [[nodiscard]] uint64_t getFrameCount() const { return samples_.size() / channels_; }
+        [[nodiscard]] uint32_t getChannels() const { return channels_; }
+        [[nodiscard]] uint32_t getSampleRate() const { return sampleRate_; }
+
+    private:
+        AudioClip(std::vector<float> samples, uint32_t channels, uint32_t sampleRate)
+            : samples_(std::move(samples)), channels_(channels), sampleRate_(sampleRate) {}
+
+        std::vector<float> samples_;
+        uint32_t channels_;
+        uint32_t sampleRate_;
+    };
+}
@@ -0,0 +1,466 @@
+#include "audio_mixer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define TRIHARDER_AUDIO_SSE2 1
+#endif
+
+namespace TriHarder {
+
+    //! Largest ratio of source frames to output frames, bounds the stream windows.
+    static constexpr double MaxStep = 8.0;
+    static constexpr size_t CommandQueueSize = 1024;
+
+    static VoiceHandle makeHandle(uint32_t slot, uint32_t generation) {
+        return VoiceHandle(generation) << 32 | slot;
+    }
+
+    //! Reads frames from position on with linear interpolation into planar buffers.
+    //! Mono sources only fill left. Stops before the first frame at or past limit.
+    //! @param wrap The frame after the last one is the first frame instead of the last one repeated.
+    //! @return Number of frames produced.
+    static uint32_t resample(const float* samples, uint64_t sourceFrames, uint64_t limit, uint32_t channels, bool wrap,
+                             double& position, double step, float* left, float* right, uint32_t count) {
+        if (step == 1.0 && position == std::floor(position)) {
+            // Source and output run at the same rate, nothing to interpolate
+            auto start = static_cast<uint64_t>(position);
+            auto frames = static_cast<uint32_t>(std::min<uint64_t>(count, limit > start ? limit - start : 0));
+            if (channels == 1) {
+                std::memcpy(left, samples + start, frames * sizeof(float));
+            } else {
+                const float* source = samples + start * 2;
+                for (uint32_t i = 0; i < frames; ++i) {
+                    left[i] = source[i * 2];
+                    right[i] = source[i * 2 + 1];
+                }
+            }
+            position += frames;
+            return frames;
+        }
+
+        uint32_t produced = 0;
+        for (; produced < count; ++produced) {
+            auto index = static_cast<uint64_t>(position);
+            if (index >= limit) {
+                break;
+            }
+            auto t = static_cast<float>(position - double(index));
+            uint64_t next = index + 1 < sourceFrames ? index + 1 : (wrap ? 0 : index);
+            if (channels == 1) {
+                float a = samples[index];
+                left[produced] = a + (samples[next] - a) * t;
+            } else {
+                float a = samples[index * 2];
+                float b = samples[index * 2 + 1];
+                left[produced] = a + (samples[next * 2] - a) * t;
+                right[produced] = b + (samples[next * 2 + 1] - b) * t;
+            }
+            position += step;
+        }
+        return produced;
+    }
+
+    //! Adds the voice to the mix while ramping its gains from gain0 to gain1 across the block.
+    static void accumulate(float* mixLeft, float* mixRight, const float* left, const float* right, uint32_t frames,
+                           const float gain0[2], const float gain1[2]) {
+        float deltaLeft = (gain1[0] - gain0[0]) / float(frames);
+        float deltaRight = (gain1[1] - gain0[1]) / float(frames);
+        uint32_t i = 0;
+#ifdef TRIHARDER_AUDIO_SSE2
+        __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        __m128 gainLeft = _mm_add_ps(_mm_set1_ps(gain0[0]), _mm_mul_ps(lane, _mm_set1_ps(deltaLeft)));
+        __m128 gainRight = _mm_add_ps(_mm_set1_ps(gain0[1]), _mm_mul_ps(lane, _mm_set1_ps(deltaRight)));
+        __m128 stepLeft = _mm_set1_ps(deltaLeft * 4.0f);
+        __m128 stepRight = _mm_set1_ps(deltaRight * 4.0f);
+        for (; i + 4 <= frames; i += 4) {
+            __m128 l = _mm_loadu_ps(left + i);
+            __m128 r = _mm_loadu_ps(right + i);
+            _mm_storeu_ps(mixLeft + i, _mm_add_ps(_mm_loadu_ps(mixLeft + i), _mm_mul_ps(l, gainLeft)));
+            _mm_storeu_ps(mixRight + i, _mm_add_ps(_mm_loadu_ps(mixRight + i), _mm_mul_ps(r, gainRight)));
+            gainLeft = _mm_add_ps(gainLeft, stepLeft);
+            gainRight = _mm_add_ps(gainRight, stepRight);
+        }
+#endif
+        for (; i < frames; ++i) {
+            mixLeft[i] += left[i] * (gain0[0] + deltaLeft * float(i));
+            mixRight[i] += right[i] * (gain0[1] + deltaRight * float(i));
+        }
+    }
+
+    //! Applies the master gain ramp, clamps to [-1, 1] and interleaves into the output.
+    static void interleave(float* output, const float* mixLeft, const float* mixRight, uint32_t frames,
+                           float gain0, float gain1) {
+        float delta = (gain1 - gain0) / float(frames);
+        uint32_t i = 0;
+#ifdef TRIHARDER_AUDIO_SSE2
+        __m128 gain = _mm_add_ps(_mm_set1_ps(gain0), _mm_mul_ps(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f), _mm_set1_ps(delta)));
+        __m128 step = _mm_set1_ps(delta * 4.0f);
+        __m128 low = _mm_set1_ps(-1.0f);
+        __m128 high = _mm_set1_ps(1.0f);
+        for (; i + 4 <= frames; i += 4) {
+            __m128 l = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(mixLeft + i), gain), low), high);
+            __m128 r = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(mixRight + i), gain), low), high);
+            _mm_storeu_ps(output + i * 2, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(output + i * 2 + 4, _mm_unpackhi_ps(l, r));
+            gain = _mm_add_ps(gain, step);
+        }
+#endif
+        for (; i < frames; ++i) {
+            float gain = gain0 + delta * float(i);
+            output[i * 2] = std::clamp(mixLeft[i] * gain, -1.0f, 1.0f);
+            output[i * 2 + 1] = std::clamp(mixRight[i] * gain, -1.0f, 1.0f);
+        }
+    }
+
+    //! Constant power panning for mono sources, a balance control for stereo sources.
+    static void computeGains(float gain, float pan, uint32_t channels, float gains[2]) {
+        pan = std::clamp(pan, -1.0f, 1.0f);
+        if (channels == 1) {
+            float angle = (pan + 1.0f) * std::numbers::pi_v<float> * 0.25f;
+            gains[0] = gain * std::cos(angle);
+            gains[1] = gain * std::sin(angle);
+        } else {
+            gains[0] = gain * std::min(1.0f, 1.0f - pan);
+            gains[1] = gain * std::min(1.0f, 1.0f + pan);
+        }
+    }
+
+    static double computeStep(float pitch, float sourceRateRatio) {
+        pitch = std::clamp(pitch, 1.0f / AudioMixer::MaxPitch, AudioMixer::MaxPitch);
+        return std::min(double(pitch) * double(sourceRateRatio), MaxStep);
+    }
+
+    AudioMixer::AudioMixer(uint32_t sampleRate, uint32_t maxVoices, uint32_t blockFrames)
+        : sampleRate_(sampleRate), blockFrames_(std::max(blockFrames, 4u)),
+          windowCapacity_(static_cast<size_t>(std::ceil(double(blockFrames_) * MaxStep)) + 4),
+          slots_(maxVoices), voices_(maxVoices), commands_(CommandQueueSize), finished_(maxVoices),
+          voiceLeft_(blockFrames_), voiceRight_(blockFrames_), mixLeft_(blockFrames_), mixRight_(blockFrames_) {
+        activeVoices_.reserve(maxVoices);
+        for (auto& voice : voices_) {
+            voice.Window.resize(windowCapacity_ * 2);
+        }
+    }
+
+    VoiceHandle AudioMixer::play(SharedPtr<AudioClip> clip, const VoiceParameters& parameters) {
+        if (!clip || clip->getFrameCount() == 0) {
+            return InvalidVoice;
+        }
+
+        Command command{CommandType::Play, 0, 0, 0.0f, clip.get(), nullptr, parameters};
+        VoiceHandle handle = startVoice(command);
+        if (handle != InvalidVoice) {
+            slots_[command.Slot].Clip = std::move(clip);
+        }
+        return handle;
+    }
+
+    VoiceHandle AudioMixer::play(SharedPtr<AudioStream> stream, const VoiceParameters& parameters) {
+        if (!stream) {
+            return InvalidVoice;
+        }
+        for (const auto& slot : slots_) {
+            if (slot.Busy && slot.Stream == stream) {
+                return InvalidVoice;
+            }
+        }
+
+        Command command{CommandType::Play, 0, 0, 0.0f, nullptr, stream.get(), parameters};
+        VoiceHandle handle = startVoice(command);
+        if (handle != InvalidVoice) {
+            slots_[command.Slot].Stream = std::move(stream);
+        }
+        return handle;
+    }
+
+    VoiceHandle AudioMixer::startVoice(Command& command) {
+        auto free = std::find_if(slots_.begin(), slots_.end(), [](const VoiceSlot& slot) { return !slot.Busy; });
+        if (free == slots_.end()) {
+            return InvalidVoice;
+        }
+
+        command.Slot = static_cast<uint32_t>(free - slots_.begin());
+        command.Generation = free->Generation + 1;
+        if (!commands_.push(command)) {
+            droppedCommands_.fetch_add(1, std::memory_order_relaxed);
+            return InvalidVoice;
+        }
+
+        // The slot stays busy until the audio thread reports the voice as finished
+        free->Busy = true;
+        free->Generation = command.Generation;
+        return makeHandle(command.Slot, command.Generation);
+    }
+
+    void AudioMixer::post(const Command& command) {
+        if (!commands_.push(command)) {
+            droppedCommands_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    const AudioMixer::VoiceSlot* AudioMixer::findSlot(VoiceHandle voice) const {
+        auto slot = static_cast<uint32_t>(voice & 0xFFFFFFFF);
+        auto generation = static_cast<uint32_t>(voice >> 32);
+        if (slot >= slots_.size() || !slots_[slot].Busy || slots_[slot].Generation != generation) {
+            return nullptr;
+        }
+        return &slots_[slot];
+    }
+
+    void AudioMixer::stop(VoiceHandle voice) {
+        if (findSlot(voice)) {
+            post({CommandType::Stop, uint32_t(voice), uint32_t(voice >> 32), 0.0f, nullptr, nullptr, {}});
+        }
+    }
+
+    void AudioMixer::setGain(VoiceHandle voice, float gain) {
+        if (findSlot(voice)) {
+            post({CommandType::SetGain, uint32_t(voice), uint32_t(voice >> 32), gain, nullptr, nullptr, {}});
+        }
+    }
+
+    void AudioMixer::setPan(VoiceHandle voice, float pan) {
+        if (findSlot(voice)) {
+            post({CommandType::SetPan, uint32_t(voice), uint32_t(voice >> 32), pan, nullptr, nullptr, {}});
+        }
+    }
+
+    void AudioMixer::setPitch(VoiceHandle voice, float pitch) {
+        if (findSlot(voice)) {
+            post({CommandType::SetPitch, uint32_t(voice), uint32_t(voice >> 32), pitch, nullptr, nullptr, {}});
+        }
+    }
+
+    void AudioMixer::setMasterGain(float gain) {
+        post({CommandType::SetMasterGain, 0, 0, gain, nullptr, nullptr, {}});
+    }
+
+    bool AudioMixer::isPlaying(VoiceHandle voice) const {
+        return findSlot(voice) != nullptr;
+    }
+
+    void AudioMixer::update() {
+        FinishedVoice finished{};
+        while (finished_.pop(finished)) {
+            auto& slot = slots_[finished.Slot];
+            if (slot.Busy && slot.Generation == finished.Generation) {
+                slot.Clip.reset();
+                slot.Stream.reset();
+                slot.Busy = false;
+            }
+        }
+
+        for (auto& slot : slots_) {
+            if (slot.Busy && slot.Stream) {
+                slot.Stream->refill();
+            }
+        }
+    }
+
+    void AudioMixer::render(float* output, uint32_t frameCount) {
+        auto start = std::chrono::steady_clock::now();
+        auto audioDuration = std::chrono::nanoseconds(uint64_t(frameCount) * 1'000'000'000 / sampleRate_);
+        if (callbacks_.load(std::memory_order_relaxed) > 0 && (start - lastCallback_) * 2 > audioDuration * 3) {
+            lateCallbacks_.fetch_add(1, std::memory_order_relaxed);
+        }
+        lastCallback_ = start;
+
+        applyCommands();
+        for (uint32_t offset = 0; offset < frameCount; offset += blockFrames_) {
+            mixBlock(output + size_t(offset) * 2, std::min(blockFrames_, frameCount - offset));
+        }
+        activeVoiceCount_.store(static_cast<uint32_t>(activeVoices_.size()), std::memory_order_relaxed);
+
+        auto elapsed = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        if (elapsed > static_cast<uint64_t>(audioDuration.count())) {
+            overruns_.fetch_add(1, std::memory_order_relaxed);
+        }
+        lastCallbackNs_.store(elapsed, std::memory_order_relaxed);
+        if (elapsed > maxCallbackNs_.load(std::memory_order_relaxed)) {
+            maxCallbackNs_.store(elapsed, std::memory_order_relaxed);
+        }
+        totalCallbackNs_.fetch_add(elapsed, std::memory_order_relaxed);
+        totalAudioNs_.fetch_add(static_cast<uint64_t>(audioDuration.count()), std::memory_order_relaxed);
+        callbacks_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void AudioMixer::applyCommands() {
+        Command command{};
+        while (commands_.pop(command)) {
+            if (command.Type == CommandType::SetMasterGain) {
+                masterGain_ = command.Value;
+                continue;
+            }
+
+            auto& voice = voices_[command.Slot];
+            if (command.Type == CommandType::Play) {
+                const auto& parameters = command.Parameters;
+                if (command.Clip) {
+                    voice.Samples = command.Clip->getSamples();
+                    voice.SourceFrames = command.Clip->getFrameCount();
+                    voice.Channels = command.Clip->getChannels();
+                    voice.SourceRateRatio = float(command.Clip->getSampleRate()) / float(sampleRate_);
+                } else {
+                    voice.Samples = voice.Window.data();
+                    voice.SourceFrames = 0;
+                    voice.Channels = command.Stream->getChannels();
+                    voice.SourceRateRatio = float(command.Stream->getSampleRate()) / float(sampleRate_);
+                }
+                voice.Stream = command.Stream;
+                voice.Position = 0.0;
+                voice.Step = computeStep(parameters.Pitch, voice.SourceRateRatio);
+                voice.Gain = parameters.Gain;
+                voice.Pan = parameters.Pan;
+                voice.Loop = parameters.Loop;
+                voice.Generation = command.Generation;
+                voice.Stopping = false;
+                voice.Active = true;
+                // Start at the target gain so attacks are not softened by a ramp
+                computeGains(voice.Gain, voice.Pan, voice.Channels, voice.CurrentGain);
+                activeVoices_.push_back(command.Slot);
+                continue;
+            }
+
+            if (!voice.Active || voice.Generation != command.Generation) {
+                continue;
+            }
+            switch (command.Type) {
+                case CommandType::Stop:
+                    voice.Stopping = true;
+                    break;
+                case CommandType::SetGain:
+                    voice.Gain = command.Value;
+                    break;
+                case CommandType::SetPan:
+                    voice.Pan = command.Value;
+                    break;
+                case CommandType::SetPitch:
+                    voice.Step = computeStep(command.Value, voice.SourceRateRatio);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    void AudioMixer::mixBlock(float* output, uint32_t frames) {
+        std::fill_n(mixLeft_.begin(), frames, 0.0f);
+        std::fill_n(mixRight_.begin(), frames, 0.0f);
+
+        for (size_t i = 0; i < activeVoices_.size();) {
+            uint32_t slot = activeVoices_[i];
+            auto& voice = voices_[slot];
+            bool playing = voice.Stream ? renderStream(voice, frames) : renderClip(voice, frames);
+
+            float target[2] = {0.0f, 0.0f};
+            if (!voice.Stopping) {
+                computeGains(voice.Gain, voice.Pan, voice.Channels, target);
+            }
+            const float* right = voice.Channels == 1 ? voiceLeft_.data() : voiceRight_.data();
+            accumulate(mixLeft_.data(), mixRight_.data(), voiceLeft_.data(), right, frames, voice.CurrentGain, target);
+            voice.CurrentGain[0] = target[0];
+            voice.CurrentGain[1] = target[1];
+
+            if (!playing || voice.Stopping) {
+                finishVoice(slot);
+                activeVoices_[i] = activeVoices_.back();
+                activeVoices_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+
+        float masterGain = masterGain_;
+        interleave(output, mixLeft_.data(), mixRight_.data(), frames, currentMasterGain_, masterGain);
+        currentMasterGain_ = masterGain;
+    }
+
+    bool AudioMixer::renderClip(Voice& voice, uint32_t frames) {
+        uint32_t produced = 0;
+        while (produced < frames) {
+            if (voice.Position >= double(voice.SourceFrames)) {
+                if (!voice.Loop) {
+                    break;
+                }
+                voice.Position = std::fmod(voice.Position, double(voice.SourceFrames));
+            }
+            produced += resample(voice.Samples, voice.SourceFrames, voice.SourceFrames, voice.Channels, voice.Loop,
+                                 voice.Position, voice.Step, voiceLeft_.data() + produced,
+                                 voiceRight_.data() + produced, frames - produced);
+        }
+
+        std::fill(voiceLeft_.begin() + produced, voiceLeft_.begin() + frames, 0.0f);
+        std::fill(voiceRight_.begin() + produced, voiceRight_.begin() + frames, 0.0f);
+        return produced == frames;
+    }
+
+    bool AudioMixer::renderStream(Voice& voice, uint32_t frames) {
+        auto* stream = voice.Stream;
+        uint32_t produced = 0;
+        bool exhausted = false;
+        // Until the first fill has completed the voice plays silence without counting it as starvation
+        if (stream->isPrimed()) {
+            // Drop the frames the resampler has moved past, keeping the one it interpolates from
+            auto consumed = std::min(static_cast<uint64_t>(voice.Position), voice.SourceFrames);
+            if (consumed > 0) {
+                std::memmove(voice.Window.data(), voice.Window.data() + consumed * voice.Channels,
+                             (voice.SourceFrames - consumed) * voice.Channels * sizeof(float));
+                voice.SourceFrames -= consumed;
+                voice.Position -= double(consumed);
+            }
+
+            auto needed = std::min<uint64_t>(windowCapacity_,
+                                             static_cast<uint64_t>(std::ceil(voice.Position + frames * voice.Step)) + 2);
+            if (voice.SourceFrames < needed) {
+                voice.SourceFrames += stream->read(voice.Window.data() + voice.SourceFrames * voice.Channels,
+                                                   needed - voice.SourceFrames);
+            }
+
+            // Until the stream is exhausted the last frame is kept back as the next interpolation point
+            exhausted = stream->isExhausted();
+            uint64_t limit = exhausted || voice.SourceFrames == 0 ? voice.SourceFrames : voice.SourceFrames - 1;
+            produced = resample(voice.Samples, voice.SourceFrames, limit, voice.Channels, false,
+                                voice.Position, voice.Step, voiceLeft_.data(), voiceRight_.data(), frames);
+            if (produced < frames && !exhausted) {
+                starvations_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        std::fill(voiceLeft_.begin() + produced, voiceLeft_.begin() + frames, 0.0f);
+        std::fill(voiceRight_.begin() + produced, voiceRight_.begin() + frames, 0.0f);
+        return produced == frames || !exhausted;
+    }
+
+    void AudioMixer::finishVoice(uint32_t slot) {
+        auto& voice = voices_[slot];
+        voice.Active = false;
+        voice.Stream = nullptr;
+        // Cannot fail: a slot is not reused before the game thread has popped its event
+        finished_.push({slot, voice.Generation});
+    }
+
+    AudioMixerStats AudioMixer::getStats() const {
+        AudioMixerStats stats;
+        stats.Callbacks = callbacks_.load(std::memory_order_relaxed);
+        stats.LastCallbackMicroseconds = double(lastCallbackNs_.load(std::memory_order_relaxed)) / 1000.0;
+        stats.MaxCallbackMicroseconds = double(maxCallbackNs_.load(std::memory_order_relaxed)) / 1000.0;
+        auto totalCallbackNs = double(totalCallbackNs_.load(std::memory_order_relaxed));
+        if (stats.Callbacks > 0) {
+            stats.AverageCallbackMicroseconds = totalCallbackNs / double(stats.Callbacks) / 1000.0;
+        }
+        auto totalAudioNs = double(totalAudioNs_.load(std::memory_order_relaxed));
+        if (totalAudioNs > 0.0) {
+            stats.CpuLoad = totalCallbackNs / totalAudioNs;
+        }
+        stats.Overruns = overruns_.load(std::memory_order_relaxed);
+        stats.LateCallbacks = lateCallbacks_.load(std::memory_order_relaxed);
+        stats.StreamStarvations = starvations_.load(std::memory_order_relaxed);
+        stats.DroppedCommands = droppedCommands_.load(std::memory_order_relaxed);
+        stats.ActiveVoices = activeVoiceCount_.load(std::memory_order_relaxed);
+        return stats;
+    }
+}
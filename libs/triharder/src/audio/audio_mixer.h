@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "audio_clip.h"
+#include "audio_stream.h"
+#include "../core/spsc_queue.h"
+
+namespace TriHarder {
+
+    //! Identifies a playing voice: the voice slot in the low bits, a generation counter
+    //! in the high bits so stale handles of reused slots are ignored.
+    using VoiceHandle = uint64_t;
+
+    constexpr VoiceHandle InvalidVoice = 0;
+
+    //! @struct VoiceParameters
+    //! @brief Initial settings of a voice.
+    struct VoiceParameters {
+        float Gain = 1.0f;
+        float Pan = 0.0f; //!< -1 is fully left, 1 fully right.
+        float Pitch = 1.0f; //!< Playback speed factor, clamped to [1 / MaxPitch, MaxPitch].
+        bool Loop = false;
+    };
+
+    //! @struct AudioMixerStats
+    //! @brief Counters of the audio thread, safe to read from any thread.
+    //!
+    //! SDL does not report device underruns, so they are detected from the callback
+    //! itself: an overrun is a callback that took longer than the audio it produced,
+    //! a late callback started more than one and a half buffers after the previous one.
+    struct AudioMixerStats {
+        uint64_t Callbacks = 0;
+        double LastCallbackMicroseconds = 0.0;
+        double MaxCallbackMicroseconds = 0.0;
+        double AverageCallbackMicroseconds = 0.0;
+        double CpuLoad = 0.0; //!< Average callback time divided by the audio duration it produced.
+        uint64_t Overruns = 0;
+        uint64_t LateCallbacks = 0;
+        uint64_t StreamStarvations = 0; //!< Blocks in which a stream ran out of decoded audio.
+        uint64_t DroppedCommands = 0; //!< Commands lost because the queue was full.
+        uint32_t ActiveVoices = 0;
+    };
+
+    //! @class AudioMixer
+    //! @brief Mixes clips and streams into interleaved stereo float output.
+    //!
+    //! The mixer is split between two threads. The game thread calls play(), stop(), the
+    //! setters and update(); these post commands over an SPSC queue and own the clip and
+    //! stream references. The audio thread calls render(), which applies the commands,
+    //! mixes all voices with SIMD kernels and reports finished voices back over a second
+    //! SPSC queue. render() never locks or allocates, every buffer is sized up front.
+    //!
+    //! Voices with a source rate or pitch differing from the output rate are resampled
+    //! with linear interpolation. Gain and pan changes are ramped across one block to
+    //! avoid clicks, and stopped voices fade out over one block.
+    class AudioMixer {
+    public:
+        //! @param sampleRate Output sample rate.
+        //! @param maxVoices Number of voices that can play at the same time.
+        //! @param blockFrames Frames mixed per step, render() splits larger requests.
+        AudioMixer(uint32_t sampleRate, uint32_t maxVoices = DefaultMaxVoices, uint32_t blockFrames = DefaultBlockFrames);
+
+        AudioMixer(const AudioMixer&) = delete;
+        AudioMixer& operator=(const AudioMixer&) = delete;
+
+        //! Game thread: starts playing a clip.
+        //! @return The voice or InvalidVoice if all voices are busy.
+        VoiceHandle play(SharedPtr<AudioClip> clip, const VoiceParameters& parameters = VoiceParameters());
+
+        //! Game thread: starts playing a stream. A stream can only be played by one voice.
+        //! @return The voice or InvalidVoice if all voices are busy.
+        VoiceHandle play(SharedPtr<AudioStream> stream, const VoiceParameters& parameters = VoiceParameters());
+
+        //! Game thread: fades the voice out, its slot is reused once the audio thread has released it.
+        void stop(VoiceHandle voice);
+        void setGain(VoiceHandle voice, float gain);
+        void setPan(VoiceHandle voice, float pan);
+        void setPitch(VoiceHandle voice, float pitch);
+        void setMasterGain(float gain);
+
+        //! Game thread: releases the sources of finished voices and refills the streams.
+        //! Call once per frame.
+        void update();
+
+        //! Game thread: @return True until the voice has finished and update() released it.
+        [[nodiscard]] bool isPlaying(VoiceHandle voice) const;
+
+        //! Audio thread: produces frameCount interleaved stereo frames.
+        void render(float* output, uint32_t frameCount);
+
+        [[nodiscard]] AudioMixerStats getStats() const;
+
+        [[nodiscard]] uint32_t getSampleRate() const { return sampleRate_; }
+        [[nodiscard]] uint32_t getMaxVoices() const { return static_cast<uint32_t>(voices_.size()); }
+
+        static constexpr uint32_t DefaultMaxVoices = 64;
+        static constexpr uint32_t DefaultBlockFrames = 256;
+        static constexpr float MaxPitch = 4.0f;
+
+    private:
+        enum class CommandType : uint8_t {
+            Play,
+            Stop,
+            SetGain,
+            SetPan,
+            SetPitch,
+            SetMasterGain,
+        };
+
+        //! Raw source pointers are safe because the game thread keeps the references
+        //! until the voice reported back as finished.
+        struct Command {
+            CommandType Type;
+            uint32_t Slot;
+            uint32_t Generation;
+            float Value;
+            const AudioClip* Clip;
+            AudioStream* Stream;
+            VoiceParameters Parameters;
+        };
+
+        struct FinishedVoice {
+            uint32_t Slot;
+            uint32_t Generation;
+        };
+
+        //! Game thread view of a voice slot.
+        struct VoiceSlot {
+            SharedPtr<AudioClip> Clip;
+            SharedPtr<AudioStream> Stream;
+            uint32_t Generation = 0;
+            bool Busy = false;
+        };
+
+        //! Audio thread state of a voice.
+        struct Voice {
+            const float* Samples = nullptr; //!< Clip samples, or the stream window.
+            AudioStream* Stream = nullptr;
+            uint64_t SourceFrames = 0;
+            double Position = 0.0; //!< In source frames, relative to the window for streams.
+            double Step = 1.0;
+            float SourceRateRatio = 1.0f;
+            float Gain = 1.0f;
+            float Pan = 0.0f;
+            float CurrentGain[2] = {};
+            uint32_t Channels = 1;
+            uint32_t Generation = 0;
+            bool Loop = false;
+            bool Active = false;
+            bool Stopping = false;
+            std::vector<float> Window; //!< Stream frames not yet consumed by the resampler.
+        };
+
+        VoiceHandle startVoice(Command& command);
+        void post(const Command& command);
+        [[nodiscard]] const VoiceSlot* findSlot(VoiceHandle voice) const;
+
+        void applyCommands();
+        void mixBlock(float* output, uint32_t frames);
+        //! Resample into the voice scratch buffers. @return False once the source has ended.
+        bool renderClip(Voice& voice, uint32_t frames);
+        bool renderStream(Voice& voice, uint32_t frames);
+        void finishVoice(uint32_t slot);
+
+        uint32_t sampleRate_;
+        uint32_t blockFrames_;
+        size_t windowCapacity_; //!< Frames of each stream window.
+        std::vector<VoiceSlot> slots_;
+        std::vector<Voice> voices_;
+        std::vector<uint32_t> activeVoices_;
+
+        SpscQueue<Command> commands_;
+        SpscQueue<FinishedVoice> finished_;
+
+        // Scratch buffers of the audio thread, one block each
+        std::vector<float> voiceLeft_;
+        std::vector<float> voiceRight_;
+        std::vector<float> mixLeft_;
+        std::vector<float> mixRight_;
+        float masterGain_ = 1.0f;
+        float currentMasterGain_ = 1.0f;
+
+        std::chrono::steady_clock::time_point lastCallback_;
+        std::atomic<uint64_t> callbacks_ = 0;
+        std::atomic<uint64_t> lastCallbackNs_ = 0;
+        std::atomic<uint64_t> maxCallbackNs_ = 0;
+        std::atomic<uint64_t> totalCallbackNs_ = 0;
+        std::atomic<uint64_t> totalAudioNs_ = 0;
+        std::atomic<uint64_t> overruns_ = 0;
+        std::atomic<uint64_t> lateCallbacks_ = 0;
+        std::atomic<uint64_t> starvations_ = 0;
+        std::atomic<uint32_t> activeVoiceCount_ = 0;
+        std::atomic<uint64_t> droppedCommands_ = 0;
+    };
+}
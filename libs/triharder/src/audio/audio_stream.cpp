@@ -0,0 +1,77 @@
+#include "audio_stream.h"
+#include <format>
+#include "../core/job_system.h"
+#include "../core/memory_tracker.h"
+
+namespace TriHarder {
+
+    Result<SharedPtr<AudioStream>> AudioStream::open(const String& path, bool loop, float bufferSeconds) {
+        MemoryTagScope scope(MemoryTag::Assets);
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return Result<SharedPtr<AudioStream>>::error(std::format("Failed to open {}", path));
+        }
+
+        auto format = readWavHeader(file);
+        if (format.is_error()) {
+            return Result<SharedPtr<AudioStream>>::error(std::format("{}: {}", path, format.unwrap_err()));
+        }
+
+        auto wav = format.unwrap();
+        auto bufferFrames = std::max<size_t>(static_cast<size_t>(bufferSeconds * float(wav.SampleRate)), ChunkFrames);
+        auto stream = SharedPtr<AudioStream>(new AudioStream(std::move(file), wav, loop, bufferFrames * wav.Channels));
+        stream->refill();
+        return Result<SharedPtr<AudioStream>>::ok(stream);
+    }
+
+    AudioStream::AudioStream(std::ifstream file, const WavFormat& format, bool loop, size_t bufferSamples)
+        : file_(std::move(file)), format_(format), buffer_(bufferSamples), decoded_(ChunkFrames * format.Channels),
+          framesLeft_(format.FrameCount), loop_(loop) {}
+
+    AudioStream::~AudioStream() {
+        if (job_.valid()) {
+            job_.wait();
+        }
+    }
+
+    void AudioStream::refill() {
+        if (refillPending_.load(std::memory_order_acquire) || endOfData_.load(std::memory_order_relaxed) ||
+            buffer_.size() * 2 > buffer_.capacity()) {
+            return;
+        }
+
+        refillPending_.store(true, std::memory_order_relaxed);
+        job_ = JobSystem::getInstance().submit([this]() {
+            fill();
+            primed_.store(true, std::memory_order_release);
+            refillPending_.store(false, std::memory_order_release);
+        });
+    }
+
+    void AudioStream::fill() {
+        // Only whole frames are pushed, so the consumer never sees a partial frame
+        size_t freeFrames = (buffer_.capacity() - buffer_.size()) / format_.Channels;
+        bool rewound = false;
+        while (freeFrames > 0) {
+            if (framesLeft_ == 0) {
+                // Rewinding twice without reading a frame means the data chunk is unreadable
+                if (!loop_ || rewound) {
+                    endOfData_.store(true, std::memory_order_release);
+                    return;
+                }
+                file_.clear();
+                file_.seekg(static_cast<std::streamoff>(format_.DataOffset));
+                framesLeft_ = format_.FrameCount;
+                rewound = true;
+            }
+
+            auto request = static_cast<size_t>(std::min<uint64_t>({freeFrames, ChunkFrames, framesLeft_}));
+            size_t frames = readWavFrames(file_, format_, decoded_.data(), request, scratch_);
+            // A truncated file ends the data chunk early
+            framesLeft_ = frames < request ? 0 : framesLeft_ - frames;
+            buffer_.pushBulk(decoded_.data(), frames * format_.Channels);
+            freeFrames -= frames;
+            rewound = rewound && frames == 0;
+        }
+    }
+}
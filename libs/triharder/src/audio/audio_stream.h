@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <vector>
+#include "wav_file.h"
+#include "../core/spsc_queue.h"
+
+namespace TriHarder {
+
+    //! @class AudioStream
+    //! @brief Plays a long WAV file from disk through a ring buffer.
+    //!
+    //! Decoding runs as a job on the JobSystem, which is the single producer of the
+    //! ring; the audio callback is the single consumer. refill() is called from the game
+    //! thread and only issues a job once the ring has drained below half, so the ring
+    //! size is the latency budget of the disk.
+    class AudioStream {
+    public:
+        //! Opens the file and queues the first fill.
+        //! @param loop Restarts at the beginning when the end of the file is reached.
+        //! @param bufferSeconds Length of the ring buffer.
+        static Result<SharedPtr<AudioStream>> open(const String& path, bool loop, float bufferSeconds = 1.0f);
+
+        //! Waits for a pending refill job.
+        ~AudioStream();
+
+        AudioStream(const AudioStream&) = delete;
+        AudioStream& operator=(const AudioStream&) = delete;
+
+        //! Game thread: queues a refill job if the ring is below half and none is running.
+        void refill();
+
+        //! Audio thread: removes up to frameCount interleaved frames from the ring.
+        //! @return Number of frames read.
+        size_t read(float* output, size_t frameCount) {
+            return buffer_.popBulk(output, frameCount * format_.Channels) / format_.Channels;
+        }
+
+        //! True once the first fill has completed, playback waits for it instead of starving.
+        [[nodiscard]] bool isPrimed() const { return primed_.load(std::memory_order_acquire); }
+
+        //! True if the end of a non-looping file was reached and every frame was read.
+        [[nodiscard]] bool isExhausted() const {
+            return endOfData_.load(std::memory_order_acquire) && buffer_.size() == 0;
+        }
+
+        [[nodiscard]] size_t getBufferedFrames() const { return buffer_.size() / format_.Channels; }
+        [[nodiscard]] uint32_t getChannels() const { return format_.Channels; }
+        [[nodiscard]] uint32_t getSampleRate() const { return format_.SampleRate; }
+
+    private:
+        AudioStream(std::ifstream file, const WavFormat& format, bool loop, size_t bufferSamples);
+
+        void fill();
+
+        static constexpr size_t ChunkFrames = 4096;
+
+        std::ifstream file_;
+        WavFormat format_;
+        SpscQueue<float> buffer_;
+        std::vector<float> decoded_;
+        std::vector<uint8_t> scratch_;
+        uint64_t framesLeft_;
+        bool loop_;
+        std::future<void> job_;
+        std::atomic<bool> refillPending_ = false;
+        std::atomic<bool> primed_ = false;
+        std::atomic<bool> endOfData_ = false;
+    };
+}
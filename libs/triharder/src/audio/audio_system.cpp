@@ -0,0 +1,61 @@
+#include "audio_system.h"
+#include <SDL.h>
+#include <SDL_hints.h>
+#include "../core/logging.h"
+#include "../core/memory_tracker.h"
+
+namespace TriHarder {
+
+    UniquePtr<AudioSystem> AudioSystem::create(const AudioDescriptor& descriptor) {
+        MemoryTagScope scope(MemoryTag::Audio);
+        auto logger = LogManager::getInstance().getLogger();
+        if (!descriptor.Driver.empty()) {
+            SDL_SetHint(SDL_HINT_AUDIODRIVER, descriptor.Driver.c_str());
+        }
+        if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+            logger->error(std::format("Failed to initialize SDL audio: {}", SDL_GetError()));
+            return nullptr;
+        }
+
+        auto system = UniquePtr<AudioSystem>(new AudioSystem());
+        SDL_AudioSpec desired{};
+        desired.freq = static_cast<int>(descriptor.SampleRate);
+        desired.format = AUDIO_F32SYS;
+        desired.channels = 2;
+        desired.samples = static_cast<Uint16>(descriptor.BufferFrames);
+        desired.callback = &AudioSystem::callback;
+        desired.userdata = system.get();
+
+        // Only the rate may differ, the mixer resamples; everything else is converted by SDL
+        SDL_AudioSpec obtained{};
+        system->device_ = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained,
+                                              SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+        if (system->device_ == 0) {
+            logger->error(std::format("Failed to open audio device: {}", SDL_GetError()));
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+            return nullptr;
+        }
+
+        system->driver_ = SDL_GetCurrentAudioDriver();
+        system->bufferFrames_ = obtained.samples;
+        system->mixer_ = createUniquePtr<AudioMixer>(static_cast<uint32_t>(obtained.freq), descriptor.MaxVoices,
+                                                     std::max<uint32_t>(obtained.samples, AudioMixer::DefaultBlockFrames));
+        SDL_PauseAudioDevice(system->device_, 0);
+
+        logger->info(std::format("Audio device opened on driver {}: {} Hz, {} frames per callback",
+                                 system->driver_, obtained.freq, obtained.samples));
+        return system;
+    }
+
+    AudioSystem::~AudioSystem() {
+        if (device_ != 0) {
+            SDL_CloseAudioDevice(device_);
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        }
+    }
+
+    void AudioSystem::callback(void* userData, Uint8* stream, int length) {
+        auto* system = static_cast<AudioSystem*>(userData);
+        system->mixer_->render(reinterpret_cast<float*>(stream), static_cast<uint32_t>(length) / (sizeof(float) * 2));
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <SDL_audio.h>
+#include "audio_mixer.h"
+
+namespace TriHarder {
+
+    //! @struct AudioDescriptor
+    //! @brief Configures the audio device.
+    struct AudioDescriptor {
+        String Driver; //!< SDL audio driver, e.g. "dummy" or "disk" for headless runs. Empty picks the default.
+        uint32_t SampleRate = 48000; //!< Requested rate, the device may choose another one.
+        uint32_t BufferFrames = 256; //!< Frames per callback, smaller buffers lower the latency.
+        uint32_t MaxVoices = AudioMixer::DefaultMaxVoices;
+    };
+
+    //! @class AudioSystem
+    //! @brief Opens an SDL audio device and drives an AudioMixer from its callback.
+    //!
+    //! The device always runs in stereo 32-bit float so the mixer output is handed to
+    //! SDL without conversion. Game code talks to getMixer() only.
+    class AudioSystem {
+    public:
+        //! Initializes the SDL audio subsystem and starts playback.
+        //! @return The audio system or nullptr if no device could be opened.
+        static UniquePtr<AudioSystem> create(const AudioDescriptor& descriptor);
+
+        //! Stops the callback and closes the device.
+        ~AudioSystem();
+
+        AudioSystem(const AudioSystem&) = delete;
+        AudioSystem& operator=(const AudioSystem&) = delete;
+
+        [[nodiscard]] AudioMixer& getMixer() { return *mixer_; }
+        [[nodiscard]] const AudioMixer& getMixer() const { return *mixer_; }
+
+        //! Forwards to AudioMixer::update(), call once per frame.
+        void update() { mixer_->update(); }
+
+        [[nodiscard]] const String& getDriver() const { return driver_; }
+        [[nodiscard]] uint32_t getSampleRate() const { return mixer_->getSampleRate(); }
+        [[nodiscard]] uint32_t getBufferFrames() const { return bufferFrames_; }
+
+    private:
+        AudioSystem() = default;
+
+        static void callback(void* userData, Uint8* stream, int length);
+
+        UniquePtr<AudioMixer> mixer_;
+        SDL_AudioDeviceID device_ = 0;
+        String driver_;
+        uint32_t bufferFrames_ = 0;
+    };
+}
@@ -0,0 +1,89 @@
+#include "wav_file.h"
+#include <cstring>
+#include <format>
+#include <vector>
+
+namespace TriHarder {
+
+    static constexpr uint16_t WaveFormatPcm = 1;
+    static constexpr uint16_t WaveFormatFloat = 3;
+    static constexpr uint16_t WaveFormatExtensible = 0xFFFE;
+
+    static uint32_t readU32(const uint8_t* data) {
+        return uint32_t(data[0]) | uint32_t(data[1]) << 8 | uint32_t(data[2]) << 16 | uint32_t(data[3]) << 24;
+    }
+
+    static uint16_t readU16(const uint8_t* data) {
+        return static_cast<uint16_t>(data[0] | data[1] << 8);
+    }
+
+    Result<WavFormat> readWavHeader(std::istream& stream) {
+        uint8_t riff[12];
+        if (!stream.read(reinterpret_cast<char*>(riff), sizeof(riff)) ||
+            std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+            return Result<WavFormat>::error("Not a RIFF WAVE file");
+        }
+
+        WavFormat format;
+        bool hasFormat = false;
+        uint8_t chunk[8];
+        while (stream.read(reinterpret_cast<char*>(chunk), sizeof(chunk))) {
+            uint32_t size = readU32(chunk + 4);
+            if (std::memcmp(chunk, "fmt ", 4) == 0) {
+                uint8_t fmt[40] = {};
+                if (size < 16 || !stream.read(reinterpret_cast<char*>(fmt), std::min<uint32_t>(size, sizeof(fmt)))) {
+                    return Result<WavFormat>::error("Truncated fmt chunk");
+                }
+                uint16_t tag = readU16(fmt);
+                if (tag == WaveFormatExtensible && size >= 26) {
+                    // The first two bytes of the sub format GUID hold the actual format tag
+                    tag = readU16(fmt + 24);
+                }
+                format.Channels = readU16(fmt + 2);
+                format.SampleRate = readU32(fmt + 4);
+                format.BitsPerSample = readU16(fmt + 14);
+                format.Float = tag == WaveFormatFloat;
+
+                bool supported = (tag == WaveFormatPcm && format.BitsPerSample == 16) ||
+                                 (tag == WaveFormatFloat && format.BitsPerSample == 32);
+                if (!supported || format.Channels < 1 || format.Channels > 2 || format.SampleRate == 0) {
+                    return Result<WavFormat>::error(std::format(
+                        "Unsupported WAV format: tag {}, {} bits, {} channels", tag, format.BitsPerSample, format.Channels));
+                }
+                stream.seekg(size - std::min<uint32_t>(size, sizeof(fmt)) + (size & 1), std::ios::cur);
+                hasFormat = true;
+            } else if (std::memcmp(chunk, "data", 4) == 0) {
+                if (!hasFormat) {
+                    return Result<WavFormat>::error("WAV data chunk before fmt chunk");
+                }
+                format.DataOffset = static_cast<uint64_t>(stream.tellg());
+                format.FrameCount = size / format.getFrameSize();
+                return Result<WavFormat>::ok(format);
+            } else {
+                stream.seekg(size + (size & 1), std::ios::cur);
+            }
+        }
+        return Result<WavFormat>::error("WAV file has no data chunk");
+    }
+
+    size_t readWavFrames(std::istream& stream, const WavFormat& format, float* output, size_t frameCount,
+                         std::vector<uint8_t>& scratch) {
+        size_t frameSize = format.getFrameSize();
+        if (scratch.size() < frameCount * frameSize) {
+            scratch.resize(frameCount * frameSize);
+        }
+        stream.read(reinterpret_cast<char*>(scratch.data()), static_cast<std::streamsize>(frameCount * frameSize));
+        size_t frames = static_cast<size_t>(stream.gcount()) / frameSize;
+        size_t samples = frames * format.Channels;
+
+        if (format.Float) {
+            std::memcpy(output, scratch.data(), samples * sizeof(float));
+        } else {
+            constexpr float Scale = 1.0f / 32768.0f;
+            for (size_t i = 0; i < samples; ++i) {
+                output[i] = static_cast<float>(static_cast<int16_t>(readU16(scratch.data() + i * 2))) * Scale;
+            }
+        }
+        return frames;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <vector>
+#include "../triharder.h"
+#include "../core/result.h"
+
+namespace TriHarder {
+
+    //! @struct WavFormat
+    //! @brief Sample layout and location of the data chunk of a WAV file.
+    struct WavFormat {
+        uint32_t Channels = 0;
+        uint32_t SampleRate = 0;
+        uint32_t BitsPerSample = 0;
+        bool Float = false; //!< IEEE float samples instead of signed integers.
+        uint64_t DataOffset = 0; //!< Byte offset of the first sample in the file.
+        uint64_t FrameCount = 0;
+
+        [[nodiscard]] uint32_t getFrameSize() const { return Channels * BitsPerSample / 8; }
+    };
+
+    //! Parses the RIFF header of a WAV file and leaves the stream at the first sample.
+    //! Supports 16-bit PCM and 32-bit float data with one or two channels.
+    //! @return The format or an error message.
+    Result<WavFormat> readWavHeader(std::istream& stream);
+
+    //! Reads up to frameCount frames at the current stream position and converts them
+    //! to interleaved floats in [-1, 1].
+    //! @param scratch Holds the raw bytes, grows to frameCount frames on first use.
+    //! @return Number of frames read.
+    size_t readWavFrames(std::istream& stream, const WavFormat& format, float* output, size_t frameCount,
+                         std::vector<uint8_t>& scratch);
+}
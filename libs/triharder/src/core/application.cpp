@@ -1,41 +1,345 @@
 #include <glad/glad.h>
 #include <SDL_events.h>
-#include <thread>
+#include <SDL_hints.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <future>
 #include "application.h"
 #include "window.h"
 #include "logging.h"
+#include "job_system.h"
+#include "memory_tracker.h"
+#include "startup_profiler.h"
 
 namespace TriHarder {
 
-    bool isEscapePressed(const SDL_Event& event) {
-        return event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE;
+    ApplicationDescriptor ApplicationDescriptor::fromCommandLine(int argc, char* argv[]) {
+        ApplicationDescriptor descriptor;
+        for (int i = 1; i < argc; ++i) {
+            bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--startup-benchmark") == 0) {
+                descriptor.StartupBenchmark = true;
+            } else if (std::strcmp(argv[i], "--headless") == 0) {
+                descriptor.Headless = true;
+            } else if (std::strcmp(argv[i], "--frames") == 0 && hasValue) {
+                descriptor.FrameLimit = std::strtoull(argv[++i], nullptr, 10);
+            } else if (std::strcmp(argv[i], "--capture") == 0 && hasValue) {
+                descriptor.Capture.emplace().OutputDirectory = argv[++i];
+            } else if (std::strcmp(argv[i], "--capture-format") == 0 && hasValue) {
+                auto& capture = descriptor.Capture ? *descriptor.Capture : descriptor.Capture.emplace();
+                String format = argv[++i];
+                capture.Format = format == "raw" ? CaptureFormat::RawVideo
+                               : format == "none" ? CaptureFormat::None
+                               : CaptureFormat::Png;
+            } else if (std::strcmp(argv[i], "--golden") == 0 && hasValue) {
+                auto& capture = descriptor.Capture ? *descriptor.Capture : descriptor.Capture.emplace();
+                capture.GoldenDirectory = argv[++i];
+            } else if (std::strcmp(argv[i], "--audio") == 0) {
+                descriptor.Audio.emplace();
+            } else if (std::strcmp(argv[i], "--audio-driver") == 0 && hasValue) {
+                auto& audio = descriptor.Audio ? *descriptor.Audio : descriptor.Audio.emplace();
+                audio.Driver = argv[++i];
+            } else if (std::strcmp(argv[i], "--record") == 0 && hasValue) {
+                descriptor.RecordPath = argv[++i];
+            } else if (std::strcmp(argv[i], "--replay") == 0 && hasValue) {
+                descriptor.ReplayPath = argv[++i];
+            } else if (std::strcmp(argv[i], "--replay-count") == 0 && hasValue) {
+                descriptor.ReplayCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            } else if (std::strcmp(argv[i], "--memory-stats") == 0) {
+                descriptor.MemoryStats = true;
+            } else if (std::strcmp(argv[i], "--memory-callstacks") == 0) {
+                descriptor.MemoryCallstacks = true;
+            }
+        }
+        return descriptor;
+    }
+
+    void Application::addStartupTask(String name, std::function<void()> task) {
+        startupTasks_.push_back({std::move(name), std::move(task)});
+    }
+
+    void Application::startup() {
+        // Window and context creation must stay on the main thread, everything
+        // independent of it is started in the background first.
+        std::vector<std::future<void>> pending;
+        auto launch = [&pending](String name, std::function<void()> task) {
+            pending.push_back(std::async(std::launch::async, [name = std::move(name), task = std::move(task)]() {
+                StartupPhase phase(name);
+                task();
+            }));
+        };
+
+        launch("logger", []() { LogManager::getInstance().getLogger(); });
+        launch("jobs", []() { JobSystem::getInstance().initialize(); });
+        for (auto& startupTask : startupTasks_) {
+            launch(std::move(startupTask.Name), std::move(startupTask.Task));
+        }
+        startupTasks_.clear();
+
+        if (descriptor_.Headless) {
+            SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+            descriptor_.MainWindow.Hidden = true;
+            if (descriptor_.Audio && descriptor_.Audio->Driver.empty()) {
+                descriptor_.Audio->Driver = "dummy";
+            }
+        }
+        if (replay_) {
+            // Replays run at full speed
+            descriptor_.MainWindow.SwapMode = SwapInterval::Immediate;
+        }
+        window_ = Window::create(descriptor_.MainWindow);
+        input_.initialize();
+        if (!replay_ && !descriptor_.RecordPath.empty()) {
+            recorder_ = FrameRecorder::create(descriptor_.RecordPath, input_);
+        }
+
+        StartupPhase joinPhase("startup.join");
+        for (auto& future : pending) {
+            future.get();
+        }
+        joinPhase.stop();
+
+        // Capture and audio streaming jobs need the job system, so they are created after the join
+        if (descriptor_.Capture) {
+            capture_ = FrameCapture::create(*descriptor_.Capture);
+        }
+        if (descriptor_.Audio) {
+            audio_ = AudioSystem::create(*descriptor_.Audio);
+        }
+    }
+
+    void Application::pollEvents(uint32_t sample) {
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (window_->handleEvent(event)) {
+                continue;
+            }
+
+            // Live input is ignored during a replay so it cannot change the outcome
+            if (!replay_ && input_.processEvent(event)) {
+                if (recorder_) {
+                    recorder_->recordEvent(sample, event);
+                }
+                continue;
+            }
+
+            if (event.type == SDL_QUIT) {
+                quitRequested_ = true;
+            }
+        }
+
+        if (replay_) {
+            for (const auto& recorded : replayFrame_.Samples[sample]) {
+                // Recorded gamepads have no device in this session
+                if (recorded.type == SDL_CONTROLLERDEVICEADDED) {
+                    input_.connectVirtualGamepad(recorded.cdevice.which);
+                } else {
+                    input_.processEvent(recorded);
+                }
+            }
+        }
+    }
+
+    bool Application::runFrame(double deltaTime) {
+        MemoryTracker::beginFrame();
+        input_.beginFrame();
+
+        // Sample input immediately before the simulation step
+        pollEvents(0);
+        if (input_.isKeyPressed(SDL_SCANCODE_ESCAPE)) {
+            MemoryTracker::endFrame();
+            return false;
+        }
+        tasks_.beginFrame(deltaTime);
+
+        if (audio_) {
+            audio_->update();
+        }
+
+        // Sample again right before rendering so the camera sees the latest input
+        pollEvents(1);
+        tasks_.runPhase(TaskPhase::PreRender);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+        if (capture_) {
+            capture_->captureFrame(window_->getDrawableWidth(), window_->getDrawableHeight());
+        }
+
+        // Frame pacing is driven by the swap interval of the window
+        window_->SwapBuffers();
+        input_.markPresented();
+        tasks_.runPhase(TaskPhase::FrameEnd);
+        MemoryTracker::endFrame();
+
+        // Edges are latched, an escape press from the second sample is still visible here
+        return !input_.isKeyPressed(SDL_SCANCODE_ESCAPE);
     }
 
-    void Application::run() {
-        window_ = Window::create();
+    int Application::run() {
+        if (descriptor_.MemoryCallstacks) {
+            MemoryTracker::setCallstackCapture(true);
+        }
+
+        // Loaded before the window is created, a broken recording must not start the application
+        if (!descriptor_.ReplayPath.empty()) {
+            auto replay = FrameReplay::load(descriptor_.ReplayPath);
+            if (replay.is_error()) {
+                LogManager::getInstance().getLogger()->error(
+                    std::format("Failed to load input replay: {}", replay.unwrap_err()));
+                return 1;
+            }
+            replay_ = replay.unwrap();
+        }
+
+        startup();
         glClearColor(0.1f, 0.1f, 0.25f, 1.0f);
+        if (replay_) {
+            return runReplay();
+        }
+
+        auto logger = LogManager::getInstance().getLogger();
+        auto& profiler = StartupProfiler::getInstance();
+        uint64_t frame = 0;
+        auto lastFrame = std::chrono::steady_clock::now();
+        while (!quitRequested_) {
+            auto now = std::chrono::steady_clock::now();
+            double deltaTime = std::chrono::duration<double>(now - lastFrame).count();
+            lastFrame = now;
+
+            if (recorder_) {
+                recorder_->beginFrame(deltaTime);
+            }
+            bool running = runFrame(deltaTime);
+            if (recorder_) {
+                recorder_->endFrame();
+            }
+            if (!running) {
+                logger->info("Escape pressed - exiting...");
+                break;
+            }
+
+            if (!profiler.hasFirstFrame()) {
+                if (descriptor_.StartupBenchmark) {
+                    // Make sure the frame really reached the display before taking the time
+                    glFinish();
+                }
+                profiler.markFirstFrame();
+                profiler.report();
+                if (descriptor_.StartupBenchmark) {
+                    auto timeToFirstFrame = std::chrono::duration<double, std::milli>(profiler.getTimeToFirstFrame());
+                    std::cout << std::format("time_to_first_frame_ms={:.3f}", timeToFirstFrame.count()) << std::endl;
+                    return shutdown();
+                }
+            }
+
+            if (descriptor_.FrameLimit > 0 && ++frame >= descriptor_.FrameLimit) {
+                break;
+            }
+        }
+
+        logInputLatency();
+        return shutdown();
+    }
 
+    int Application::runReplay() {
         auto logger = LogManager::getInstance().getLogger();
-        while (true){
-            glClear(GL_COLOR_BUFFER_BIT);
-            window_->SwapBuffers();
-            SDL_Event event;
-            if (SDL_PollEvent(&event) && event.type) {
-                switch (event.type) {
-                    case SDL_QUIT:
-                        return;
-                    case SDL_KEYDOWN:
-                        if (isEscapePressed(event)) {
-                            logger->info("Escape pressed - exiting...");
-                            return;
-                        }
-                        break;
-                    default:
-                        break;
+        uint32_t passes = std::max(descriptor_.ReplayCount, 1u);
+        logger->info(std::format("Replaying {} frames from {}, {} passes",
+                                 replay_->getFrameCount(), descriptor_.ReplayPath, passes));
+
+        std::vector<double> frameTimes;
+        std::vector<double> allFrameTimes;
+        double passAverageMin = 0.0;
+        double passAverageMax = 0.0;
+        uint32_t pass = 0;
+        while (pass < passes && !quitRequested_) {
+            // Input and the recording restart every pass. Tasks keep running across passes, coroutine
+            // state can't be rewound, so only scenes that respawn their scripts see identical passes.
+            replay_->rewind();
+            input_.reset();
+            for (auto instanceId : replay_->getInitialGamepads()) {
+                input_.connectVirtualGamepad(instanceId);
+            }
+
+            frameTimes.clear();
+            while (!quitRequested_ && replay_->readFrame(replayFrame_, SDL_GetTicks())) {
+                auto start = std::chrono::steady_clock::now();
+                bool running = runFrame(replayFrame_.DeltaTime);
+                frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                if (!running || (descriptor_.FrameLimit > 0 && frameTimes.size() >= descriptor_.FrameLimit)) {
+                    break;
                 }
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            allFrameTimes.insert(allFrameTimes.end(), frameTimes.begin(), frameTimes.end());
+            auto stats = computeFrameTimeStats(frameTimes);
+            passAverageMin = pass == 0 ? stats.AverageMs : std::min(passAverageMin, stats.AverageMs);
+            passAverageMax = std::max(passAverageMax, stats.AverageMs);
+            std::cout << std::format("replay_pass={} frames={} avg_ms={:.3f} p50_ms={:.3f} p95_ms={:.3f} p99_ms={:.3f} max_ms={:.3f}",
+                                     ++pass, stats.Frames, stats.AverageMs, stats.P50Ms, stats.P95Ms, stats.P99Ms, stats.MaxMs)
+                      << std::endl;
+        }
+
+        auto total = computeFrameTimeStats(allFrameTimes);
+        std::cout << std::format("replay_summary passes={} frames={} avg_ms={:.3f} p99_ms={:.3f} pass_avg_min_ms={:.3f} pass_avg_max_ms={:.3f}",
+                                 pass, total.Frames, total.AverageMs, total.P99Ms, passAverageMin, passAverageMax)
+                  << std::endl;
+
+        logInputLatency();
+        return shutdown();
+    }
+
+    void Application::logInputLatency() {
+        auto logger = LogManager::getInstance().getLogger();
+        const auto& latency = input_.getLatencyStats();
+        if (latency.Frames > 0) {
+            logger->info(std::format("Input latency over {} frames - event to present: avg {:.2f} ms, max {:.2f} ms; "
+                                     "sample to present: avg {:.2f} ms, max {:.2f} ms",
+                                     latency.Frames, latency.AverageEventToPresentMs, latency.MaxEventToPresentMs,
+                                     latency.AverageSampleToPresentMs, latency.MaxSampleToPresentMs));
+        }
+    }
+
+    int Application::shutdown() {
+        auto logger = LogManager::getInstance().getLogger();
+        if (recorder_) {
+            logger->info(std::format("Recorded {} frames to {}", recorder_->getFrameCount(), descriptor_.RecordPath));
+            recorder_.reset();
+        }
+
+        MemoryTracker::report();
+        if (descriptor_.MemoryCallstacks) {
+            MemoryTracker::setCallstackCapture(false);
+            MemoryTracker::reportCapturedAllocations();
+        }
+        if (descriptor_.MemoryStats) {
+            MemoryTracker::writeStats(std::cout);
+        }
+        if (audio_) {
+            auto audio = audio_->getMixer().getStats();
+            logger->info(std::format("Audio callbacks: {}, avg {:.1f} us, max {:.1f} us, cpu load {:.2f}%, "
+                                     "{} overruns, {} late callbacks, {} stream starvations",
+                                     audio.Callbacks, audio.AverageCallbackMicroseconds, audio.MaxCallbackMicroseconds,
+                                     audio.CpuLoad * 100.0, audio.Overruns, audio.LateCallbacks, audio.StreamStarvations));
+            audio_.reset();
+        }
+
+        if (!capture_) {
+            return 0;
+        }
+
+        capture_->finish();
+        auto stats = capture_->getStats();
+        logger->info(std::format("Captured {} frames, {} written, {} write failures, {} ring stalls, {} encode stalls, {} dropped",
+                                 stats.FramesDelivered, stats.FramesWritten, stats.WriteFailures, stats.RingStalls,
+                                 stats.EncodeStalls, stats.FramesDropped));
+        if (!capture_->getDescriptor().GoldenDirectory.empty()) {
+            logger->info(std::format("Golden images: {} passed, {} failed", stats.GoldenPassed, stats.GoldenFailed));
         }
+        capture_.reset();
+        return stats.GoldenFailed > 0 || stats.WriteFailures > 0 ? 1 : 0;
     }
 }
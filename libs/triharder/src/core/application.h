@@ -1,15 +1,92 @@
 #pragma once
 
+#include <functional>
+#include <vector>
+#include <optional>
+#include "frame_recording.h"
+#include "task.h"
 #include "window.h"
+#include "../audio/audio_system.h"
+#include "../graphics/frame_capture.h"
+#include "../input/input.h"
 
 namespace TriHarder {
 
+    //! @struct ApplicationDescriptor
+    //! @brief Defines how the application starts up and runs.
+    struct ApplicationDescriptor {
+        WindowDescriptor MainWindow; //!< Properties of the main window.
+        bool StartupBenchmark = false; //!< Exits after the first presented frame and reports the startup timings.
+        bool Headless = false; //!< Renders into a hidden window on the offscreen video driver.
+        uint64_t FrameLimit = 0; //!< Exits after this many frames, 0 runs until quit.
+        std::optional<FrameCaptureDescriptor> Capture; //!< Captures every frame if set.
+        std::optional<AudioDescriptor> Audio; //!< Opens an audio device if set, headless runs default to the dummy driver.
+        String RecordPath; //!< Records the input events and delta time of every frame into this file if set.
+        String ReplayPath; //!< Replays a recording at full speed instead of live input and reports frame time statistics.
+        uint32_t ReplayCount = 1; //!< Number of replay passes, each restarts input and the recording but not the running tasks.
+        bool MemoryStats = false; //!< Prints the memory totals per tag to stdout on exit.
+        bool MemoryCallstacks = false; //!< Captures allocation callstacks and logs the ones still live on exit.
+
+        //! Builds a descriptor from the command line of the executable.
+        //! Recognized flags: --startup-benchmark, --headless, --frames <count>, --capture <directory>,
+        //! --capture-format <png|raw|none>, --golden <directory>, --audio, --audio-driver <name>,
+        //! --record <file>, --replay <file>, --replay-count <count>, --memory-stats, --memory-callstacks
+        static ApplicationDescriptor fromCommandLine(int argc, char* argv[]);
+    };
+
     class Application {
     public:
-        void run();
+        explicit Application(ApplicationDescriptor descriptor = ApplicationDescriptor())
+            : descriptor_(std::move(descriptor)) {}
+
+        //! Registers work that runs on a background thread while the window is created,
+        //! e.g. loading the asset index or warming up the shader cache. All tasks have
+        //! finished before the first frame is rendered.
+        //! @param name Name of the startup phase used in the timing report.
+        //! @param task The work to execute.
+        void addStartupTask(String name, std::function<void()> task);
+
+        [[nodiscard]] Input& getInput() { return input_; }
+
+        //! Runs scene scripts and async loading tasks, resumed at the TaskPhase points of the frame loop.
+        [[nodiscard]] TaskScheduler& getTaskScheduler() { return tasks_; }
+
+        //! @return The audio system, nullptr if audio is disabled or no device could be opened.
+        [[nodiscard]] AudioSystem* getAudio() { return audio_.get(); }
+
+        //! Runs the main loop until quit is requested or the frame limit is reached.
+        //! With a replay path the recorded frames are run instead and the frame time statistics
+        //! of every pass are printed to stdout.
+        //! @return The process exit code, non-zero if a golden image check failed or the replay could not be loaded.
+        int run();
 
     private:
+        struct StartupTask {
+            String Name;
+            std::function<void()> Task;
+        };
+
+        ApplicationDescriptor descriptor_;
+        std::vector<StartupTask> startupTasks_;
         UniquePtr<Window> window_;
+        UniquePtr<FrameCapture> capture_;
+        UniquePtr<AudioSystem> audio_;
+        Input input_;
+        TaskScheduler tasks_;
+        UniquePtr<FrameRecorder> recorder_;
+        std::optional<FrameReplay> replay_;
+        ReplayFrame replayFrame_;
+        bool quitRequested_ = false;
+
+        void startup();
+        //! @param sample Index of the input sample point within the frame.
+        void pollEvents(uint32_t sample);
+        //! Runs one frame of the simulation and rendering.
+        //! @return False if escape was pressed.
+        bool runFrame(double deltaTime);
+        int runReplay();
+        void logInputLatency();
+        int shutdown();
     };
 
 }
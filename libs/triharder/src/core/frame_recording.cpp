@@ -0,0 +1,460 @@
+#include "frame_recording.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include "logging.h"
+#include "../input/input.h"
+
+namespace TriHarder {
+
+    namespace {
+        constexpr char Magic[4] = {'T', 'R', 'H', 'R'};
+        constexpr uint16_t Version = 1;
+        constexpr size_t HeaderSize = sizeof(Magic) + 4;
+
+        //! Event types in the file, independent of the SDL event numbering.
+        enum class RecordedEvent : uint8_t {
+            KeyDown,
+            KeyUp,
+            MouseMotion,
+            MouseButtonDown,
+            MouseButtonUp,
+            MouseWheel,
+            GamepadButtonDown,
+            GamepadButtonUp,
+            GamepadAxis,
+            GamepadAdded,
+            GamepadRemoved,
+            Count
+        };
+
+        void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        void writeSigned(std::vector<uint8_t>& out, int64_t value) {
+            writeVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        }
+
+        void writeFixed(std::vector<uint8_t>& out, uint64_t bits, size_t bytes) {
+            for (size_t i = 0; i < bytes; ++i) {
+                out.push_back(static_cast<uint8_t>(bits >> (i * 8)));
+            }
+        }
+
+        //! Bounds checked little endian reader, every read fails once the end is passed.
+        class Reader {
+        public:
+            Reader(const std::vector<uint8_t>& bytes, size_t position) : bytes_(bytes), position_(position) {}
+
+            bool readByte(uint8_t& value) {
+                if (position_ >= bytes_.size()) {
+                    return false;
+                }
+                value = bytes_[position_++];
+                return true;
+            }
+
+            bool readFixed(uint64_t& value, size_t bytes) {
+                if (bytes_.size() - position_ < bytes) {
+                    return false;
+                }
+                value = 0;
+                for (size_t i = 0; i < bytes; ++i) {
+                    value |= static_cast<uint64_t>(bytes_[position_++]) << (i * 8);
+                }
+                return true;
+            }
+
+            bool readVarint(uint64_t& value) {
+                value = 0;
+                for (uint32_t shift = 0; shift < 64; shift += 7) {
+                    uint8_t byte;
+                    if (!readByte(byte)) {
+                        return false;
+                    }
+                    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                    if (!(byte & 0x80)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            bool readSigned(int64_t& value) {
+                uint64_t encoded;
+                if (!readVarint(encoded)) {
+                    return false;
+                }
+                value = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+                return true;
+            }
+
+            [[nodiscard]] size_t getPosition() const { return position_; }
+            [[nodiscard]] bool isAtEnd() const { return position_ == bytes_.size(); }
+
+        private:
+            const std::vector<uint8_t>& bytes_;
+            size_t position_;
+        };
+
+        //! Decodes one event, event is only written when the result is true.
+        bool readEvent(Reader& reader, SDL_Event& event, uint32_t timestamp) {
+            uint8_t type;
+            if (!reader.readByte(type) || type >= static_cast<uint8_t>(RecordedEvent::Count)) {
+                return false;
+            }
+
+            uint64_t value = 0;
+            int64_t a = 0, b = 0, c = 0, d = 0;
+            uint8_t byte = 0;
+            std::memset(&event, 0, sizeof(event));
+            switch (static_cast<RecordedEvent>(type)) {
+                case RecordedEvent::KeyDown:
+                case RecordedEvent::KeyUp: {
+                    bool down = static_cast<RecordedEvent>(type) == RecordedEvent::KeyDown;
+                    if (!reader.readVarint(value) || value >= SDL_NUM_SCANCODES) {
+                        return false;
+                    }
+                    event.type = down ? SDL_KEYDOWN : SDL_KEYUP;
+                    event.key.state = down ? SDL_PRESSED : SDL_RELEASED;
+                    event.key.keysym.scancode = static_cast<SDL_Scancode>(value);
+                    event.key.timestamp = timestamp;
+                    return true;
+                }
+                case RecordedEvent::MouseMotion:
+                    if (!reader.readSigned(a) || !reader.readSigned(b) || !reader.readSigned(c) || !reader.readSigned(d)) {
+                        return false;
+                    }
+                    event.type = SDL_MOUSEMOTION;
+                    event.motion.x = static_cast<Sint32>(a);
+                    event.motion.y = static_cast<Sint32>(b);
+                    event.motion.xrel = static_cast<Sint32>(c);
+                    event.motion.yrel = static_cast<Sint32>(d);
+                    event.motion.timestamp = timestamp;
+                    return true;
+                case RecordedEvent::MouseButtonDown:
+                case RecordedEvent::MouseButtonUp: {
+                    bool down = static_cast<RecordedEvent>(type) == RecordedEvent::MouseButtonDown;
+                    if (!reader.readByte(byte)) {
+                        return false;
+                    }
+                    event.type = down ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+                    event.button.state = down ? SDL_PRESSED : SDL_RELEASED;
+                    event.button.button = byte;
+                    event.button.timestamp = timestamp;
+                    return true;
+                }
+                case RecordedEvent::MouseWheel:
+                    if (!reader.readFixed(value, sizeof(float))) {
+                        return false;
+                    }
+                    event.type = SDL_MOUSEWHEEL;
+                    event.wheel.preciseY = std::bit_cast<float>(static_cast<uint32_t>(value));
+                    event.wheel.y = static_cast<Sint32>(event.wheel.preciseY);
+                    event.wheel.timestamp = timestamp;
+                    return true;
+                case RecordedEvent::GamepadButtonDown:
+                case RecordedEvent::GamepadButtonUp: {
+                    bool down = static_cast<RecordedEvent>(type) == RecordedEvent::GamepadButtonDown;
+                    if (!reader.readSigned(a) || !reader.readByte(byte)) {
+                        return false;
+                    }
+                    event.type = down ? SDL_CONTROLLERBUTTONDOWN : SDL_CONTROLLERBUTTONUP;
+                    event.cbutton.state = down ? SDL_PRESSED : SDL_RELEASED;
+                    event.cbutton.which = static_cast<SDL_JoystickID>(a);
+                    event.cbutton.button = byte;
+                    event.cbutton.timestamp = timestamp;
+                    return true;
+                }
+                case RecordedEvent::GamepadAxis:
+                    if (!reader.readSigned(a) || !reader.readByte(byte) || !reader.readSigned(b)) {
+                        return false;
+                    }
+                    event.type = SDL_CONTROLLERAXISMOTION;
+                    event.caxis.which = static_cast<SDL_JoystickID>(a);
+                    event.caxis.axis = byte;
+                    event.caxis.value = static_cast<Sint16>(std::clamp<int64_t>(b, INT16_MIN, INT16_MAX));
+                    event.caxis.timestamp = timestamp;
+                    return true;
+                case RecordedEvent::GamepadAdded:
+                case RecordedEvent::GamepadRemoved:
+                    if (!reader.readSigned(a)) {
+                        return false;
+                    }
+                    event.type = static_cast<RecordedEvent>(type) == RecordedEvent::GamepadAdded
+                        ? SDL_CONTROLLERDEVICEADDED : SDL_CONTROLLERDEVICEREMOVED;
+                    event.cdevice.which = static_cast<Sint32>(a);
+                    event.cdevice.timestamp = timestamp;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+    }
+
+    FrameTimeStats computeFrameTimeStats(std::vector<double>& frameTimesMs) {
+        FrameTimeStats stats;
+        if (frameTimesMs.empty()) {
+            return stats;
+        }
+
+        std::sort(frameTimesMs.begin(), frameTimesMs.end());
+        double sum = 0.0;
+        for (double time : frameTimesMs) {
+            sum += time;
+        }
+
+        // Nearest rank percentiles
+        auto percentile = [&frameTimesMs](double p) {
+            auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(frameTimesMs.size())));
+            return frameTimesMs[std::clamp<size_t>(rank, 1, frameTimesMs.size()) - 1];
+        };
+
+        stats.Frames = frameTimesMs.size();
+        stats.AverageMs = sum / static_cast<double>(frameTimesMs.size());
+        stats.P50Ms = percentile(0.50);
+        stats.P95Ms = percentile(0.95);
+        stats.P99Ms = percentile(0.99);
+        stats.MaxMs = frameTimesMs.back();
+        return stats;
+    }
+
+    UniquePtr<FrameRecorder> FrameRecorder::create(const String& path, const Input& input) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            auto logger = LogManager::getInstance().getLogger();
+            logger->error(std::format("Failed to create input recording {}", path));
+            return nullptr;
+        }
+
+        auto recorder = UniquePtr<FrameRecorder>(new FrameRecorder(std::move(file)));
+        auto& header = recorder->buffer_;
+        header.insert(header.end(), std::begin(Magic), std::end(Magic));
+        writeFixed(header, Version, sizeof(Version));
+        header.push_back(static_cast<uint8_t>(RecordedSamplesPerFrame));
+
+        std::vector<SDL_JoystickID> gamepads;
+        for (size_t pad = 0; pad < Input::MaxGamepads; ++pad) {
+            if (input.isGamepadConnected(pad)) {
+                gamepads.push_back(input.getGamepadInstanceId(pad));
+            }
+        }
+        header.push_back(static_cast<uint8_t>(gamepads.size()));
+        for (auto instanceId : gamepads) {
+            writeSigned(header, instanceId);
+        }
+        return recorder;
+    }
+
+    FrameRecorder::~FrameRecorder() {
+        if (inFrame_) {
+            endFrame();
+        }
+        flush();
+    }
+
+    void FrameRecorder::beginFrame(double deltaTime) {
+        if (inFrame_) {
+            endFrame();
+        }
+        inFrame_ = true;
+        deltaTime_ = deltaTime;
+        for (uint32_t sample = 0; sample < RecordedSamplesPerFrame; ++sample) {
+            samples_[sample].clear();
+            sampleCounts_[sample] = 0;
+        }
+    }
+
+    void FrameRecorder::recordEvent(uint32_t sample, const SDL_Event& event) {
+        if (!inFrame_ || sample >= RecordedSamplesPerFrame) {
+            return;
+        }
+
+        auto& out = samples_[sample];
+        auto writeType = [&out](RecordedEvent type) { out.push_back(static_cast<uint8_t>(type)); };
+        switch (event.type) {
+            case SDL_KEYDOWN:
+            case SDL_KEYUP:
+                // Repeats do not change the input state
+                if (event.key.repeat) {
+                    return;
+                }
+                writeType(event.type == SDL_KEYDOWN ? RecordedEvent::KeyDown : RecordedEvent::KeyUp);
+                writeVarint(out, static_cast<uint32_t>(event.key.keysym.scancode));
+                break;
+            case SDL_MOUSEMOTION:
+                writeType(RecordedEvent::MouseMotion);
+                writeSigned(out, event.motion.x);
+                writeSigned(out, event.motion.y);
+                writeSigned(out, event.motion.xrel);
+                writeSigned(out, event.motion.yrel);
+                break;
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+                writeType(event.type == SDL_MOUSEBUTTONDOWN ? RecordedEvent::MouseButtonDown : RecordedEvent::MouseButtonUp);
+                out.push_back(event.button.button);
+                break;
+            case SDL_MOUSEWHEEL:
+                writeType(RecordedEvent::MouseWheel);
+                writeFixed(out, std::bit_cast<uint32_t>(event.wheel.preciseY), sizeof(float));
+                break;
+            case SDL_CONTROLLERBUTTONDOWN:
+            case SDL_CONTROLLERBUTTONUP:
+                writeType(event.type == SDL_CONTROLLERBUTTONDOWN ? RecordedEvent::GamepadButtonDown : RecordedEvent::GamepadButtonUp);
+                writeSigned(out, event.cbutton.which);
+                out.push_back(event.cbutton.button);
+                break;
+            case SDL_CONTROLLERAXISMOTION:
+                writeType(RecordedEvent::GamepadAxis);
+                writeSigned(out, event.caxis.which);
+                out.push_back(event.caxis.axis);
+                writeSigned(out, event.caxis.value);
+                break;
+            case SDL_CONTROLLERDEVICEADDED:
+                // The device index is only valid in this session, the replay needs the instance id
+                writeType(RecordedEvent::GamepadAdded);
+                writeSigned(out, SDL_JoystickGetDeviceInstanceID(event.cdevice.which));
+                break;
+            case SDL_CONTROLLERDEVICEREMOVED:
+                writeType(RecordedEvent::GamepadRemoved);
+                writeSigned(out, event.cdevice.which);
+                break;
+            default:
+                return;
+        }
+        sampleCounts_[sample]++;
+    }
+
+    void FrameRecorder::endFrame() {
+        if (!inFrame_) {
+            return;
+        }
+        inFrame_ = false;
+
+        writeFixed(buffer_, std::bit_cast<uint64_t>(deltaTime_), sizeof(double));
+        for (uint32_t sample = 0; sample < RecordedSamplesPerFrame; ++sample) {
+            writeVarint(buffer_, sampleCounts_[sample]);
+            buffer_.insert(buffer_.end(), samples_[sample].begin(), samples_[sample].end());
+        }
+        frames_++;
+
+        if (buffer_.size() >= FlushSize) {
+            flush();
+        }
+    }
+
+    void FrameRecorder::flush() {
+        if (buffer_.empty()) {
+            return;
+        }
+        file_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+        file_.flush();
+        buffer_.clear();
+    }
+
+    Result<FrameReplay> FrameReplay::load(const String& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return Result<FrameReplay>::error(std::format("Failed to open {}", path));
+        }
+
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        auto replay = fromBytes(std::move(bytes));
+        if (replay.is_error()) {
+            return Result<FrameReplay>::error(std::format("{}: {}", path, replay.unwrap_err()));
+        }
+        return replay;
+    }
+
+    Result<FrameReplay> FrameReplay::fromBytes(std::vector<uint8_t> bytes) {
+        if (bytes.size() < HeaderSize || std::memcmp(bytes.data(), Magic, sizeof(Magic)) != 0) {
+            return Result<FrameReplay>::error("Not an input recording");
+        }
+
+        FrameReplay replay;
+        replay.bytes_ = std::move(bytes);
+        Reader reader(replay.bytes_, sizeof(Magic));
+        uint64_t version = 0;
+        uint8_t samples = 0;
+        uint8_t gamepads = 0;
+        reader.readFixed(version, sizeof(Version));
+        reader.readByte(samples);
+        reader.readByte(gamepads);
+        if (version != Version) {
+            return Result<FrameReplay>::error(std::format("Unsupported input recording version {}", version));
+        }
+        if (samples != RecordedSamplesPerFrame) {
+            return Result<FrameReplay>::error(std::format("Input recording has {} samples per frame, expected {}",
+                samples, RecordedSamplesPerFrame));
+        }
+
+        for (uint8_t i = 0; i < gamepads; ++i) {
+            int64_t instanceId;
+            if (!reader.readSigned(instanceId)) {
+                return Result<FrameReplay>::error("Truncated input recording header");
+            }
+            replay.initialGamepads_.push_back(static_cast<SDL_JoystickID>(instanceId));
+        }
+        replay.firstFrame_ = reader.getPosition();
+
+        // Decoding every frame once means readFrame() cannot fail during the replay
+        SDL_Event event;
+        while (!reader.isAtEnd()) {
+            uint64_t deltaBits;
+            if (!reader.readFixed(deltaBits, sizeof(double))) {
+                return Result<FrameReplay>::error(std::format("Truncated frame {}", replay.frameCount_));
+            }
+            double deltaTime = std::bit_cast<double>(deltaBits);
+            if (!std::isfinite(deltaTime) || deltaTime < 0.0) {
+                return Result<FrameReplay>::error(std::format("Invalid delta time in frame {}", replay.frameCount_));
+            }
+
+            for (uint32_t sample = 0; sample < RecordedSamplesPerFrame; ++sample) {
+                uint64_t count;
+                if (!reader.readVarint(count)) {
+                    return Result<FrameReplay>::error(std::format("Truncated frame {}", replay.frameCount_));
+                }
+                for (uint64_t i = 0; i < count; ++i) {
+                    if (!readEvent(reader, event, 0)) {
+                        return Result<FrameReplay>::error(std::format("Invalid event in frame {}", replay.frameCount_));
+                    }
+                }
+            }
+            replay.frameCount_++;
+        }
+
+        replay.cursor_ = replay.firstFrame_;
+        return Result<FrameReplay>::ok(std::move(replay));
+    }
+
+    bool FrameReplay::readFrame(ReplayFrame& frame, uint32_t timestamp) {
+        if (cursor_ >= bytes_.size()) {
+            return false;
+        }
+
+        // The stream was validated by fromBytes()
+        Reader reader(bytes_, cursor_);
+        uint64_t deltaBits = 0;
+        reader.readFixed(deltaBits, sizeof(double));
+        frame.DeltaTime = std::bit_cast<double>(deltaBits);
+        for (auto& events : frame.Samples) {
+            events.clear();
+            uint64_t count = 0;
+            reader.readVarint(count);
+            events.resize(count);
+            for (auto& event : events) {
+                readEvent(reader, event, timestamp);
+            }
+        }
+        cursor_ = reader.getPosition();
+        return true;
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+#include <SDL_events.h>
+#include "result.h"
+#include "../triharder.h"
+
+namespace TriHarder {
+
+    class Input;
+
+    //! Number of input sample points per frame, see Application::run().
+    constexpr uint32_t RecordedSamplesPerFrame = 2;
+
+    //! @struct ReplayFrame
+    //! @brief The delta time and input events of one recorded frame.
+    struct ReplayFrame {
+        double DeltaTime = 0.0;
+        //! Events per sample point. Gamepads connected during the recording appear as
+        //! SDL_CONTROLLERDEVICEADDED with the instance id in cdevice.which.
+        std::vector<SDL_Event> Samples[RecordedSamplesPerFrame];
+    };
+
+    //! @struct FrameTimeStats
+    //! @brief Distribution of frame times in milliseconds.
+    struct FrameTimeStats {
+        uint64_t Frames = 0;
+        double AverageMs = 0.0;
+        double P50Ms = 0.0;
+        double P95Ms = 0.0;
+        double P99Ms = 0.0;
+        double MaxMs = 0.0;
+    };
+
+    //! Computes the distribution of the given frame times, the vector is sorted in place.
+    FrameTimeStats computeFrameTimeStats(std::vector<double>& frameTimesMs);
+
+    //! @class FrameRecorder
+    //! @brief Writes the input events and delta time of every frame to a compact binary file.
+    //!
+    //! Only events consumed by Input are stored, with variable length integers, so a
+    //! frame without input takes 10 bytes. Delta times are stored bit exact, which lets
+    //! a replay reproduce the simulation exactly.
+    class FrameRecorder {
+    public:
+        //! Creates the file and stores the gamepads connected to input.
+        //! @return The recorder or nullptr if the file cannot be written.
+        static UniquePtr<FrameRecorder> create(const String& path, const Input& input);
+
+        //! Flushes the remaining frames.
+        ~FrameRecorder();
+
+        FrameRecorder(const FrameRecorder&) = delete;
+        FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+        void beginFrame(double deltaTime);
+
+        //! Stores an event that Input consumed, other events are ignored.
+        //! @param sample Index of the sample point within the frame.
+        void recordEvent(uint32_t sample, const SDL_Event& event);
+
+        void endFrame();
+
+        [[nodiscard]] uint64_t getFrameCount() const { return frames_; }
+
+    private:
+        explicit FrameRecorder(std::ofstream file) : file_(std::move(file)) {}
+
+        void flush();
+
+        static constexpr size_t FlushSize = 64 * 1024;
+
+        std::ofstream file_;
+        std::vector<uint8_t> buffer_;
+        std::vector<uint8_t> samples_[RecordedSamplesPerFrame];
+        uint32_t sampleCounts_[RecordedSamplesPerFrame] = {};
+        double deltaTime_ = 0.0;
+        uint64_t frames_ = 0;
+        bool inFrame_ = false;
+    };
+
+    //! @class FrameReplay
+    //! @brief Reads a file written by FrameRecorder back frame by frame.
+    //!
+    //! The whole file is loaded and validated up front, so replaying does not touch the
+    //! disk and cannot fail halfway.
+    class FrameReplay {
+    public:
+        static Result<FrameReplay> load(const String& path);
+
+        //! Parses a recording held in memory.
+        static Result<FrameReplay> fromBytes(std::vector<uint8_t> bytes);
+
+        //! Decodes the next frame into frame, reusing its event buffers.
+        //! @param timestamp Stored in the decoded events, SDL_GetTicks() keeps the latency statistics meaningful.
+        //! @return False at the end of the recording.
+        bool readFrame(ReplayFrame& frame, uint32_t timestamp = 0);
+
+        //! Starts again at the first frame.
+        void rewind() { cursor_ = firstFrame_; }
+
+        [[nodiscard]] uint64_t getFrameCount() const { return frameCount_; }
+
+        //! @return Instance ids of the gamepads connected when the recording started.
+        [[nodiscard]] const std::vector<SDL_JoystickID>& getInitialGamepads() const { return initialGamepads_; }
+
+    private:
+        std::vector<uint8_t> bytes_;
+        std::vector<SDL_JoystickID> initialGamepads_;
+        size_t firstFrame_ = 0;
+        size_t cursor_ = 0;
+        uint64_t frameCount_ = 0;
+    };
+}
@@ -0,0 +1,124 @@
+#include "job_system.h"
+#include <algorithm>
+
+namespace TriHarder {
+
+    static thread_local uint32_t currentWorker = 0;
+
+    JobSystem& JobSystem::getInstance() {
+        static JobSystem instance;
+        return instance;
+    }
+
+    JobSystem::~JobSystem() {
+        shutdown();
+    }
+
+    uint32_t JobSystem::getCurrentWorker() {
+        return currentWorker;
+    }
+
+    void JobSystem::initialize(uint32_t threadCount) {
+        if (isInitialized()) {
+            return;
+        }
+
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        }
+
+        stopping_ = false;
+        workers_.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i) {
+            workers_.emplace_back(&JobSystem::workerLoop, this, i + 1);
+        }
+    }
+
+    void JobSystem::shutdown() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        condition_.notify_all();
+
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        workers_.clear();
+    }
+
+    void JobSystem::enqueue(std::function<void()> job) {
+        if (!isInitialized()) {
+            job();
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            jobs_.push_back(std::move(job));
+        }
+        condition_.notify_one();
+    }
+
+    void JobSystem::workerLoop(uint32_t worker) {
+        currentWorker = worker;
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock lock(mutex_);
+                condition_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+                if (jobs_.empty()) {
+                    return;
+                }
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            job();
+        }
+    }
+
+    void JobSystem::parallelFor(size_t count, size_t minBatchSize, const RangeFunction& function) {
+        if (count == 0) {
+            return;
+        }
+
+        minBatchSize = std::max<size_t>(1, minBatchSize);
+        size_t slots = getWorkerSlotCount();
+        size_t batchCount = std::min(slots, (count + minBatchSize - 1) / minBatchSize);
+        if (batchCount <= 1) {
+            function(0, count, getCurrentWorker());
+            return;
+        }
+
+        // Batches are handed out through an atomic cursor, the caller takes part as well.
+        // The counters are shared with the helper jobs because a helper may only start
+        // after all batches have been finished by other threads.
+        struct BatchState {
+            std::atomic<size_t> nextBatch{0};
+            std::atomic<size_t> finishedBatches{0};
+        };
+        auto state = createSharedPtr<BatchState>();
+        size_t batchSize = (count + batchCount - 1) / batchCount;
+        auto runBatches = [state, batchCount, batchSize, count, &function, tag = MemoryTracker::getCurrentTag()]() {
+            MemoryTagScope scope(tag);
+            size_t batch;
+            while ((batch = state->nextBatch.fetch_add(1, std::memory_order_relaxed)) < batchCount) {
+                size_t begin = batch * batchSize;
+                size_t end = std::min(count, begin + batchSize);
+                function(begin, end, getCurrentWorker());
+                state->finishedBatches.fetch_add(1, std::memory_order_release);
+            }
+        };
+
+        for (size_t i = 1; i < batchCount; ++i) {
+            enqueue(runBatches);
+        }
+        runBatches();
+
+        // Every batch is claimed at this point and running on a worker. Unrelated queued jobs
+        // such as stream reads or capture encoding are not picked up, they could stall the caller
+        while (state->finishedBatches.load(std::memory_order_acquire) < batchCount) {
+            std::this_thread::yield();
+        }
+    }
+}
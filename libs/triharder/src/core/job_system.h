@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "memory_tracker.h"
+#include "../triharder.h"
+
+namespace TriHarder {
+
+    //! @class JobSystem
+    //! @brief A fixed size worker pool for fire-and-forget jobs and data parallel loops.
+    //!
+    //! Workers are numbered from 1 to getThreadCount(); the thread calling parallelFor()
+    //! participates as worker 0. Subsystems that keep per-thread scratch buffers should
+    //! therefore size them with getWorkerSlotCount(). Without initialize() all work runs
+    //! inline on the calling thread.
+    class JobSystem {
+    public:
+        //! Callback for a parallelFor batch: [begin, end) range and the worker slot.
+        using RangeFunction = std::function<void(size_t begin, size_t end, uint32_t worker)>;
+
+        static JobSystem& getInstance();
+
+        //! Starts the worker threads.
+        //! @param threadCount Number of workers, 0 selects hardware_concurrency - 1.
+        void initialize(uint32_t threadCount = 0);
+
+        //! Joins all workers. Pending jobs are finished first.
+        void shutdown();
+
+        [[nodiscard]] bool isInitialized() const { return !workers_.empty(); }
+
+        //! @return Number of background worker threads.
+        [[nodiscard]] uint32_t getThreadCount() const { return static_cast<uint32_t>(workers_.size()); }
+
+        //! @return Number of distinct worker slots including the calling thread.
+        [[nodiscard]] uint32_t getWorkerSlotCount() const { return getThreadCount() + 1; }
+
+        //! @return The worker slot of the current thread, 0 for threads outside the pool.
+        [[nodiscard]] static uint32_t getCurrentWorker();
+
+        //! Queues a job and returns a future for its result.
+        //! The job allocates under the MemoryTag of the submitting thread.
+        template<typename F>
+        auto submit(F&& function) -> std::future<std::invoke_result_t<F>> {
+            using ReturnType = std::invoke_result_t<F>;
+            auto task = createSharedPtr<std::packaged_task<ReturnType()>>(std::forward<F>(function));
+            auto future = task->get_future();
+            enqueue([task, tag = MemoryTracker::getCurrentTag()]() {
+                MemoryTagScope scope(tag);
+                (*task)();
+            });
+            return future;
+        }
+
+        //! Splits [0, count) into batches of at least minBatchSize and runs them on all
+        //! workers including the calling thread. Returns when every batch has finished.
+        //! Threads outside the pool share worker slot 0, so only one of them should
+        //! issue parallel loops with per-slot buffers at a time.
+        void parallelFor(size_t count, size_t minBatchSize, const RangeFunction& function);
+
+    private:
+        JobSystem() = default;
+        ~JobSystem();
+
+        void enqueue(std::function<void()> job);
+        void workerLoop(uint32_t worker);
+
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> jobs_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool stopping_ = false;
+    };
+}
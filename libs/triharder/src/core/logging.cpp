@@ -10,16 +10,35 @@ namespace TriHarder {
     }
 
     SharedPtr<ILogger> LogManager::getLogger() {
+        // Fast path for the default logger: one integer hash lookup, no string hashing
+        if (auto logger = findLogger("TriHarder")) {
+            return logger;
+        }
         return getLogger("TriHarder");
     }
 
+    SharedPtr<ILogger> LogManager::findLogger(StringId id) {
+        std::lock_guard lock(m_mutex);
+        auto logger = m_loggers.find(id);
+        return logger ? *logger : nullptr;
+    }
+
     SharedPtr<ILogger> LogManager::getLogger(const String& name,
                                              bool allowFile,
                                              bool allowNetwork) {
-        auto it = m_loggers.find(name);
-        if (it != m_loggers.end()) {
-            return it->second;
+        auto id = StringId::hash(name);
+        if (auto logger = findLogger(id)) {
+            return logger;
+        }
+
+        // Interned outside of the lock, a hash collision is reported through a logger
+        StringId::intern(name);
+
+        std::lock_guard lock(m_mutex);
+        if (auto existing = m_loggers.find(id)) {
+            return *existing;
         }
+        MemoryTagScope scope(MemoryTag::Logging);
 
         // Create multi-sink logger for different destinations
         std::vector<spdlog::sink_ptr> sinks;
@@ -43,7 +62,7 @@ namespace TriHarder {
         spdlog::register_logger(logger);
 
         auto spdLogger = createSharedPtr<SpdLogger>(name, logger);
-        m_loggers[name] = spdLogger;
+        m_loggers.insertOrAssign(id, spdLogger);
         return spdLogger;
     }
 
@@ -51,4 +70,9 @@ namespace TriHarder {
         return m_defaultTargets & target;
     }
 
+    void LogManager::setDefaultTargets(LogTargets targets) {
+        std::lock_guard lock(m_mutex);
+        m_defaultTargets = targets;
+    }
+
 }
@@ -1,8 +1,12 @@
-#include <unordered_map>
+#pragma once
+
+#include <mutex>
 #include <filesystem>
 #include <utility>
 #include <format>
 #include "../triharder.h"
+#include "memory_tracker.h"
+#include "string_id_map.h"
 #include "spdlog/spdlog.h"
 
 namespace TriHarder {
@@ -79,24 +83,28 @@ namespace TriHarder {
         //! Logs a debug message using spdlog's debug method.
         //! @param message The message to log at debug level.
         void debug(const String& message) const override {
+            MemoryTagScope scope(MemoryTag::Logging);
             m_logger->debug(message);
         }
 
         //! Logs an information message using spdlog's info method.
         //! @param message The message to log at info level.
         void info(const String& message) const override {
+            MemoryTagScope scope(MemoryTag::Logging);
             m_logger->info(message);
         }
 
         //! Logs a warning message using spdlog's warn method.
         //! @param message The message to warn about.
         void warn(const String& message) const override {
+            MemoryTagScope scope(MemoryTag::Logging);
             m_logger->warn(message);
         }
 
         //! Logs an error message using spdlog's error method.
         //! @param message The error message to log.
         void error(const String& message) const override {
+            MemoryTagScope scope(MemoryTag::Logging);
             m_logger->error(message);
         }
 
@@ -230,6 +238,9 @@ namespace TriHarder {
         return lhs;
     }
 
+    //! @class LogManager
+    //! @brief Creates and caches loggers. All methods are thread-safe so loggers can be
+    //! created on a background thread while the window is being set up.
     class LogManager {
     public:
         static LogManager& getInstance();
@@ -237,12 +248,20 @@ namespace TriHarder {
         SharedPtr<ILogger> getLogger();
         SharedPtr<ILogger> getLogger(const String& name, bool allowFile = true, bool allowNetwork = true);
 
+        //! Returns an existing logger by id without touching the name.
+        //! @return The logger or nullptr if no logger with this id has been created yet.
+        SharedPtr<ILogger> findLogger(StringId id);
+
         [[nodiscard]] bool isDefaultTargetEnabled(uint8_t target) const;
 
+        //! Sets the targets of loggers created afterwards, e.g. console only for tests.
+        void setDefaultTargets(LogTargets targets);
+
     private:
-        std::unordered_map<String, SharedPtr<ILogger>> m_loggers;
+        StringIdMap<SharedPtr<ILogger>> m_loggers;
         LogTargets m_defaultTargets = LogTargets::Console | LogTargets::File;
         LogLevel m_defaultLevel = LogLevel::Debug;
         String m_defaultPattern = "[%Y-%m-%d %H:%M:%S] [%^%l%$] %v";
+        std::mutex m_mutex;
     };
 }
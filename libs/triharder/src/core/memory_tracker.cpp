@@ -0,0 +1,591 @@
+#include "memory_tracker.h"
+#include <algorithm>
+#include <format>
+#include "logging.h"
+
+#if TRIHARDER_MEMORY_TRACKING
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define TRIHARDER_MEMORY_CALLSTACKS 1
+#elif defined(_WIN32)
+// Keeps windows.h from defining min and max macros that break std::min and std::max below
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#define TRIHARDER_MEMORY_CALLSTACKS 1
+#else
+#define TRIHARDER_MEMORY_CALLSTACKS 0
+#endif
+#endif
+
+namespace TriHarder {
+
+    const char* toString(MemoryTag tag) {
+        switch (tag) {
+            case MemoryTag::General:
+                return "general";
+            case MemoryTag::Rendering:
+                return "rendering";
+            case MemoryTag::Assets:
+                return "assets";
+            case MemoryTag::Logging:
+                return "logging";
+            case MemoryTag::Scene:
+                return "scene";
+            case MemoryTag::Audio:
+                return "audio";
+            case MemoryTag::Physics:
+                return "physics";
+            case MemoryTag::Input:
+                return "input";
+            case MemoryTag::Tasks:
+                return "tasks";
+            default:
+                return "unknown";
+        }
+    }
+
+#if TRIHARDER_MEMORY_TRACKING
+    namespace {
+        constexpr size_t TagCount = static_cast<size_t>(MemoryTag::Count);
+        constexpr size_t GpuKindCount = static_cast<size_t>(GpuMemoryKind::Count);
+
+        struct TagCounters {
+            std::atomic<uint64_t> Allocations{0};
+            std::atomic<uint64_t> Frees{0};
+            std::atomic<uint64_t> AllocatedBytes{0};
+            std::atomic<uint64_t> FreedBytes{0};
+        };
+
+        //! Counters of one thread. Blocks are never freed, a block released by an exiting
+        //! thread is taken over by the next new thread and its counts stay in the totals.
+        struct ThreadCounters {
+            std::array<TagCounters, TagCount> Tags;
+            std::atomic<bool> InUse{true};
+            ThreadCounters* Next = nullptr;
+        };
+
+        //! Stored in front of every block, the user pointer keeps the requested alignment.
+        struct AllocationHeader {
+            uint64_t Size;
+            uint32_t Offset; //!< Distance from the start of the block to the user pointer.
+            MemoryTag Tag;
+            bool Captured;
+            bool Aligned; //!< Allocated by the aligned allocator, which needs its own free on Windows.
+        };
+
+        constexpr size_t HeaderSize = std::max(sizeof(AllocationHeader), size_t(__STDCPP_DEFAULT_NEW_ALIGNMENT__));
+
+        // Everything here is constant initialized, operator new runs before any dynamic initializer
+        constinit std::atomic<ThreadCounters*> threads{nullptr};
+        constinit std::atomic<size_t> threadCount{0};
+        constinit std::atomic<int64_t> gpuBytes[TagCount][GpuKindCount]{};
+        constinit std::atomic<bool> captureCallstacks{false};
+
+        constinit thread_local ThreadCounters* currentCounters = nullptr;
+        constinit thread_local MemoryTag currentTag = MemoryTag::General;
+        constinit thread_local bool insideTracker = false;
+        constinit thread_local bool countersReleased = false;
+
+        //! Only the owning thread writes its counters, so a load and a store replace the locked add.
+        void add(std::atomic<uint64_t>& counter, uint64_t value) {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        ThreadCounters& acquireCounters() {
+            for (auto* counters = threads.load(std::memory_order_acquire); counters; counters = counters->Next) {
+                bool expected = false;
+                if (!counters->InUse.load(std::memory_order_relaxed) &&
+                    counters->InUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    return *counters;
+                }
+            }
+
+            // malloc keeps the tracker out of its own accounting
+            void* memory = std::malloc(sizeof(ThreadCounters));
+            if (!memory) {
+                std::abort();
+            }
+            auto* counters = new (memory) ThreadCounters();
+            counters->Next = threads.load(std::memory_order_relaxed);
+            while (!threads.compare_exchange_weak(counters->Next, counters, std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+            }
+            threadCount.fetch_add(1, std::memory_order_relaxed);
+            return *counters;
+        }
+
+        struct CountersRelease {
+            ~CountersRelease() {
+                if (currentCounters) {
+                    currentCounters->InUse.store(false, std::memory_order_release);
+                    currentCounters = nullptr;
+                }
+                countersReleased = true;
+            }
+        };
+
+        TagCounters& getCounters(MemoryTag tag) {
+            if (!currentCounters) {
+                currentCounters = &acquireCounters();
+                // Allocations in later thread_local destructors keep their block until the process ends
+                if (!countersReleased) {
+                    static thread_local CountersRelease release;
+                }
+            }
+            return currentCounters->Tags[static_cast<size_t>(tag)];
+        }
+
+        template<typename F>
+        void forEachCounters(F&& function) {
+            for (auto* counters = threads.load(std::memory_order_acquire); counters; counters = counters->Next) {
+                function(*counters);
+            }
+        }
+
+        //! Sums the allocations of all threads and tags.
+        MemoryFrameStats sumAllocations() {
+            MemoryFrameStats total;
+            forEachCounters([&total](ThreadCounters& counters) {
+                for (auto& tag : counters.Tags) {
+                    total.Allocations += tag.Allocations.load(std::memory_order_relaxed);
+                    total.Bytes += tag.AllocatedBytes.load(std::memory_order_relaxed);
+                }
+            });
+            return total;
+        }
+
+        int64_t sumLiveBytes() {
+            uint64_t allocated = 0;
+            uint64_t freed = 0;
+            forEachCounters([&](ThreadCounters& counters) {
+                for (auto& tag : counters.Tags) {
+                    allocated += tag.AllocatedBytes.load(std::memory_order_relaxed);
+                    freed += tag.FreedBytes.load(std::memory_order_relaxed);
+                }
+            });
+            return static_cast<int64_t>(allocated - freed);
+        }
+
+        struct FrameState {
+            std::mutex Mutex;
+            MemoryFrameStats Start;
+            MemoryFrameStats Last;
+            MemoryFrameStats Max;
+            uint64_t Frames = 0;
+            uint64_t FramesWithAllocations = 0;
+            int64_t PeakLiveBytes = 0;
+        };
+
+        FrameState& getFrameState() {
+            static FrameState state;
+            return state;
+        }
+
+        // Callstack capture
+        constexpr uint32_t MaxCallstackDepth = 24;
+
+        struct CapturedAllocation {
+            uint64_t Size;
+            MemoryTag Tag;
+            uint32_t Depth;
+            void* Frames[MaxCallstackDepth];
+        };
+
+        struct CallstackRegistry {
+            std::mutex Mutex;
+            std::unordered_map<void*, CapturedAllocation> Allocations;
+        };
+
+        CallstackRegistry& getCallstacks() {
+            // Never destroyed, blocks may still be freed during static destruction
+            static auto* registry = new CallstackRegistry();
+            return *registry;
+        }
+
+        uint32_t captureCallstack(void** frames, uint32_t maxDepth) {
+#if defined(_WIN32) && TRIHARDER_MEMORY_CALLSTACKS
+            return CaptureStackBackTrace(2, maxDepth, frames, nullptr);
+#elif TRIHARDER_MEMORY_CALLSTACKS
+            return static_cast<uint32_t>(std::max(backtrace(frames, static_cast<int>(maxDepth)), 0));
+#else
+            return 0;
+#endif
+        }
+
+        void recordCallstack(void* pointer, AllocationHeader& header) {
+            insideTracker = true;
+            CapturedAllocation captured{header.Size, header.Tag, 0, {}};
+            captured.Depth = captureCallstack(captured.Frames, MaxCallstackDepth);
+            {
+                auto& registry = getCallstacks();
+                std::lock_guard lock(registry.Mutex);
+                registry.Allocations[pointer] = captured;
+            }
+            header.Captured = true;
+            insideTracker = false;
+        }
+
+        void forgetCallstack(void* pointer) {
+            bool wasInside = std::exchange(insideTracker, true);
+            {
+                auto& registry = getCallstacks();
+                std::lock_guard lock(registry.Mutex);
+                registry.Allocations.erase(pointer);
+            }
+            insideTracker = wasInside;
+        }
+
+        bool needsAlignedBlock(size_t alignment) {
+            return alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+        }
+
+        void* allocateBlock(size_t size, size_t alignment) {
+            if (!needsAlignedBlock(alignment)) {
+                return std::malloc(size);
+            }
+#ifdef _WIN32
+            return _aligned_malloc(size, alignment);
+#else
+            // aligned_alloc needs a multiple of the alignment
+            return std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+        }
+
+        void freeBlock(void* block, bool aligned) {
+#ifdef _WIN32
+            if (aligned) {
+                _aligned_free(block);
+                return;
+            }
+#endif
+            (void)aligned;
+            std::free(block);
+        }
+
+        void* allocate(size_t size, size_t alignment) {
+            size_t offset = std::max(HeaderSize, alignment);
+            if (size > SIZE_MAX - offset) {
+                throw std::bad_alloc();
+            }
+
+            void* block;
+            while (!(block = allocateBlock(size + offset, alignment))) {
+                auto handler = std::get_new_handler();
+                if (!handler) {
+                    throw std::bad_alloc();
+                }
+                handler();
+            }
+
+            auto* pointer = static_cast<std::byte*>(block) + offset;
+            auto* header = reinterpret_cast<AllocationHeader*>(pointer - HeaderSize);
+            *header = {size, static_cast<uint32_t>(offset), currentTag, false, needsAlignedBlock(alignment)};
+
+            auto& counters = getCounters(header->Tag);
+            add(counters.Allocations, 1);
+            add(counters.AllocatedBytes, size);
+
+            if (captureCallstacks.load(std::memory_order_relaxed) && !insideTracker) {
+                recordCallstack(pointer, *header);
+            }
+            return pointer;
+        }
+
+        //! The header decides how the block is freed, the delete overload may not match the allocation,
+        //! e.g. an explicit aligned new with a small alignment.
+        void deallocate(void* pointer) {
+            if (!pointer) {
+                return;
+            }
+
+            auto* header = reinterpret_cast<AllocationHeader*>(static_cast<std::byte*>(pointer) - HeaderSize);
+            auto& counters = getCounters(header->Tag);
+            add(counters.Frees, 1);
+            add(counters.FreedBytes, header->Size);
+
+            if (header->Captured) {
+                forgetCallstack(pointer);
+            }
+            freeBlock(static_cast<std::byte*>(pointer) - header->Offset, header->Aligned);
+        }
+    }
+
+    MemoryTag MemoryTracker::getCurrentTag() {
+        return currentTag;
+    }
+
+    MemoryTag MemoryTracker::setCurrentTag(MemoryTag tag) {
+        return std::exchange(currentTag, tag);
+    }
+
+    void MemoryTracker::beginFrame() {
+        auto& state = getFrameState();
+        std::lock_guard lock(state.Mutex);
+        state.Start = sumAllocations();
+    }
+
+    MemoryFrameStats MemoryTracker::endFrame() {
+        auto total = sumAllocations();
+        auto live = sumLiveBytes();
+
+        auto& state = getFrameState();
+        std::lock_guard lock(state.Mutex);
+        state.Last = {total.Allocations - state.Start.Allocations, total.Bytes - state.Start.Bytes};
+        state.Max.Allocations = std::max(state.Max.Allocations, state.Last.Allocations);
+        state.Max.Bytes = std::max(state.Max.Bytes, state.Last.Bytes);
+        state.Frames++;
+        state.FramesWithAllocations += state.Last.Allocations > 0 ? 1 : 0;
+        state.PeakLiveBytes = std::max(state.PeakLiveBytes, live);
+        return state.Last;
+    }
+
+    void MemoryTracker::trackGpuMemory(MemoryTag tag, GpuMemoryKind kind, int64_t bytes) {
+        gpuBytes[static_cast<size_t>(tag)][static_cast<size_t>(kind)].fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    MemoryStats MemoryTracker::getStats() {
+        MemoryStats stats;
+        forEachCounters([&stats](ThreadCounters& counters) {
+            for (size_t tag = 0; tag < TagCount; ++tag) {
+                auto& source = counters.Tags[tag];
+                auto& target = stats.Tags[tag];
+                target.Allocations += source.Allocations.load(std::memory_order_relaxed);
+                target.Frees += source.Frees.load(std::memory_order_relaxed);
+                target.AllocatedBytes += source.AllocatedBytes.load(std::memory_order_relaxed);
+                target.LiveBytes += static_cast<int64_t>(source.AllocatedBytes.load(std::memory_order_relaxed) -
+                                                         source.FreedBytes.load(std::memory_order_relaxed));
+            }
+        });
+
+        for (size_t tag = 0; tag < TagCount; ++tag) {
+            auto& target = stats.Tags[tag];
+            target.GpuBufferBytes = gpuBytes[tag][static_cast<size_t>(GpuMemoryKind::Buffer)].load(std::memory_order_relaxed);
+            target.GpuTextureBytes = gpuBytes[tag][static_cast<size_t>(GpuMemoryKind::Texture)].load(std::memory_order_relaxed);
+
+            stats.Total.Allocations += target.Allocations;
+            stats.Total.Frees += target.Frees;
+            stats.Total.AllocatedBytes += target.AllocatedBytes;
+            stats.Total.LiveBytes += target.LiveBytes;
+            stats.Total.GpuBufferBytes += target.GpuBufferBytes;
+            stats.Total.GpuTextureBytes += target.GpuTextureBytes;
+        }
+
+        auto& state = getFrameState();
+        std::lock_guard lock(state.Mutex);
+        stats.LastFrame = state.Last;
+        stats.MaxFrame = state.Max;
+        stats.Frames = state.Frames;
+        stats.FramesWithAllocations = state.FramesWithAllocations;
+        stats.PeakLiveBytes = std::max(state.PeakLiveBytes, stats.Total.LiveBytes);
+        stats.Threads = threadCount.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void MemoryTracker::setCallstackCapture(bool enabled) {
+        captureCallstacks.store(enabled && TRIHARDER_MEMORY_CALLSTACKS, std::memory_order_relaxed);
+    }
+
+    size_t MemoryTracker::reportCapturedAllocations(size_t maxEntries) {
+        std::vector<CapturedAllocation> allocations;
+        {
+            bool wasInside = std::exchange(insideTracker, true);
+            auto& registry = getCallstacks();
+            std::lock_guard lock(registry.Mutex);
+            allocations.reserve(registry.Allocations.size());
+            for (const auto& [pointer, captured] : registry.Allocations) {
+                allocations.push_back(captured);
+            }
+            insideTracker = wasInside;
+        }
+        std::sort(allocations.begin(), allocations.end(), [](const auto& a, const auto& b) { return a.Size > b.Size; });
+
+        auto logger = LogManager::getInstance().getLogger();
+        logger->info(std::format("{} live allocations with a captured callstack", allocations.size()));
+        for (size_t i = 0; i < std::min(maxEntries, allocations.size()); ++i) {
+            const auto& captured = allocations[i];
+            String callstack;
+#if defined(_WIN32) || !TRIHARDER_MEMORY_CALLSTACKS
+            for (uint32_t frame = 0; frame < captured.Depth; ++frame) {
+                callstack += std::format("\n    {}", captured.Frames[frame]);
+            }
+#else
+            // The first frames are the tracker and operator new
+            char** symbols = backtrace_symbols(captured.Frames, static_cast<int>(captured.Depth));
+            for (uint32_t frame = 3; symbols && frame < captured.Depth; ++frame) {
+                callstack += std::format("\n    {}", symbols[frame]);
+            }
+            std::free(symbols);
+#endif
+            logger->info(std::format("{} bytes ({}){}", captured.Size, toString(captured.Tag), callstack));
+        }
+        return allocations.size();
+    }
+#endif
+
+    void MemoryTracker::report() {
+        auto logger = LogManager::getInstance().getLogger();
+        if (!Enabled) {
+            logger->info("Memory tracking is compiled out, configure with TRIHARDER_MEMORY_TRACKING=ON");
+            return;
+        }
+
+        auto stats = getStats();
+        constexpr double KiB = 1024.0;
+        for (size_t tag = 0; tag < stats.Tags.size(); ++tag) {
+            const auto& tagStats = stats.Tags[tag];
+            if (tagStats.Allocations == 0 && tagStats.GpuBufferBytes == 0 && tagStats.GpuTextureBytes == 0) {
+                continue;
+            }
+            logger->info(std::format("Memory {}: {:.1f} KiB live, {} allocations, {} frees, {:.1f} KiB allocated; "
+                                     "GPU buffers {:.1f} KiB, textures {:.1f} KiB",
+                                     toString(static_cast<MemoryTag>(tag)), tagStats.LiveBytes / KiB,
+                                     tagStats.Allocations, tagStats.Frees, tagStats.AllocatedBytes / KiB,
+                                     tagStats.GpuBufferBytes / KiB, tagStats.GpuTextureBytes / KiB));
+        }
+        logger->info(std::format("Memory total: {:.1f} KiB live, peak {:.1f} KiB, {} threads; "
+                                 "GPU {:.1f} KiB; {} of {} frames allocated, max {} allocations ({:.1f} KiB) per frame",
+                                 stats.Total.LiveBytes / KiB, stats.PeakLiveBytes / KiB, stats.Threads,
+                                 (stats.Total.GpuBufferBytes + stats.Total.GpuTextureBytes) / KiB,
+                                 stats.FramesWithAllocations, stats.Frames, stats.MaxFrame.Allocations,
+                                 stats.MaxFrame.Bytes / KiB));
+    }
+
+    void MemoryTracker::writeStats(std::ostream& stream) {
+        stream << "memory_tracking=" << (Enabled ? 1 : 0) << '\n';
+        if (!Enabled) {
+            return;
+        }
+
+        auto stats = getStats();
+        stream << "memory_live_bytes=" << stats.Total.LiveBytes << '\n'
+               << "memory_peak_live_bytes=" << stats.PeakLiveBytes << '\n'
+               << "memory_allocations=" << stats.Total.Allocations << '\n'
+               << "memory_gpu_buffer_bytes=" << stats.Total.GpuBufferBytes << '\n'
+               << "memory_gpu_texture_bytes=" << stats.Total.GpuTextureBytes << '\n'
+               << "memory_frames=" << stats.Frames << '\n'
+               << "memory_frames_with_allocations=" << stats.FramesWithAllocations << '\n'
+               << "memory_frame_max_allocations=" << stats.MaxFrame.Allocations << '\n'
+               << "memory_frame_max_bytes=" << stats.MaxFrame.Bytes << '\n';
+        for (size_t tag = 0; tag < stats.Tags.size(); ++tag) {
+            const auto& tagStats = stats.Tags[tag];
+            auto name = toString(static_cast<MemoryTag>(tag));
+            stream << "memory_" << name << "_live_bytes=" << tagStats.LiveBytes << '\n'
+                   << "memory_" << name << "_allocations=" << tagStats.Allocations << '\n'
+                   << "memory_" << name << "_gpu_bytes=" << tagStats.GpuBufferBytes + tagStats.GpuTextureBytes << '\n';
+        }
+        stream.flush();
+    }
+}
+
+#if TRIHARDER_MEMORY_TRACKING
+// Replacements of the global allocation functions. The nothrow variants are replaced as well,
+// sanitizer runtimes do not forward them to the throwing ones.
+void* operator new(std::size_t size) {
+    return TriHarder::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size) {
+    return TriHarder::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return TriHarder::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return TriHarder::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return TriHarder::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return TriHarder::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return TriHarder::allocate(size, static_cast<std::size_t>(alignment));
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return TriHarder::allocate(size, static_cast<std::size_t>(alignment));
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer) noexcept {
+    TriHarder::deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    TriHarder::deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    TriHarder::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    TriHarder::deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    TriHarder::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    TriHarder::deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    TriHarder::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    TriHarder::deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    TriHarder::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    TriHarder::deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    TriHarder::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    TriHarder::deallocate(pointer);
+}
+#endif
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include "../triharder.h"
+
+// Set by the TRIHARDER_MEMORY_TRACKING CMake option. Without it every function below is an
+// empty inline stub and the global allocation functions are not replaced.
+#ifndef TRIHARDER_MEMORY_TRACKING
+#define TRIHARDER_MEMORY_TRACKING 0
+#endif
+
+namespace TriHarder {
+
+    //! @enum MemoryTag
+    //! @brief Subsystem an allocation is accounted to.
+    enum class MemoryTag : uint8_t {
+        General,
+        Rendering,
+        Assets,
+        Logging,
+        Scene,
+        Audio,
+        Physics,
+        Input,
+        Tasks,
+        Count
+    };
+
+    const char* toString(MemoryTag tag);
+
+    //! @enum GpuMemoryKind
+    //! @brief Kind of GPU resource a memory estimate belongs to.
+    enum class GpuMemoryKind : uint8_t {
+        Buffer,
+        Texture,
+        Count
+    };
+
+    //! @struct MemoryTagStats
+    //! @brief Heap and estimated GPU memory of one tag, or of all tags in MemoryStats::Total.
+    struct MemoryTagStats {
+        uint64_t Allocations = 0;   //!< Allocations since start.
+        uint64_t Frees = 0;         //!< Frees since start.
+        uint64_t AllocatedBytes = 0;//!< Bytes allocated since start.
+        int64_t LiveBytes = 0;      //!< Bytes currently allocated.
+        int64_t GpuBufferBytes = 0; //!< Estimated size of live GPU buffers.
+        int64_t GpuTextureBytes = 0;//!< Estimated size of live GPU textures.
+    };
+
+    //! @struct MemoryFrameStats
+    //! @brief Allocations on all threads between MemoryTracker::beginFrame() and endFrame().
+    struct MemoryFrameStats {
+        uint64_t Allocations = 0;
+        uint64_t Bytes = 0;
+    };
+
+    //! @struct MemoryStats
+    //! @brief Snapshot of all counters.
+    struct MemoryStats {
+        std::array<MemoryTagStats, static_cast<size_t>(MemoryTag::Count)> Tags{};
+        MemoryTagStats Total;
+        MemoryFrameStats LastFrame;
+        MemoryFrameStats MaxFrame;
+        uint64_t Frames = 0;               //!< Frames measured by beginFrame() and endFrame().
+        uint64_t FramesWithAllocations = 0;//!< Measured frames that allocated at all.
+        int64_t PeakLiveBytes = 0;         //!< Highest live heap size seen at a frame end.
+        size_t Threads = 0;                //!< Threads that ever allocated.
+    };
+
+    //! @class MemoryTracker
+    //! @brief Accounts every heap allocation to the MemoryTag of the allocating thread.
+    //!
+    //! The global operator new and delete are replaced; a small header in front of each block
+    //! keeps its size and tag, so a free is accounted to the tag that allocated it even on
+    //! another thread. Every thread counts into its own block of relaxed atomics that only it
+    //! writes, so allocating never takes a lock. Readers sum the blocks of all threads.
+    class MemoryTracker {
+    public:
+        static constexpr bool Enabled = TRIHARDER_MEMORY_TRACKING != 0;
+
+#if TRIHARDER_MEMORY_TRACKING
+        [[nodiscard]] static MemoryTag getCurrentTag();
+
+        //! Sets the tag for the following allocations of the calling thread.
+        //! @return The previous tag.
+        static MemoryTag setCurrentTag(MemoryTag tag);
+
+        //! Starts counting the allocations of a frame.
+        static void beginFrame();
+
+        //! Stops counting and updates the frame statistics.
+        //! @return The allocations since beginFrame().
+        static MemoryFrameStats endFrame();
+
+        //! Adds an estimate of GPU memory, negative bytes when the resource is deleted.
+        static void trackGpuMemory(MemoryTag tag, GpuMemoryKind kind, int64_t bytes);
+
+        [[nodiscard]] static MemoryStats getStats();
+
+        //! Captures a callstack for every following allocation until disabled, used to hunt leaks.
+        //! Costs a stack walk and a map insertion per allocation.
+        static void setCallstackCapture(bool enabled);
+
+        //! Logs the live allocations with a captured callstack, largest first.
+        //! @return The number of live captured allocations.
+        static size_t reportCapturedAllocations(size_t maxEntries = 16);
+#else
+        [[nodiscard]] static MemoryTag getCurrentTag() { return MemoryTag::General; }
+        static MemoryTag setCurrentTag(MemoryTag) { return MemoryTag::General; }
+        static void beginFrame() {}
+        static MemoryFrameStats endFrame() { return {}; }
+        static void trackGpuMemory(MemoryTag, GpuMemoryKind, int64_t) {}
+        [[nodiscard]] static MemoryStats getStats() { return {}; }
+        static void setCallstackCapture(bool) {}
+        static size_t reportCapturedAllocations(size_t = 16) { return 0; }
+#endif
+
+        //! Logs the totals per tag through the default logger.
+        static void report();
+
+        //! Writes the totals as key=value lines for CI, e.g. memory_rendering_live_bytes=1024.
+        static void writeStats(std::ostream& stream);
+    };
+
+    //! @class MemoryTagScope
+    //! @brief RAII helper that accounts the allocations of a scope to a tag.
+    class MemoryTagScope {
+    public:
+#if TRIHARDER_MEMORY_TRACKING
+        explicit MemoryTagScope(MemoryTag tag) : previous_(MemoryTracker::setCurrentTag(tag)) {}
+        ~MemoryTagScope() { MemoryTracker::setCurrentTag(previous_); }
+#else
+        explicit MemoryTagScope(MemoryTag) {}
+#endif
+
+        MemoryTagScope(const MemoryTagScope&) = delete;
+        MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+#if TRIHARDER_MEMORY_TRACKING
+    private:
+        MemoryTag previous_;
+#endif
+    };
+}
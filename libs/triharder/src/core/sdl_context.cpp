@@ -10,14 +10,17 @@ namespace TriHarder {
     }
 
     bool SdlContext::initialize() {
-        auto logger = LogManager::getInstance().getLogger();
         if (initialized_)
         {
+            auto logger = LogManager::getInstance().getLogger();
             logger->warn("The SDL context has already been initialized. Attempting to initialize it again may lead to unexpected behavior.");
             return false;
         }
 
-        if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        // The logger is fetched after SDL_Init so the logger setup can overlap with it
+        int status = SDL_Init(SDL_INIT_VIDEO);
+        auto logger = LogManager::getInstance().getLogger();
+        if (status != 0) {
             logger->error(std::format("Failed to initialize SDL: {}", SDL_GetError()));
             throw std::runtime_error(std::format("Failed to initialize SDL: {}", SDL_GetError()));
             return false;
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace TriHarder {
+
+    //! @class SpscQueue
+    //! @brief A bounded lock-free queue for exactly one producer and one consumer thread.
+    //!
+    //! Storage is allocated once in the constructor, so push and pop never allocate and
+    //! are safe to use from real-time threads such as the audio callback. The head and
+    //! tail counters live on separate cache lines to avoid false sharing between the
+    //! two threads.
+    //!
+    //! @tparam T A trivially copyable element type.
+    template<typename T>
+    class SpscQueue {
+        static_assert(std::is_trivially_copyable_v<T>, "SpscQueue elements are copied with plain assignment");
+
+    public:
+        //! @param capacity Minimum number of elements, rounded up to a power of two.
+        explicit SpscQueue(size_t capacity)
+            : buffer_(std::bit_ceil(std::max<size_t>(capacity, 2))), mask_(buffer_.size() - 1) {}
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        //! Producer only. @return False if the queue is full.
+        bool push(const T& item) {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) == buffer_.size()) {
+                return false;
+            }
+            buffer_[tail & mask_] = item;
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Consumer only. @return False if the queue is empty.
+        bool pop(T& item) {
+            size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = buffer_[head & mask_];
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Producer only. Appends as many items as fit.
+        //! @return Number of items written.
+        size_t pushBulk(const T* items, size_t count) {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            count = std::min(count, buffer_.size() - (tail - head_.load(std::memory_order_acquire)));
+            copyIn(tail, items, count);
+            tail_.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+        //! Consumer only. Removes up to count items.
+        //! @return Number of items read.
+        size_t popBulk(T* items, size_t count) {
+            size_t head = head_.load(std::memory_order_relaxed);
+            count = std::min(count, tail_.load(std::memory_order_acquire) - head);
+            copyOut(head, items, count);
+            head_.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        //! Approximate number of queued items; exact when called by the consumer or the producer
+        //! while the other side is idle.
+        [[nodiscard]] size_t size() const {
+            return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] size_t capacity() const { return buffer_.size(); }
+
+    private:
+        void copyIn(size_t position, const T* items, size_t count) {
+            size_t first = std::min(count, buffer_.size() - (position & mask_));
+            std::copy_n(items, first, buffer_.data() + (position & mask_));
+            std::copy_n(items + first, count - first, buffer_.data());
+        }
+
+        void copyOut(size_t position, T* items, size_t count) const {
+            size_t first = std::min(count, buffer_.size() - (position & mask_));
+            std::copy_n(buffer_.data() + (position & mask_), first, items);
+            std::copy_n(buffer_.data(), count - first, items + first);
+        }
+
+        static constexpr size_t CacheLineSize = 64;
+
+        std::vector<T> buffer_;
+        size_t mask_;
+        alignas(CacheLineSize) std::atomic<size_t> head_ = 0;
+        alignas(CacheLineSize) std::atomic<size_t> tail_ = 0;
+    };
+}
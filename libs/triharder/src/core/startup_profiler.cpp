@@ -0,0 +1,64 @@
+#include "startup_profiler.h"
+#include "logging.h"
+#include <algorithm>
+
+namespace TriHarder {
+
+    static double toMilliseconds(std::chrono::nanoseconds duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    StartupProfiler& StartupProfiler::getInstance() {
+        static StartupProfiler instance;
+        return instance;
+    }
+
+    void StartupProfiler::record(String name, Clock::time_point start, Clock::time_point end) {
+        std::lock_guard lock(mutex_);
+        phases_.push_back({std::move(name), start - origin_, end - start, std::this_thread::get_id()});
+    }
+
+    void StartupProfiler::markFirstFrame() {
+        std::lock_guard lock(mutex_);
+        if (!hasFirstFrame_) {
+            firstFrame_ = Clock::now();
+            hasFirstFrame_ = true;
+        }
+    }
+
+    bool StartupProfiler::hasFirstFrame() const {
+        std::lock_guard lock(mutex_);
+        return hasFirstFrame_;
+    }
+
+    std::chrono::nanoseconds StartupProfiler::getTimeToFirstFrame() const {
+        std::lock_guard lock(mutex_);
+        return hasFirstFrame_ ? firstFrame_ - origin_ : std::chrono::nanoseconds::zero();
+    }
+
+    std::vector<StartupPhaseRecord> StartupProfiler::getPhases() const {
+        std::vector<StartupPhaseRecord> phases;
+        {
+            std::lock_guard lock(mutex_);
+            phases = phases_;
+        }
+        std::sort(phases.begin(), phases.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.Start < rhs.Start;
+        });
+        return phases;
+    }
+
+    void StartupProfiler::report() const {
+        auto logger = LogManager::getInstance().getLogger();
+        auto mainThread = std::this_thread::get_id();
+        for (const auto& phase : getPhases()) {
+            logger->info(std::format("Startup phase {:<20} start: {:8.2f} ms, duration: {:8.2f} ms{}",
+                                     phase.Name, toMilliseconds(phase.Start), toMilliseconds(phase.Duration),
+                                     phase.ThreadId == mainThread ? "" : " (background)"));
+        }
+
+        if (hasFirstFrame()) {
+            logger->info(std::format("Time to first frame: {:.2f} ms", toMilliseconds(getTimeToFirstFrame())));
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../triharder.h"
+
+namespace TriHarder {
+
+    //! @struct StartupPhaseRecord
+    //! @brief A single timed phase of the application startup.
+    struct StartupPhaseRecord {
+        String Name;                        //!< Name of the phase, e.g. "window.create".
+        std::chrono::nanoseconds Start;     //!< Start time relative to the profiler origin.
+        std::chrono::nanoseconds Duration;  //!< Wall clock duration of the phase.
+        std::thread::id ThreadId;           //!< Thread the phase ran on.
+    };
+
+    //! @class StartupProfiler
+    //! @brief Collects timings of the startup phases and the time to the first presented frame.
+    //!
+    //! The profiler origin is taken when the instance is first accessed, so the
+    //! executable should touch it as early as possible in main(). Phases may be
+    //! recorded from any thread.
+    class StartupProfiler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static StartupProfiler& getInstance();
+
+        //! Records a finished phase.
+        void record(String name, Clock::time_point start, Clock::time_point end);
+
+        //! Marks the first presented frame. Only the first call has an effect.
+        void markFirstFrame();
+
+        //! @return True once markFirstFrame() has been called.
+        [[nodiscard]] bool hasFirstFrame() const;
+
+        //! @return Time from the profiler origin to the first presented frame.
+        [[nodiscard]] std::chrono::nanoseconds getTimeToFirstFrame() const;
+
+        //! @return A copy of all recorded phases ordered by start time.
+        [[nodiscard]] std::vector<StartupPhaseRecord> getPhases() const;
+
+        //! Logs all phases and the time to first frame through the default logger.
+        void report() const;
+
+    private:
+        StartupProfiler() : origin_(Clock::now()) {}
+
+        Clock::time_point origin_;
+        Clock::time_point firstFrame_;
+        bool hasFirstFrame_ = false;
+        std::vector<StartupPhaseRecord> phases_;
+        mutable std::mutex mutex_;
+    };
+
+    //! @class StartupPhase
+    //! @brief RAII helper that records the lifetime of a scope as a startup phase.
+    class StartupPhase {
+    public:
+        explicit StartupPhase(String name)
+            : name_(std::move(name)), start_(StartupProfiler::Clock::now()) {}
+
+        ~StartupPhase() {
+            stop();
+        }
+
+        StartupPhase(const StartupPhase&) = delete;
+        StartupPhase& operator=(const StartupPhase&) = delete;
+
+        //! Ends the phase before the end of the scope.
+        void stop() {
+            if (!stopped_) {
+                stopped_ = true;
+                StartupProfiler::getInstance().record(std::move(name_), start_, StartupProfiler::Clock::now());
+            }
+        }
+
+    private:
+        String name_;
+        StartupProfiler::Clock::time_point start_;
+        bool stopped_ = false;
+    };
+}
@@ -0,0 +1,68 @@
+#include "string_id.h"
+#include "logging.h"
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace TriHarder {
+
+    //! Thread-safe storage of interned strings. Strings live in a deque so views stay valid.
+    class StringIdTable {
+    public:
+        static StringIdTable& getInstance() {
+            static StringIdTable instance;
+            return instance;
+        }
+
+        //! @return The previously interned string if a different string has the same hash.
+        std::optional<String> insert(uint64_t hash, std::string_view text) {
+            {
+                std::shared_lock lock(mutex_);
+                auto it = strings_.find(hash);
+                if (it != strings_.end()) {
+                    return checkCollision(it->second, text);
+                }
+            }
+
+            std::unique_lock lock(mutex_);
+            auto [it, inserted] = strings_.try_emplace(hash);
+            if (!inserted) {
+                return checkCollision(it->second, text);
+            }
+            storage_.emplace_back(text);
+            it->second = storage_.back();
+            return std::nullopt;
+        }
+
+        std::string_view find(uint64_t hash) const {
+            std::shared_lock lock(mutex_);
+            auto it = strings_.find(hash);
+            return it != strings_.end() ? it->second : std::string_view("<unknown>");
+        }
+
+    private:
+        std::unordered_map<uint64_t, std::string_view> strings_;
+        std::deque<String> storage_;
+        mutable std::shared_mutex mutex_;
+
+        static std::optional<String> checkCollision(std::string_view existing, std::string_view text) {
+            return existing != text ? std::optional<String>(existing) : std::nullopt;
+        }
+    };
+
+    StringId StringId::intern(std::string_view text) {
+        auto id = hash(text);
+        auto collision = StringIdTable::getInstance().insert(id.getHash(), text);
+        if (collision) {
+            // Logged outside of the table lock, the logger interns its own names
+            auto logger = LogManager::getInstance().getLogger();
+            logger->error(std::format("StringId collision between '{}' and '{}'", *collision, text));
+        }
+        return id;
+    }
+
+    std::string_view StringId::getString() const {
+        return StringIdTable::getInstance().find(m_hash);
+    }
+}
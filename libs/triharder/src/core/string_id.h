@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <compare>
+#include <string_view>
+#include "../triharder.h"
+
+namespace TriHarder {
+
+    //! @function fnv1a64
+    //! @brief 64-bit FNV-1a hash usable in constant expressions.
+    //! @param text The characters to hash.
+    //! @return The hash value.
+    constexpr uint64_t fnv1a64(std::string_view text) {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (char c : text) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    //! @class StringId
+    //! @brief A hashed identifier for names used in hot paths (loggers, uniforms, assets, events).
+    //!
+    //! Comparing two StringIds is a single integer compare. Literals are hashed at compile
+    //! time through the consteval constructor or the _sid suffix. Runtime strings are hashed
+    //! with intern(), which also records the string for reverse lookup through getString().
+    //! The hash value 0 is reserved for the invalid id.
+    class StringId {
+    public:
+        constexpr StringId() = default;
+
+        //! Hashes a string literal at compile time.
+        template<size_t N>
+        consteval StringId(const char (&literal)[N]) : m_hash(makeHash(std::string_view(literal, N - 1))) {}
+
+        //! Hashes a runtime string and records it in the intern table.
+        static StringId intern(std::string_view text);
+
+        //! Hashes a runtime string without recording it. Cheaper than intern() for lookups.
+        static constexpr StringId hash(std::string_view text) {
+            return fromHash(makeHash(text));
+        }
+
+        //! Recreates an id from a previously obtained hash value.
+        static constexpr StringId fromHash(uint64_t hash) {
+            StringId id;
+            id.m_hash = hash;
+            return id;
+        }
+
+        [[nodiscard]] constexpr uint64_t getHash() const { return m_hash; }
+        [[nodiscard]] constexpr bool isValid() const { return m_hash != 0; }
+
+        //! Reverse lookup for debugging and logging.
+        //! @return The interned string, or "<unknown>" for ids that were never interned.
+        [[nodiscard]] std::string_view getString() const;
+
+        constexpr bool operator==(const StringId&) const = default;
+        constexpr auto operator<=>(const StringId&) const = default;
+
+    private:
+        uint64_t m_hash = 0;
+
+        static constexpr uint64_t makeHash(std::string_view text) {
+            uint64_t hash = fnv1a64(text);
+            return hash != 0 ? hash : 1;
+        }
+    };
+
+    inline namespace Literals {
+        //! Creates a compile-time StringId: "player"_sid
+        consteval StringId operator""_sid(const char* text, size_t length) {
+            return StringId::hash(std::string_view(text, length));
+        }
+    }
+}
+
+template<>
+struct std::hash<TriHarder::StringId> {
+    size_t operator()(const TriHarder::StringId& id) const noexcept {
+        return static_cast<size_t>(id.getHash());
+    }
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <utility>
+#include <vector>
+#include "string_id.h"
+
+namespace TriHarder {
+
+    //! @class StringIdMap
+    //! @brief Open addressing hash map keyed by StringId.
+    //!
+    //! Keys are already well mixed 64-bit hashes, so the slot index is taken directly
+    //! from the low bits. Collisions are resolved by linear probing and erase uses
+    //! backward shift deletion, so lookups never have to skip tombstones. The capacity
+    //! is always a power of two and the load factor stays below 7/8.
+    //!
+    //! @tparam V The mapped type, must be default constructible and movable.
+    template<typename V>
+    class StringIdMap {
+    public:
+        StringIdMap() = default;
+
+        explicit StringIdMap(size_t capacity) {
+            reserve(capacity);
+        }
+
+        //! @return A pointer to the value, or nullptr if the key is not present.
+        [[nodiscard]] V* find(StringId key) {
+            size_t slot = findSlot(key.getHash());
+            return slot != NotFound ? &slots_[slot].Value : nullptr;
+        }
+
+        [[nodiscard]] const V* find(StringId key) const {
+            size_t slot = findSlot(key.getHash());
+            return slot != NotFound ? &slots_[slot].Value : nullptr;
+        }
+
+        [[nodiscard]] bool contains(StringId key) const {
+            return findSlot(key.getHash()) != NotFound;
+        }
+
+        //! Inserts or replaces the value of a key.
+        //! @return A reference to the stored value.
+        V& insertOrAssign(StringId key, V value) {
+            V& slot = (*this)[key];
+            slot = std::move(value);
+            return slot;
+        }
+
+        //! @return The value of the key, default constructing it if it does not exist.
+        V& operator[](StringId key) {
+            assert(key.isValid() && "StringIdMap does not accept the invalid StringId");
+            if ((size_ + 1) * 8 > slots_.size() * 7) {
+                grow();
+            }
+
+            uint64_t hash = key.getHash();
+            size_t mask = slots_.size() - 1;
+            for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+                if (slots_[slot].Key == hash) {
+                    return slots_[slot].Value;
+                }
+                if (slots_[slot].Key == EmptyKey) {
+                    slots_[slot].Key = hash;
+                    size_++;
+                    return slots_[slot].Value;
+                }
+            }
+        }
+
+        //! Removes a key.
+        //! @return True if the key was present.
+        bool erase(StringId key) {
+            size_t slot = findSlot(key.getHash());
+            if (slot == NotFound) {
+                return false;
+            }
+
+            // Backward shift: move following entries of the probe chain into the hole
+            size_t mask = slots_.size() - 1;
+            size_t hole = slot;
+            for (size_t next = (hole + 1) & mask; slots_[next].Key != EmptyKey; next = (next + 1) & mask) {
+                size_t home = slots_[next].Key & mask;
+                if (((next - home) & mask) >= ((next - hole) & mask)) {
+                    slots_[hole] = std::move(slots_[next]);
+                    hole = next;
+                }
+            }
+            slots_[hole] = Slot();
+            size_--;
+            return true;
+        }
+
+        void clear() {
+            for (auto& slot : slots_) {
+                slot = Slot();
+            }
+            size_ = 0;
+        }
+
+        //! Makes room for at least the given number of entries without rehashing.
+        void reserve(size_t count) {
+            size_t required = std::bit_ceil(std::max<size_t>(8, count * 8 / 7 + 1));
+            if (required > slots_.size()) {
+                rehash(required);
+            }
+        }
+
+        [[nodiscard]] size_t size() const { return size_; }
+        [[nodiscard]] bool empty() const { return size_ == 0; }
+        [[nodiscard]] size_t capacity() const { return slots_.size(); }
+
+        //! Calls function(StringId, V&) for every entry.
+        template<typename F>
+        void forEach(F&& function) {
+            for (auto& slot : slots_) {
+                if (slot.Key != EmptyKey) {
+                    function(StringId::fromHash(slot.Key), slot.Value);
+                }
+            }
+        }
+
+    private:
+        struct Slot {
+            uint64_t Key = 0;
+            V Value{};
+        };
+
+        static constexpr uint64_t EmptyKey = 0;
+        static constexpr size_t NotFound = ~size_t(0);
+
+        std::vector<Slot> slots_;
+        size_t size_ = 0;
+
+        [[nodiscard]] size_t findSlot(uint64_t hash) const {
+            if (slots_.empty() || hash == EmptyKey) {
+                return NotFound;
+            }
+
+            size_t mask = slots_.size() - 1;
+            for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+                if (slots_[slot].Key == hash) {
+                    return slot;
+                }
+                if (slots_[slot].Key == EmptyKey) {
+                    return NotFound;
+                }
+            }
+        }
+
+        void grow() {
+            rehash(slots_.empty() ? 8 : slots_.size() * 2);
+        }
+
+        void rehash(size_t capacity) {
+            std::vector<Slot> previous(capacity);
+            previous.swap(slots_);
+
+            size_t mask = capacity - 1;
+            for (auto& entry : previous) {
+                if (entry.Key == EmptyKey) {
+                    continue;
+                }
+                size_t slot = entry.Key & mask;
+                while (slots_[slot].Key != EmptyKey) {
+                    slot = (slot + 1) & mask;
+                }
+                slots_[slot] = std::move(entry);
+            }
+        }
+    };
+}
@@ -0,0 +1,80 @@
+#include "task.h"
+#include "logging.h"
+
+namespace TriHarder {
+
+    TaskScheduler::TaskScheduler() : wakeQueue_(createSharedPtr<TaskWakeQueue>()) {}
+
+    TaskScheduler::~TaskScheduler() {
+        {
+            std::lock_guard lock(wakeQueue_->Mutex);
+            wakeQueue_->Closed = true;
+            wakeQueue_->Handles.clear();
+        }
+
+        // Destroying a root also destroys the child tasks it is awaiting
+        for (auto& root : roots_) {
+            root.Handle.destroy();
+        }
+    }
+
+    void TaskScheduler::beginFrame(double deltaTime) {
+        time_ += deltaTime;
+        resumedThisFrame_ = 0;
+        runPhase(TaskPhase::FrameStart);
+    }
+
+    void TaskScheduler::runPhase(TaskPhase phase) {
+        // Swapping the queue out first makes tasks that wait again resume in the next frame
+        running_.clear();
+        running_.swap(phases_[static_cast<size_t>(phase)]);
+
+        if (phase == TaskPhase::FrameStart) {
+            {
+                std::lock_guard lock(wakeQueue_->Mutex);
+                running_.insert(running_.end(), wakeQueue_->Handles.begin(), wakeQueue_->Handles.end());
+                wakeQueue_->Handles.clear();
+            }
+            while (!timers_.empty() && timers_.top().Time <= time_) {
+                running_.push_back(timers_.top().Handle);
+                timers_.pop();
+            }
+        }
+        resumeAll(running_);
+    }
+
+    void TaskScheduler::resumeAll(std::vector<std::coroutine_handle<>>& handles) {
+        resumedThisFrame_ += handles.size();
+        for (auto handle : handles) {
+            handle.resume();
+        }
+        handles.clear();
+    }
+
+    void TaskScheduler::schedule(std::coroutine_handle<> handle, TaskPhase phase) {
+        phases_[static_cast<size_t>(phase)].push_back(handle);
+    }
+
+    void TaskScheduler::scheduleAt(std::coroutine_handle<> handle, double time) {
+        timers_.push({time, timerSequence_++, handle});
+    }
+
+    void TaskScheduler::completeRoot(std::coroutine_handle<> handle, TaskPromiseBase& promise) {
+        auto index = promise.RootIndex;
+        roots_[index] = roots_.back();
+        roots_[index].Promise->RootIndex = index;
+        roots_.pop_back();
+
+        if (promise.Exception) {
+            auto logger = LogManager::getInstance().getLogger();
+            try {
+                std::rethrow_exception(promise.Exception);
+            } catch (const std::exception& exception) {
+                logger->error(std::format("Task terminated by exception: {}", exception.what()));
+            } catch (...) {
+                logger->error("Task terminated by an unknown exception");
+            }
+        }
+        handle.destroy();
+    }
+}
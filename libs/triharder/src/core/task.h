@@ -0,0 +1,479 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "job_system.h"
+#include "result.h"
+#include "task_frame_pool.h"
+#include "../triharder.h"
+
+namespace TriHarder {
+
+    class TaskScheduler;
+
+    //! Points of the frame loop at which the TaskScheduler resumes waiting tasks.
+    enum class TaskPhase : uint8_t {
+        FrameStart, //!< After input was polled, before the simulation. Timers, jobs and values complete here.
+        PreRender, //!< After the simulation, before drawing.
+        FrameEnd, //!< After the frame was presented.
+    };
+
+    //! @struct TaskWakeQueue
+    //! @brief Collects tasks completed on other threads until the next FrameStart.
+    //!
+    //! Shared between the scheduler and pending jobs or values, so a completion that
+    //! arrives after the scheduler was destroyed is dropped instead of touching freed memory.
+    struct TaskWakeQueue {
+        std::mutex Mutex;
+        std::vector<std::coroutine_handle<>> Handles;
+        bool Closed = false;
+
+        void post(std::coroutine_handle<> handle) {
+            std::lock_guard lock(Mutex);
+            if (!Closed) {
+                Handles.push_back(handle);
+            }
+        }
+    };
+
+    //! @struct TaskPromiseBase
+    //! @brief State shared by the promises of all Task types.
+    struct TaskPromiseBase {
+        static constexpr uint32_t NotRoot = UINT32_MAX;
+
+        TaskScheduler* Scheduler = nullptr;
+        std::coroutine_handle<> Continuation;
+        std::exception_ptr Exception;
+        uint32_t RootIndex = NotRoot; //!< Position in the scheduler's root list for spawned tasks.
+
+        static void* operator new(size_t size) { return TaskFramePool::allocate(size); }
+        static void operator delete(void* frame, size_t size) noexcept { TaskFramePool::deallocate(frame, size); }
+
+        void unhandled_exception() noexcept { Exception = std::current_exception(); }
+    };
+
+    template<typename Promise>
+    concept TaskPromise = std::is_base_of_v<TaskPromiseBase, Promise>;
+
+    //! @class TaskScheduler
+    //! @brief Resumes suspended tasks at fixed points of the frame loop.
+    //!
+    //! Waiting tasks are not polled: tasks waiting for the next frame sit in a queue per
+    //! phase, timers in a heap ordered by wake time, and tasks waiting for jobs or values
+    //! are posted back by the completing thread. An idle task therefore costs nothing
+    //! per frame beyond its pooled frame.
+    //!
+    //! All tasks run on the thread calling beginFrame() and runPhase().
+    class TaskScheduler {
+    public:
+        TaskScheduler();
+
+        //! Destroys every unfinished task.
+        ~TaskScheduler();
+
+        TaskScheduler(const TaskScheduler&) = delete;
+        TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+        //! Starts a task, it runs until its first suspension before spawn() returns.
+        //! The scheduler owns the task from now on; its result is discarded and an
+        //! escaped exception is logged.
+        template<typename TaskType>
+        void spawn(TaskType task) {
+            auto handle = task.release();
+            auto& promise = handle.promise();
+            promise.Scheduler = this;
+            promise.RootIndex = static_cast<uint32_t>(roots_.size());
+            roots_.push_back({handle, &promise});
+            handle.resume();
+        }
+
+        //! Advances the task clock and runs the FrameStart phase.
+        void beginFrame(double deltaTime);
+
+        //! Resumes the tasks waiting for the phase.
+        void runPhase(TaskPhase phase);
+
+        //! @return Seconds accumulated by beginFrame().
+        [[nodiscard]] double getTime() const { return time_; }
+
+        //! @return Number of spawned tasks that have not finished.
+        [[nodiscard]] size_t getTaskCount() const { return roots_.size(); }
+
+        //! @return Number of task resumptions since the start of the last beginFrame().
+        [[nodiscard]] uint64_t getResumedThisFrame() const { return resumedThisFrame_; }
+
+        // Used by the awaitables
+        void schedule(std::coroutine_handle<> handle, TaskPhase phase);
+        void scheduleAt(std::coroutine_handle<> handle, double time);
+        [[nodiscard]] const SharedPtr<TaskWakeQueue>& getWakeQueue() const { return wakeQueue_; }
+        void completeRoot(std::coroutine_handle<> handle, TaskPromiseBase& promise);
+
+    private:
+        struct Root {
+            std::coroutine_handle<> Handle;
+            TaskPromiseBase* Promise;
+        };
+
+        struct Timer {
+            double Time;
+            uint64_t Sequence; //!< Keeps timers with equal wake times in FIFO order.
+            std::coroutine_handle<> Handle;
+
+            bool operator>(const Timer& other) const {
+                return Time != other.Time ? Time > other.Time : Sequence > other.Sequence;
+            }
+        };
+
+        void resumeAll(std::vector<std::coroutine_handle<>>& handles);
+
+        static constexpr size_t PhaseCount = 3;
+
+        std::vector<Root> roots_;
+        std::vector<std::coroutine_handle<>> phases_[PhaseCount];
+        std::vector<std::coroutine_handle<>> running_;
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+        SharedPtr<TaskWakeQueue> wakeQueue_;
+        double time_ = 0.0;
+        uint64_t timerSequence_ = 0;
+        uint64_t resumedThisFrame_ = 0;
+    };
+
+    //! @struct TaskValueReturn
+    //! @brief Completes a Task with a value or a Result through `co_return`.
+    template<typename T, typename E>
+    struct TaskValueReturn {
+        std::optional<Result<T, E>> Value;
+
+        void return_value(Result<T, E> result) { Value.emplace(std::move(result)); }
+        void return_value(T value) { Value.emplace(Result<T, E>::ok(std::move(value))); }
+    };
+
+    //! @struct TaskVoidReturn
+    //! @brief Completes a Task<> through `co_return;` or by reaching the end of its body.
+    //!
+    //! A promise cannot have both return_void and return_value, so errors are reported
+    //! with `co_await failTask(error)` instead of `co_return Result::error(...)`.
+    template<typename E>
+    struct TaskVoidReturn {
+        std::optional<Result<std::monostate, E>> Value;
+
+        void return_void() { Value.emplace(Result<std::monostate, E>::ok({})); }
+        void fail(E error) { Value.emplace(Result<std::monostate, E>::error(std::move(error))); }
+    };
+
+    //! @class Task
+    //! @brief A lazily started coroutine producing a Result.
+    //!
+    //! `co_return` either a value or a Result; a Task<> ends with `co_return;` or its last
+    //! statement and fails with `co_await failTask(error)`. Awaiting a task starts it and
+    //! yields its Result once it has finished. Exceptions escaping the coroutine are
+    //! rethrown in the awaiting task. Top level tasks are handed to TaskScheduler::spawn().
+    //!
+    //! @code
+    //! Task<Texture, SceneError*> loadTexture(String name) {
+    //!     auto pixels = co_await runJob([name]() { return decode(name); });
+    //!     if (pixels.empty()) {
+    //!         co_return Result<Texture, SceneError*>::error(new TextureLoadError(name));
+    //!     }
+    //!     co_await nextFrame();
+    //!     co_return upload(pixels);
+    //! }
+    //! @endcode
+    //!
+    //! @tparam T The value type.
+    //! @tparam E The error type.
+    template<typename T = std::monostate, typename E = String>
+    class [[nodiscard]] Task {
+    public:
+        using ResultType = Result<T, E>;
+
+        struct promise_type : TaskPromiseBase,
+                              std::conditional_t<std::is_same_v<T, std::monostate>,
+                                                 TaskVoidReturn<E>, TaskValueReturn<T, E>> {
+            Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    return complete(handle);
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            FinalAwaiter final_suspend() noexcept { return {}; }
+
+            //! Hands control to the awaiting task, or releases a spawned task. Once Value is set.
+            static std::coroutine_handle<> complete(std::coroutine_handle<promise_type> handle) noexcept {
+                auto& promise = handle.promise();
+                if (promise.Continuation) {
+                    return promise.Continuation;
+                }
+                if (promise.RootIndex != TaskPromiseBase::NotRoot) {
+                    // Destroys the frame, nothing of it may be touched afterwards
+                    promise.Scheduler->completeRoot(handle, promise);
+                }
+                return std::noop_coroutine();
+            }
+        };
+
+        Task() = default;
+        Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                destroy();
+                handle_ = std::exchange(other.handle_, {});
+            }
+            return *this;
+        }
+
+        ~Task() { destroy(); }
+
+        [[nodiscard]] bool isValid() const { return static_cast<bool>(handle_); }
+        //! A task that failed with failTask() has finished without reaching its end.
+        [[nodiscard]] bool isDone() const { return handle_ && (handle_.done() || handle_.promise().Value); }
+
+        //! Gives up ownership of the coroutine, used by TaskScheduler::spawn().
+        std::coroutine_handle<promise_type> release() { return std::exchange(handle_, {}); }
+
+        struct Awaiter {
+            std::coroutine_handle<promise_type> Handle;
+
+            bool await_ready() const noexcept { return Handle.done(); }
+
+            template<TaskPromise Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) noexcept {
+                Handle.promise().Scheduler = awaiting.promise().Scheduler;
+                Handle.promise().Continuation = awaiting;
+                return Handle;
+            }
+
+            ResultType await_resume() {
+                auto& promise = Handle.promise();
+                if (promise.Exception) {
+                    std::rethrow_exception(promise.Exception);
+                }
+                return std::move(*promise.Value);
+            }
+        };
+
+        Awaiter operator co_await() && noexcept { return Awaiter{handle_}; }
+        Awaiter operator co_await() & noexcept { return Awaiter{handle_}; }
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+        void destroy() {
+            if (handle_) {
+                handle_.destroy();
+                handle_ = {};
+            }
+        }
+
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    //! @struct TaskFailAwaiter
+    //! @brief Finishes a Task<> with an error, the awaiting task resumes with it.
+    template<typename E>
+    struct TaskFailAwaiter {
+        E Error;
+
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) {
+            handle.promise().fail(std::move(Error));
+            // The frame stays suspended here and is destroyed by its owner
+            return Promise::complete(handle);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    //! Ends a Task<> with an error, the counterpart of `co_return Result::error(...)` of valued tasks.
+    template<typename E>
+    TaskFailAwaiter<E> failTask(E error) { return TaskFailAwaiter<E>{std::move(error)}; }
+
+    //! @struct PhaseAwaiter
+    //! @brief Suspends until the frame loop next reaches a phase.
+    struct PhaseAwaiter {
+        TaskPhase Phase;
+
+        bool await_ready() const noexcept { return false; }
+
+        template<TaskPromise Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) const {
+            handle.promise().Scheduler->schedule(handle, Phase);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    //! Resumes at the start of the next frame.
+    inline PhaseAwaiter nextFrame() { return PhaseAwaiter{TaskPhase::FrameStart}; }
+
+    //! Resumes the next time the frame loop reaches the phase, which may be later in the current frame.
+    inline PhaseAwaiter waitForPhase(TaskPhase phase) { return PhaseAwaiter{phase}; }
+
+    //! @struct DelayAwaiter
+    //! @brief Suspends until the scheduler clock has advanced by a duration.
+    struct DelayAwaiter {
+        double Seconds;
+
+        bool await_ready() const noexcept { return Seconds <= 0.0; }
+
+        template<TaskPromise Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) const {
+            auto* scheduler = handle.promise().Scheduler;
+            scheduler->scheduleAt(handle, scheduler->getTime() + Seconds);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    //! Resumes at the first FrameStart at which the given time has passed on the scheduler clock.
+    inline DelayAwaiter waitSeconds(double seconds) { return DelayAwaiter{seconds}; }
+
+    //! @class AsyncValue
+    //! @brief A value produced once by any thread and awaited by tasks, e.g. a loading asset.
+    //!
+    //! Share it through a SharedPtr between the producer and waitUntilReady().
+    template<typename T, typename E = String>
+    class AsyncValue {
+    public:
+        //! Stores the result and wakes all waiting tasks. Later calls are ignored.
+        void set(Result<T, E> result) {
+            std::vector<Waiter> waiters;
+            {
+                std::lock_guard lock(mutex_);
+                if (value_) {
+                    return;
+                }
+                value_.emplace(std::move(result));
+                waiters.swap(waiters_);
+                ready_.store(true, std::memory_order_release);
+            }
+            for (auto& waiter : waiters) {
+                waiter.Queue->post(waiter.Handle);
+            }
+        }
+
+        [[nodiscard]] bool isReady() const { return ready_.load(std::memory_order_acquire); }
+
+        //! @return The stored result. Only valid once isReady() returned true.
+        [[nodiscard]] const Result<T, E>& get() const { return *value_; }
+
+        //! Registers a task to be woken by set().
+        //! @return False if the value is already set and the task should not suspend.
+        bool addWaiter(std::coroutine_handle<> handle, SharedPtr<TaskWakeQueue> queue) {
+            std::lock_guard lock(mutex_);
+            if (value_) {
+                return false;
+            }
+            waiters_.push_back({handle, std::move(queue)});
+            return true;
+        }
+
+    private:
+        struct Waiter {
+            std::coroutine_handle<> Handle;
+            SharedPtr<TaskWakeQueue> Queue;
+        };
+
+        std::mutex mutex_;
+        std::optional<Result<T, E>> value_;
+        std::vector<Waiter> waiters_;
+        std::atomic<bool> ready_ = false;
+    };
+
+    //! @struct AsyncValueAwaiter
+    //! @brief Suspends until an AsyncValue has been set and yields its result.
+    template<typename T, typename E>
+    struct AsyncValueAwaiter {
+        SharedPtr<AsyncValue<T, E>> Value; //!< Keeps the value alive while the task waits.
+
+        bool await_ready() const { return Value->isReady(); }
+
+        template<TaskPromise Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) {
+            return Value->addWaiter(handle, handle.promise().Scheduler->getWakeQueue());
+        }
+
+        Result<T, E> await_resume() const { return Value->get(); }
+    };
+
+    //! Resumes at the first FrameStart after the value was set, or immediately if it already is.
+    template<typename T, typename E>
+    AsyncValueAwaiter<T, E> waitUntilReady(SharedPtr<AsyncValue<T, E>> value) {
+        return AsyncValueAwaiter<T, E>{std::move(value)};
+    }
+
+    //! @struct JobAwaiter
+    //! @brief Runs a function on the JobSystem and yields its return value.
+    template<typename F>
+    struct JobAwaiter {
+        using ReturnType = std::invoke_result_t<F&>;
+        using ValueType = std::conditional_t<std::is_void_v<ReturnType>, std::monostate, ReturnType>;
+
+        //! Outlives the awaiting frame if the scheduler is destroyed while the job runs.
+        struct State {
+            std::optional<ValueType> Value;
+            std::exception_ptr Exception;
+        };
+
+        F Function;
+        SharedPtr<State> Shared;
+
+        bool await_ready() const noexcept { return false; }
+
+        template<TaskPromise Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) {
+            Shared = createSharedPtr<State>();
+            auto job = [state = Shared, queue = handle.promise().Scheduler->getWakeQueue(),
+                        function = std::move(Function), handle]() mutable {
+                try {
+                    if constexpr (std::is_void_v<ReturnType>) {
+                        function();
+                        state->Value.emplace();
+                    } else {
+                        state->Value.emplace(function());
+                    }
+                } catch (...) {
+                    state->Exception = std::current_exception();
+                }
+                queue->post(handle);
+            };
+            // Completion is reported through the wake queue, the future is not needed
+            (void)JobSystem::getInstance().submit(std::move(job));
+        }
+
+        ReturnType await_resume() {
+            if (Shared->Exception) {
+                std::rethrow_exception(Shared->Exception);
+            }
+            if constexpr (!std::is_void_v<ReturnType>) {
+                return std::move(*Shared->Value);
+            }
+        }
+    };
+
+    //! Runs the function as a job and resumes at the first FrameStart after it completed.
+    //! Exceptions thrown by the function are rethrown in the task.
+    template<typename F>
+    JobAwaiter<std::decay_t<F>> runJob(F&& function) {
+        return JobAwaiter<std::decay_t<F>>{std::forward<F>(function), nullptr};
+    }
+}
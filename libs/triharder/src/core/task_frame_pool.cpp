@@ -0,0 +1,90 @@
+#include "task_frame_pool.h"
+#include "memory_tracker.h"
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace TriHarder {
+
+    namespace {
+        constexpr size_t SizeClassCount = TaskFramePool::MaxPooledSize / TaskFramePool::Granularity;
+
+        struct FreeFrame {
+            FreeFrame* Next;
+        };
+
+        struct PoolState {
+            std::mutex Mutex;
+            FreeFrame* FreeLists[SizeClassCount] = {};
+            std::vector<std::unique_ptr<std::byte[]>> Slabs;
+            std::byte* Cursor = nullptr;
+            size_t Remaining = 0;
+            TaskFramePoolStats Stats;
+        };
+
+        PoolState& getState() {
+            static PoolState state;
+            return state;
+        }
+
+        size_t getSizeClass(size_t size) {
+            return (size + TaskFramePool::Granularity - 1) / TaskFramePool::Granularity - 1;
+        }
+    }
+
+    void* TaskFramePool::allocate(size_t size) {
+        auto& state = getState();
+        if (size > MaxPooledSize) {
+            std::lock_guard lock(state.Mutex);
+            ++state.Stats.LiveFrames;
+            ++state.Stats.LargeAllocations;
+            MemoryTagScope scope(MemoryTag::Tasks);
+            return ::operator new(size);
+        }
+
+        size_t sizeClass = getSizeClass(size);
+        std::lock_guard lock(state.Mutex);
+        ++state.Stats.LiveFrames;
+        ++state.Stats.PooledAllocations;
+        if (auto* frame = state.FreeLists[sizeClass]) {
+            state.FreeLists[sizeClass] = frame->Next;
+            return frame;
+        }
+
+        size_t blockSize = (sizeClass + 1) * Granularity;
+        if (state.Remaining < blockSize) {
+            // The tail of the previous slab is abandoned, at most one frame per slab
+            MemoryTagScope scope(MemoryTag::Tasks);
+            state.Slabs.push_back(std::make_unique<std::byte[]>(SlabSize));
+            state.Cursor = state.Slabs.back().get();
+            state.Remaining = SlabSize;
+            state.Stats.SlabBytes += SlabSize;
+        }
+        void* frame = state.Cursor;
+        state.Cursor += blockSize;
+        state.Remaining -= blockSize;
+        return frame;
+    }
+
+    void TaskFramePool::deallocate(void* frame, size_t size) noexcept {
+        auto& state = getState();
+        std::lock_guard lock(state.Mutex);
+        --state.Stats.LiveFrames;
+        if (size > MaxPooledSize) {
+            ::operator delete(frame, size);
+            return;
+        }
+
+        size_t sizeClass = getSizeClass(size);
+        auto* free = static_cast<FreeFrame*>(frame);
+        free->Next = state.FreeLists[sizeClass];
+        state.FreeLists[sizeClass] = free;
+    }
+
+    TaskFramePoolStats TaskFramePool::getStats() {
+        auto& state = getState();
+        std::lock_guard lock(state.Mutex);
+        return state.Stats;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace TriHarder {
+
+    //! @struct TaskFramePoolStats
+    //! @brief Usage of the coroutine frame pool.
+    struct TaskFramePoolStats {
+        uint64_t LiveFrames = 0; //!< Frames currently allocated, pooled or not.
+        uint64_t PooledAllocations = 0; //!< Total allocations served from the pool.
+        uint64_t LargeAllocations = 0; //!< Total allocations too large for the pool.
+        uint64_t SlabBytes = 0; //!< Memory reserved by the pool.
+    };
+
+    //! @class TaskFramePool
+    //! @brief Recycles coroutine frames of Task in size classes.
+    //!
+    //! Frames are carved from large slabs and returned to a free list of their size
+    //! class, so spawning a task in the steady state does not reach the system
+    //! allocator. Frames above MaxPooledSize fall back to operator new. The free lists
+    //! are shared by all threads behind one lock; tasks are normally created on the
+    //! game thread, so it is uncontended.
+    class TaskFramePool {
+    public:
+        static void* allocate(size_t size);
+        static void deallocate(void* frame, size_t size) noexcept;
+
+        [[nodiscard]] static TaskFramePoolStats getStats();
+
+        static constexpr size_t Granularity = 64;
+        static constexpr size_t MaxPooledSize = 2048;
+        static constexpr size_t SlabSize = 64 * 1024;
+    };
+}
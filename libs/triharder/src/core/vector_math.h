@@ -0,0 +1,15 @@
+#pragma once
+
+namespace TriHarder {
+
+    //! @struct Float3
+    //! @brief A plain three component vector.
+    struct Float3 {
+        float X = 0.0f;
+        float Y = 0.0f;
+        float Z = 0.0f;
+
+        [[nodiscard]] float operator[](int axis) const { return axis == 0 ? X : axis == 1 ? Y : Z; }
+        [[nodiscard]] float& operator[](int axis) { return axis == 0 ? X : axis == 1 ? Y : Z; }
+    };
+}
@@ -1,10 +1,51 @@
 #include "window.h"
 #include "logging.h"
+#include "memory_tracker.h"
 #include "sdl_context.h"
+#include "startup_profiler.h"
 #include <glad/glad.h>
 
 namespace TriHarder {
+
+    static int toSdlProfile(GLProfile profile) {
+        switch (profile) {
+            case GLProfile::Compatibility:
+                return SDL_GL_CONTEXT_PROFILE_COMPATIBILITY;
+            case GLProfile::ES:
+                return SDL_GL_CONTEXT_PROFILE_ES;
+            case GLProfile::Core:
+            default:
+                return SDL_GL_CONTEXT_PROFILE_CORE;
+        }
+    }
+
+    static Uint32 toSdlFullscreenFlags(WindowMode mode) {
+        switch (mode) {
+            case WindowMode::Fullscreen:
+                return SDL_WINDOW_FULLSCREEN;
+            case WindowMode::Borderless:
+                return SDL_WINDOW_FULLSCREEN_DESKTOP;
+            case WindowMode::Windowed:
+            default:
+                return 0;
+        }
+    }
+
+    const char* toString(SwapInterval interval) {
+        switch (interval) {
+            case SwapInterval::Adaptive:
+                return "Adaptive";
+            case SwapInterval::Immediate:
+                return "Immediate";
+            case SwapInterval::VSync:
+                return "VSync";
+            default:
+                return "Unknown";
+        }
+    }
+
     UniquePtr<Window> Window::create(const WindowDescriptor &descriptor) {
+        MemoryTagScope scope(MemoryTag::Rendering);
         auto window = new Window();
         window->initialize(descriptor);
         return UniquePtr<Window>(window);
@@ -15,35 +56,80 @@ namespace TriHarder {
         m_width = descriptor.Width;
         m_height = descriptor.Height;
 
-        SdlContext::getInstance().initialize();
+        auto& sdlContext = SdlContext::getInstance();
+        if (!sdlContext.isInitialized()) {
+            StartupPhase phase("sdl.init");
+            sdlContext.initialize();
+        }
+
+        int contextFlags = 0;
+        if (descriptor.DebugContext) {
+            contextFlags |= SDL_GL_CONTEXT_DEBUG_FLAG;
+        }
+        if (descriptor.Profile == GLProfile::Core) {
+            contextFlags |= SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG;
+        }
 
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, descriptor.ContextMajorVersion);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, descriptor.ContextMinorVersion);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, toSdlProfile(descriptor.Profile));
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, contextFlags);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_NO_ERROR, descriptor.NoErrorContext ? 1 : 0);
+        SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+        SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, descriptor.DepthBits);
+        SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, descriptor.StencilBits);
+        SDL_GL_SetAttribute(SDL_GL_FRAMEBUFFER_SRGB_CAPABLE, descriptor.SRGB ? 1 : 0);
+        SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, descriptor.MsaaSamples > 0 ? 1 : 0);
+        SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, descriptor.MsaaSamples);
 
         auto logger = LogManager::getInstance().getLogger();
         logger->info(std::format("Creating window with title: {}, width: {}, height: {}",
                                  m_title, m_width, m_height));
 
+        Uint32 windowFlags = SDL_WINDOW_OPENGL | SDL_WINDOW_ALLOW_HIGHDPI;
+        windowFlags |= descriptor.Hidden ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN;
+        windowFlags |= toSdlFullscreenFlags(descriptor.Mode);
+        if (descriptor.Resizable) {
+            windowFlags |= SDL_WINDOW_RESIZABLE;
+        }
+
+        StartupPhase windowPhase("window.create");
         m_window = SDL_CreateWindow(m_title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                    (int)m_width, (int)m_height, SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN);
+                                    (int)m_width, (int)m_height, windowFlags);
         if (!m_window) {
             logger->error(std::format("Failed to create window: {}", SDL_GetError()));
             throw std::runtime_error("Failed to create window");
         }
+        m_mode = descriptor.Mode;
+        windowPhase.stop();
 
         // Create OpenGL context
+        StartupPhase contextPhase("gl.context");
         m_glContext = SDL_GL_CreateContext(m_window);
         if (!m_glContext) {
             logger->error(std::format("Failed to create OpenGL context: {}", SDL_GetError()));
             throw std::runtime_error("Failed to create OpenGL context");
         }
+        contextPhase.stop();
 
         // Initialize GLAD
+        StartupPhase loaderPhase("gl.load");
         if (!gladLoadGLLoader(GLADloadproc(SDL_GL_GetProcAddress))) {
             logger->error("Failed to initialize GLAD");
             throw std::runtime_error("Failed to initialize GLAD");
         }
+        loaderPhase.stop();
+
+        if (descriptor.SRGB) {
+            glEnable(GL_FRAMEBUFFER_SRGB);
+        }
+        if (descriptor.MsaaSamples > 0) {
+            glEnable(GL_MULTISAMPLE);
+        }
+
+        setSwapInterval(descriptor.SwapMode);
+        updateViewport();
+        logContextInfo();
     }
 
     Window::~Window() {
@@ -54,4 +140,84 @@ namespace TriHarder {
     void Window::SwapBuffers() const {
         SDL_GL_SwapWindow(m_window);
     }
+
+    SwapInterval Window::setSwapInterval(SwapInterval interval) {
+        auto logger = LogManager::getInstance().getLogger();
+        if (SDL_GL_SetSwapInterval(static_cast<int>(interval)) == 0) {
+            m_swapInterval = interval;
+            logger->info(std::format("Swap interval set to {}", toString(interval)));
+            return m_swapInterval;
+        }
+
+        if (interval == SwapInterval::Adaptive) {
+            logger->warn(std::format("Adaptive sync is not supported ({}), falling back to VSync", SDL_GetError()));
+            return setSwapInterval(SwapInterval::VSync);
+        }
+
+        // Keep whatever interval the driver reports as active
+        m_swapInterval = static_cast<SwapInterval>(SDL_GL_GetSwapInterval());
+        logger->warn(std::format("Failed to set swap interval {}: {} (active: {})",
+                                 toString(interval), SDL_GetError(), toString(m_swapInterval)));
+        return m_swapInterval;
+    }
+
+    bool Window::setWindowMode(WindowMode mode) {
+        if (SDL_SetWindowFullscreen(m_window, toSdlFullscreenFlags(mode)) != 0) {
+            auto logger = LogManager::getInstance().getLogger();
+            logger->error(std::format("Failed to change window mode: {}", SDL_GetError()));
+            return false;
+        }
+
+        if (mode == WindowMode::Windowed) {
+            SDL_SetWindowBordered(m_window, SDL_TRUE);
+        }
+
+        m_mode = mode;
+        updateViewport();
+        return true;
+    }
+
+    bool Window::handleEvent(const SDL_Event &event) {
+        if (event.type != SDL_WINDOWEVENT || event.window.windowID != SDL_GetWindowID(m_window)) {
+            return false;
+        }
+
+        switch (event.window.event) {
+            case SDL_WINDOWEVENT_RESIZED:
+            case SDL_WINDOWEVENT_SIZE_CHANGED:
+                m_width = static_cast<uint32_t>(event.window.data1);
+                m_height = static_cast<uint32_t>(event.window.data2);
+                updateViewport();
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void Window::updateViewport() {
+        // The drawable size differs from the window size on high-DPI displays
+        int drawableWidth = 0;
+        int drawableHeight = 0;
+        SDL_GL_GetDrawableSize(m_window, &drawableWidth, &drawableHeight);
+        glViewport(0, 0, drawableWidth, drawableHeight);
+        m_drawableWidth = static_cast<uint32_t>(drawableWidth);
+        m_drawableHeight = static_cast<uint32_t>(drawableHeight);
+    }
+
+    void Window::logContextInfo() const {
+        int major = 0, minor = 0, depth = 0, stencil = 0, samples = 0, srgb = 0, noError = 0;
+        SDL_GL_GetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, &major);
+        SDL_GL_GetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, &minor);
+        SDL_GL_GetAttribute(SDL_GL_DEPTH_SIZE, &depth);
+        SDL_GL_GetAttribute(SDL_GL_STENCIL_SIZE, &stencil);
+        SDL_GL_GetAttribute(SDL_GL_MULTISAMPLESAMPLES, &samples);
+        SDL_GL_GetAttribute(SDL_GL_FRAMEBUFFER_SRGB_CAPABLE, &srgb);
+        SDL_GL_GetAttribute(SDL_GL_CONTEXT_NO_ERROR, &noError);
+
+        auto renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+        auto logger = LogManager::getInstance().getLogger();
+        logger->info(std::format("OpenGL {}.{} context ({}), depth: {}, stencil: {}, msaa: {}, srgb: {}, no-error: {}",
+                                 major, minor, renderer ? renderer : "unknown renderer",
+                                 depth, stencil, samples, srgb, noError));
+    }
 }
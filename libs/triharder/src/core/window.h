@@ -1,18 +1,52 @@
 #pragma once
 #include <utility>
 #include <SDL_video.h>
+#include <SDL_events.h>
 
 #include "../triharder.h"
 
 namespace TriHarder {
 
+    /**
+     * @enum GLProfile
+     * @brief Selects the OpenGL context profile requested from SDL.
+     */
+    enum class GLProfile : uint8_t {
+        Core,           ///< Core profile without deprecated functionality.
+        Compatibility,  ///< Compatibility profile including deprecated functionality.
+        ES,             ///< OpenGL ES profile.
+    };
+
+    /**
+     * @enum SwapInterval
+     * @brief Controls how buffer swaps are synchronized with the display refresh.
+     *
+     * The values map directly to the argument of SDL_GL_SetSwapInterval.
+     */
+    enum class SwapInterval : int8_t {
+        Adaptive  = -1, ///< Late swaps tear instead of waiting a full refresh; falls back to VSync if unsupported.
+        Immediate = 0,  ///< Swap immediately without waiting for the vertical retrace.
+        VSync     = 1,  ///< Wait for the vertical retrace before swapping.
+    };
+
+    /**
+     * @enum WindowMode
+     * @brief Describes how the window occupies the display.
+     */
+    enum class WindowMode : uint8_t {
+        Windowed,   ///< Regular decorated window.
+        Fullscreen, ///< Exclusive fullscreen with a display mode change.
+        Borderless, ///< Borderless window covering the desktop (fullscreen desktop).
+    };
+
     /**
      * @struct WindowDescriptor
      * @brief Defines the properties of a window to be created.
      *
      * This structure is used to specify the characteristics of a window, including its title,
-     * width, and height. It serves as a parameter for window creation functions, allowing
-     * for the customization of window properties before creation.
+     * width, and height as well as the OpenGL context and framebuffer configuration. It serves
+     * as a parameter for window creation functions, allowing for the customization of window
+     * properties before creation.
      *
      * @param Title The title of the window. Default is "TriHarder Library".
      * @param Width The width of the window in pixels. Default is 1600.
@@ -23,11 +57,28 @@ namespace TriHarder {
         uint32_t Width; ///< The width of the window in pixels.
         uint32_t Height; ///< The height of the window in pixels.
 
+        int ContextMajorVersion = 3; ///< Requested OpenGL context major version.
+        int ContextMinorVersion = 3; ///< Requested OpenGL context minor version.
+        GLProfile Profile = GLProfile::Core; ///< Requested OpenGL context profile.
+        bool DebugContext = false; ///< Requests a debug context (SDL_GL_CONTEXT_DEBUG_FLAG).
+        bool NoErrorContext = false; ///< Requests a KHR_no_error context; GL errors become undefined behavior.
+
+        SwapInterval SwapMode = SwapInterval::VSync; ///< Initial swap interval.
+        bool SRGB = false; ///< Requests an sRGB capable default framebuffer and enables GL_FRAMEBUFFER_SRGB.
+        uint8_t MsaaSamples = 0; ///< Number of multisample samples, 0 disables MSAA.
+        uint8_t DepthBits = 24; ///< Depth buffer bits of the default framebuffer.
+        uint8_t StencilBits = 8; ///< Stencil buffer bits of the default framebuffer.
+
+        WindowMode Mode = WindowMode::Windowed; ///< Initial window mode.
+        bool Resizable = true; ///< Allows the user to resize the window.
+        bool Hidden = false; ///< Creates the window hidden, e.g. for headless runs and benchmarks.
+
         /**
          * @brief Constructs a WindowDescriptor with specified properties.
          *
          * This constructor initializes a WindowDescriptor object with the given title, width,
          * and height. If no arguments are provided, it defaults to a predefined set of values.
+         * The context and framebuffer settings keep their defaults and can be adjusted afterwards.
          *
          * @param title The title of the window. Defaults to "TriHarder Library".
          * @param width The width of the window in pixels. Defaults to 1600.
@@ -39,6 +90,9 @@ namespace TriHarder {
         }
     };
 
+    //! @brief Returns a readable name for the given swap interval.
+    const char* toString(SwapInterval interval);
+
     class Window {
     public:
         static UniquePtr<Window> create(const WindowDescriptor &descriptor = WindowDescriptor());
@@ -46,13 +100,41 @@ namespace TriHarder {
 
         void SwapBuffers() const;
 
+        //! Changes the swap interval. Adaptive sync falls back to VSync when the driver rejects it.
+        //! @param interval The requested swap interval.
+        //! @return The swap interval that is actually in effect.
+        SwapInterval setSwapInterval(SwapInterval interval);
+
+        //! Switches between windowed, fullscreen and borderless mode.
+        //! @return True if SDL accepted the mode change.
+        bool setWindowMode(WindowMode mode);
+
+        //! Processes window related SDL events such as resizes.
+        //! @return True if the event was consumed by the window.
+        bool handleEvent(const SDL_Event &event);
+
+        [[nodiscard]] uint32_t getWidth() const { return m_width; }
+        [[nodiscard]] uint32_t getHeight() const { return m_height; }
+        //! @return Width of the default framebuffer in pixels, differs from getWidth() on high-DPI displays.
+        [[nodiscard]] uint32_t getDrawableWidth() const { return m_drawableWidth; }
+        [[nodiscard]] uint32_t getDrawableHeight() const { return m_drawableHeight; }
+        [[nodiscard]] SwapInterval getSwapInterval() const { return m_swapInterval; }
+        [[nodiscard]] WindowMode getWindowMode() const { return m_mode; }
+        [[nodiscard]] SDL_Window* getNativeWindow() const { return m_window; }
+
     private:
         String m_title;
         uint32_t m_width = 0;
         uint32_t m_height = 0;
+        uint32_t m_drawableWidth = 0;
+        uint32_t m_drawableHeight = 0;
+        SwapInterval m_swapInterval = SwapInterval::VSync;
+        WindowMode m_mode = WindowMode::Windowed;
         SDL_Window *m_window = nullptr;
         SDL_GLContext m_glContext = nullptr;
 
         void initialize(const WindowDescriptor &descriptor);
+        void updateViewport();
+        void logContextInfo() const;
     };
 }
@@ -0,0 +1,225 @@
+#include "particle_renderer.h"
+#include <algorithm>
+#include <cstddef>
+#include "../core/job_system.h"
+#include "../core/memory_tracker.h"
+
+namespace TriHarder {
+
+    //! Four corners of two floats, the instances are tracked by their capacity.
+    static constexpr int64_t QuadBufferBytes = 8 * sizeof(float);
+
+    static const char* ParticleVertexShader = R"(#version 330 core
+layout(location = 0) in vec2 aCorner;
+layout(location = 1) in vec4 aPositionSize;
+layout(location = 2) in vec4 aColor;
+uniform mat4 uViewProjection;
+uniform vec3 uRight;
+uniform vec3 uUp;
+out vec2 vUv;
+out vec4 vColor;
+void main() {
+    vec3 position = aPositionSize.xyz + (uRight * aCorner.x + uUp * aCorner.y) * aPositionSize.w;
+    gl_Position = uViewProjection * vec4(position, 1.0);
+    vUv = aCorner + 0.5;
+    vColor = aColor;
+}
+)";
+
+    static const char* ParticleFragmentShader = R"(#version 330 core
+in vec2 vUv;
+in vec4 vColor;
+uniform sampler2D uTexture;
+uniform bool uTextured;
+out vec4 fragColor;
+void main() {
+    float mask = uTextured ? texture(uTexture, vUv).a : clamp(1.0 - length(vUv * 2.0 - 1.0), 0.0, 1.0);
+    fragColor = vec4(vColor.rgb, vColor.a * mask);
+}
+)";
+
+    static uint32_t lerpColor(const float start[4], const float delta[4], float t) {
+        uint32_t color = 0;
+        for (int channel = 0; channel < 4; ++channel) {
+            auto value = static_cast<uint32_t>(start[channel] + delta[channel] * t + 0.5f);
+            color |= std::min(value, 255u) << (channel * 8);
+        }
+        return color;
+    }
+
+    UniquePtr<ParticleRenderer> ParticleRenderer::create() {
+        MemoryTagScope scope(MemoryTag::Rendering);
+        auto renderer = UniquePtr<ParticleRenderer>(new ParticleRenderer());
+        renderer->initializeGpuResources();
+        renderer->createMaterial(ParticleMaterial());
+        return renderer;
+    }
+
+    ParticleRenderer::~ParticleRenderer() {
+        glDeleteBuffers(1, &instanceBuffer_);
+        glDeleteBuffers(1, &quadBuffer_);
+        glDeleteVertexArrays(1, &vao_);
+        MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Buffer,
+                                      -static_cast<int64_t>(QuadBufferBytes + instanceCapacity_ * sizeof(ParticleInstance)));
+    }
+
+    void ParticleRenderer::initializeGpuResources() {
+        shader_ = Shader::create("particles", ParticleVertexShader, ParticleFragmentShader);
+        viewProjectionLocation_ = shader_->getUniformLocation("uViewProjection");
+        rightLocation_ = shader_->getUniformLocation("uRight");
+        upLocation_ = shader_->getUniformLocation("uUp");
+        texturedLocation_ = shader_->getUniformLocation("uTextured");
+        shader_->use();
+        glUniform1i(shader_->getUniformLocation("uTexture"), 0);
+
+        const float corners[] = {-0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f};
+        glGenVertexArrays(1, &vao_);
+        glBindVertexArray(vao_);
+
+        glGenBuffers(1, &quadBuffer_);
+        glBindBuffer(GL_ARRAY_BUFFER, quadBuffer_);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Buffer, QuadBufferBytes);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+        glGenBuffers(1, &instanceBuffer_);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+        for (GLuint attribute = 1; attribute <= 2; ++attribute) {
+            glEnableVertexAttribArray(attribute);
+            glVertexAttribDivisor(attribute, 1);
+        }
+        glBindVertexArray(0);
+    }
+
+    ParticleMaterialId ParticleRenderer::createMaterial(const ParticleMaterial& material) {
+        materials_.push_back(material);
+        materialOffsets_.resize(materials_.size());
+        materialCounts_.resize(materials_.size());
+        return static_cast<ParticleMaterialId>(materials_.size() - 1);
+    }
+
+    void ParticleRenderer::draw(const ParticleSystem& system, const ParticleCamera& camera) {
+        stats_ = ParticleRendererStats();
+        const auto& emitters = system.getEmitters();
+        auto materialOf = [this](const ParticleEmitter& emitter) {
+            return emitter.Descriptor.Material < materials_.size() ? emitter.Descriptor.Material : 0;
+        };
+
+        // Lay out the instances of each material contiguously
+        std::fill(materialCounts_.begin(), materialCounts_.end(), 0);
+        for (const auto& emitter : emitters) {
+            materialCounts_[materialOf(emitter)] += emitter.Pool.Count;
+        }
+        uint64_t total = 0;
+        for (size_t material = 0; material < materials_.size(); ++material) {
+            materialOffsets_[material] = total;
+            total += materialCounts_[material];
+        }
+        if (total == 0) {
+            return;
+        }
+
+        batches_.clear();
+        std::fill(materialCounts_.begin(), materialCounts_.end(), 0);
+        for (uint32_t index = 0; index < emitters.size(); ++index) {
+            const auto& pool = emitters[index].Pool;
+            auto material = materialOf(emitters[index]);
+            uint64_t output = materialOffsets_[material] + materialCounts_[material];
+            for (uint32_t begin = 0; begin < pool.Count; begin += BatchSize) {
+                batches_.push_back({index, begin, std::min(pool.Count, begin + BatchSize), output + begin});
+            }
+            materialCounts_[material] += pool.Count;
+        }
+
+        glBindVertexArray(vao_);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+        if (total > instanceCapacity_) {
+            MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Buffer,
+                                          int64_t(total + total / 2 - instanceCapacity_) * int64_t(sizeof(ParticleInstance)));
+            instanceCapacity_ = total + total / 2;
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(instanceCapacity_ * sizeof(ParticleInstance)),
+                         nullptr, GL_STREAM_DRAW);
+        }
+
+        // Invalidating the buffer lets the driver hand out fresh storage instead of waiting on the last frame
+        auto bytes = static_cast<GLsizeiptr>(total * sizeof(ParticleInstance));
+        auto instances = static_cast<ParticleInstance*>(
+            glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (!instances) {
+            glBindVertexArray(0);
+            return;
+        }
+
+        JobSystem::getInstance().parallelFor(batches_.size(), 1, [&](size_t begin, size_t end, uint32_t) {
+            for (size_t b = begin; b < end; ++b) {
+                const auto& batch = batches_[b];
+                const auto& emitter = emitters[batch.Emitter];
+                const auto& pool = emitter.Pool;
+                const auto& descriptor = emitter.Descriptor;
+
+                float startColor[4];
+                float colorDelta[4];
+                for (int channel = 0; channel < 4; ++channel) {
+                    startColor[channel] = float((descriptor.StartColor >> (channel * 8)) & 0xFF);
+                    colorDelta[channel] = float((descriptor.EndColor >> (channel * 8)) & 0xFF) - startColor[channel];
+                }
+                const float sizeDelta = descriptor.EndSize - descriptor.StartSize;
+
+                ParticleInstance* out = instances + batch.Output;
+                for (uint32_t i = batch.Begin; i < batch.End; ++i, ++out) {
+                    float life = pool.Life[i];
+                    out->PositionSize[0] = pool.PositionX[i];
+                    out->PositionSize[1] = pool.PositionY[i];
+                    out->PositionSize[2] = pool.PositionZ[i];
+                    out->PositionSize[3] = descriptor.StartSize + sizeDelta * life;
+                    out->Color = lerpColor(startColor, colorDelta, life);
+                }
+            }
+        });
+
+        if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_FALSE) {
+            // The storage was lost while mapped, skip this frame
+            glBindVertexArray(0);
+            return;
+        }
+        stats_.Instances = total;
+        stats_.UploadBytes = static_cast<uint64_t>(bytes);
+
+        shader_->use();
+        glUniformMatrix4fv(viewProjectionLocation_, 1, GL_FALSE, camera.ViewProjection);
+        glUniform3f(rightLocation_, camera.Right.X, camera.Right.Y, camera.Right.Z);
+        glUniform3f(upLocation_, camera.Up.X, camera.Up.Y, camera.Up.Z);
+        glActiveTexture(GL_TEXTURE0);
+        glEnable(GL_BLEND);
+        // Particles are depth tested against the scene, the caller's depth test state is restored afterwards
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_FALSE);
+
+        for (size_t material = 0; material < materials_.size(); ++material) {
+            if (materialCounts_[material] == 0) {
+                continue;
+            }
+
+            auto offset = reinterpret_cast<const char*>(materialOffsets_[material] * sizeof(ParticleInstance));
+            auto stride = static_cast<GLsizei>(sizeof(ParticleInstance));
+            glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, offset + offsetof(ParticleInstance, PositionSize));
+            glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, offset + offsetof(ParticleInstance, Color));
+
+            const auto& settings = materials_[material];
+            glBlendFunc(GL_SRC_ALPHA, settings.Additive ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+            glUniform1i(texturedLocation_, settings.Texture != 0);
+            glBindTexture(GL_TEXTURE_2D, settings.Texture);
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(materialCounts_[material]));
+            stats_.DrawCalls++;
+        }
+
+        glDepthMask(GL_TRUE);
+        if (!depthTest) {
+            glDisable(GL_DEPTH_TEST);
+        }
+        glDisable(GL_BLEND);
+        glBindVertexArray(0);
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "particle_system.h"
+#include "../graphics/shader.h"
+
+namespace TriHarder {
+
+    //! @struct ParticleMaterial
+    //! @brief Texture and blending shared by the emitters drawn in one call.
+    struct ParticleMaterial {
+        GLuint Texture = 0; //!< Sprite texture, 0 draws a soft round sprite.
+        bool Additive = true; //!< Additive blending, otherwise alpha blending.
+    };
+
+    //! @struct ParticleCamera
+    //! @brief View data needed to build camera facing quads.
+    struct ParticleCamera {
+        float ViewProjection[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}; //!< Column-major.
+        Float3 Right{1.0f, 0.0f, 0.0f}; //!< Camera right axis in world space.
+        Float3 Up{0.0f, 1.0f, 0.0f}; //!< Camera up axis in world space.
+    };
+
+    //! @struct ParticleRendererStats
+    //! @brief Counters of the last draw().
+    struct ParticleRendererStats {
+        uint32_t DrawCalls = 0;
+        uint64_t Instances = 0;
+        uint64_t UploadBytes = 0;
+    };
+
+    //! @class ParticleRenderer
+    //! @brief Draws the particles of a ParticleSystem as instanced quads.
+    //!
+    //! All emitters sharing a material are drawn with one instanced call. The instance
+    //! data of every emitter is written straight into the mapped buffer by the job
+    //! system, so the whole frame is a single upload.
+    class ParticleRenderer {
+    public:
+        //! Creates the renderer with the default material (id 0). Requires a current OpenGL context.
+        static UniquePtr<ParticleRenderer> create();
+        ~ParticleRenderer();
+
+        ParticleRenderer(const ParticleRenderer&) = delete;
+        ParticleRenderer& operator=(const ParticleRenderer&) = delete;
+
+        //! Registers a material that emitters can reference in EmitterDescriptor::Material.
+        ParticleMaterialId createMaterial(const ParticleMaterial& material);
+
+        //! Draws all live particles. Call from IScene::draw() after the opaque geometry.
+        void draw(const ParticleSystem& system, const ParticleCamera& camera);
+
+        [[nodiscard]] const ParticleRendererStats& getStats() const { return stats_; }
+
+        //! Particles written per job.
+        static constexpr uint32_t BatchSize = 16384;
+
+    private:
+        struct ParticleInstance {
+            float PositionSize[4];
+            uint32_t Color;
+        };
+
+        struct Batch {
+            uint32_t Emitter;
+            uint32_t Begin;
+            uint32_t End;
+            uint64_t Output;
+        };
+
+        ParticleRenderer() = default;
+        void initializeGpuResources();
+
+        UniquePtr<Shader> shader_;
+        GLint viewProjectionLocation_ = -1;
+        GLint rightLocation_ = -1;
+        GLint upLocation_ = -1;
+        GLint texturedLocation_ = -1;
+        GLuint vao_ = 0;
+        GLuint quadBuffer_ = 0;
+        GLuint instanceBuffer_ = 0;
+        uint64_t instanceCapacity_ = 0;
+
+        std::vector<ParticleMaterial> materials_;
+        std::vector<uint64_t> materialOffsets_;
+        std::vector<uint64_t> materialCounts_;
+        std::vector<Batch> batches_;
+        ParticleRendererStats stats_;
+    };
+}
@@ -0,0 +1,324 @@
+#include "particle_system.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include "../core/job_system.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define TRIHARDER_PARTICLES_SSE2 1
+#else
+#define TRIHARDER_PARTICLES_SSE2 0
+#endif
+
+namespace TriHarder {
+
+    static constexpr uint32_t SimdWidth = 4;
+    static constexpr float MinLifetime = 1e-4f;
+
+    static uint32_t roundUp(uint32_t value, uint32_t multiple) {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+#if TRIHARDER_PARTICLES_SSE2
+    //! Advances four xorshift32 generators and returns their values in [0, 1).
+    static __m128 nextRandom4(__m128i& state) {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+        __m128i mantissa = _mm_or_si128(_mm_srli_epi32(state, 9), _mm_set1_epi32(0x3F800000));
+        return _mm_sub_ps(_mm_castsi128_ps(mantissa), _mm_set1_ps(1.0f));
+    }
+#else
+    static uint32_t nextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    //! Maps the upper 23 bits of a random number to [0, 1), matching nextRandom4().
+    static float toUnitFloat(uint32_t random) {
+        return std::bit_cast<float>((random >> 9) | 0x3F800000u) - 1.0f;
+    }
+#endif
+
+    //! Integrates [begin, end) and writes the indices of particles that died to pool.DeadIndices[begin...].
+    //! @return Number of particles that died.
+    static uint32_t integrate(ParticlePool& pool, const EmitterDescriptor& descriptor,
+                              uint32_t begin, uint32_t end, float deltaTime) {
+        const float damping = std::max(0.0f, 1.0f - descriptor.Drag * deltaTime);
+        const float gravityX = descriptor.Gravity.X * deltaTime;
+        const float gravityY = descriptor.Gravity.Y * deltaTime;
+        const float gravityZ = descriptor.Gravity.Z * deltaTime;
+
+        float* positionX = pool.PositionX.data();
+        float* positionY = pool.PositionY.data();
+        float* positionZ = pool.PositionZ.data();
+        float* velocityX = pool.VelocityX.data();
+        float* velocityY = pool.VelocityY.data();
+        float* velocityZ = pool.VelocityZ.data();
+        float* life = pool.Life.data();
+        const float* lifeRate = pool.LifeRate.data();
+        uint32_t* dead = pool.DeadIndices.data() + begin;
+        uint32_t deadCount = 0;
+
+        uint32_t i = begin;
+#if TRIHARDER_PARTICLES_SSE2
+        const __m128 dt = _mm_set1_ps(deltaTime);
+        const __m128 damp = _mm_set1_ps(damping);
+        const __m128 gx = _mm_set1_ps(gravityX);
+        const __m128 gy = _mm_set1_ps(gravityY);
+        const __m128 gz = _mm_set1_ps(gravityZ);
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (; i + SimdWidth <= end; i += SimdWidth) {
+            __m128 vx = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(velocityX + i), damp), gx);
+            __m128 vy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(velocityY + i), damp), gy);
+            __m128 vz = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(velocityZ + i), damp), gz);
+            _mm_storeu_ps(velocityX + i, vx);
+            _mm_storeu_ps(velocityY + i, vy);
+            _mm_storeu_ps(velocityZ + i, vz);
+            _mm_storeu_ps(positionX + i, _mm_add_ps(_mm_loadu_ps(positionX + i), _mm_mul_ps(vx, dt)));
+            _mm_storeu_ps(positionY + i, _mm_add_ps(_mm_loadu_ps(positionY + i), _mm_mul_ps(vy, dt)));
+            _mm_storeu_ps(positionZ + i, _mm_add_ps(_mm_loadu_ps(positionZ + i), _mm_mul_ps(vz, dt)));
+
+            __m128 age = _mm_add_ps(_mm_loadu_ps(life + i), _mm_mul_ps(_mm_loadu_ps(lifeRate + i), dt));
+            _mm_storeu_ps(life + i, age);
+
+            auto mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpge_ps(age, one)));
+            while (mask != 0) {
+                dead[deadCount++] = i + std::countr_zero(mask);
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; i < end; ++i) {
+            velocityX[i] = velocityX[i] * damping + gravityX;
+            velocityY[i] = velocityY[i] * damping + gravityY;
+            velocityZ[i] = velocityZ[i] * damping + gravityZ;
+            positionX[i] += velocityX[i] * deltaTime;
+            positionY[i] += velocityY[i] * deltaTime;
+            positionZ[i] += velocityZ[i] * deltaTime;
+            life[i] += lifeRate[i] * deltaTime;
+            if (life[i] >= 1.0f) {
+                dead[deadCount++] = i;
+            }
+        }
+        return deadCount;
+    }
+
+    ParticleSystem::ParticleSystem(uint32_t batchSize)
+        : batchSize_(roundUp(std::max(batchSize, 1u), SimdWidth)) {}
+
+    EmitterHandle ParticleSystem::createEmitter(const EmitterDescriptor& descriptor) {
+        EmitterHandle handle;
+        if (!freeEmitters_.empty()) {
+            handle = freeEmitters_.back();
+            freeEmitters_.pop_back();
+        } else {
+            handle = static_cast<EmitterHandle>(emitters_.size());
+            emitters_.emplace_back();
+        }
+
+        auto& emitter = emitters_[handle];
+        emitter = ParticleEmitter();
+        emitter.Descriptor = descriptor;
+        emitter.Alive = true;
+
+        // Each lane needs its own non-zero xorshift state
+        uint32_t seed = descriptor.Seed != 0 ? descriptor.Seed : 1;
+        for (auto& state : emitter.Random) {
+            seed = seed * 747796405u + 2891336453u;
+            state = seed != 0 ? seed : 1;
+        }
+
+        // Pad so the emit kernel may write a full SIMD group past the last particle
+        auto& pool = emitter.Pool;
+        pool.Capacity = descriptor.MaxParticles;
+        size_t paddedSize = roundUp(pool.Capacity, SimdWidth) + SimdWidth;
+        for (auto* array : {&pool.PositionX, &pool.PositionY, &pool.PositionZ, &pool.VelocityX,
+                            &pool.VelocityY, &pool.VelocityZ, &pool.Life, &pool.LifeRate}) {
+            array->resize(paddedSize);
+        }
+        pool.DeadIndices.resize(pool.Capacity);
+
+        // Reserve the batch list for all pools at full capacity so update() never allocates
+        size_t batchCount = 0;
+        for (const auto& other : emitters_) {
+            if (other.Alive) {
+                batchCount += (other.Pool.Capacity + batchSize_ - 1) / batchSize_;
+            }
+        }
+        batches_.reserve(batchCount);
+        return handle;
+    }
+
+    void ParticleSystem::destroyEmitter(EmitterHandle handle) {
+        if (handle >= emitters_.size() || !emitters_[handle].Alive) {
+            return;
+        }
+        emitters_[handle] = ParticleEmitter();
+        freeEmitters_.push_back(handle);
+    }
+
+    void ParticleSystem::setEmitterPosition(EmitterHandle handle, const Float3& position) {
+        emitters_[handle].Descriptor.Position = position;
+    }
+
+    void ParticleSystem::setEmitterActive(EmitterHandle handle, bool active) {
+        emitters_[handle].Active = active;
+    }
+
+    void ParticleSystem::burst(EmitterHandle handle, uint32_t count) {
+        emitters_[handle].PendingBurst += count;
+    }
+
+    uint64_t ParticleSystem::getParticleCount() const {
+        uint64_t count = 0;
+        for (const auto& emitter : emitters_) {
+            count += emitter.Pool.Count;
+        }
+        return count;
+    }
+
+    void ParticleSystem::update(float deltaTime) {
+        stats_ = ParticleSystemStats();
+
+        for (auto& emitter : emitters_) {
+            if (!emitter.Alive) {
+                continue;
+            }
+            stats_.Emitters++;
+
+            uint32_t count = emitter.PendingBurst;
+            emitter.PendingBurst = 0;
+            if (emitter.Active) {
+                emitter.SpawnAccumulator += emitter.Descriptor.SpawnRate * deltaTime;
+                auto spawned = static_cast<uint32_t>(emitter.SpawnAccumulator);
+                emitter.SpawnAccumulator -= static_cast<float>(spawned);
+                count += spawned;
+            }
+            emit(emitter, count);
+        }
+
+        batches_.clear();
+        for (uint32_t index = 0; index < emitters_.size(); ++index) {
+            const auto& pool = emitters_[index].Pool;
+            for (uint32_t begin = 0; begin < pool.Count; begin += batchSize_) {
+                batches_.push_back({index, begin, std::min(pool.Count, begin + batchSize_), 0});
+            }
+        }
+        stats_.Batches = static_cast<uint32_t>(batches_.size());
+
+        JobSystem::getInstance().parallelFor(batches_.size(), 1, [this, deltaTime](size_t begin, size_t end, uint32_t) {
+            for (size_t i = begin; i < end; ++i) {
+                auto& batch = batches_[i];
+                auto& emitter = emitters_[batch.Emitter];
+                batch.DeadCount = integrate(emitter.Pool, emitter.Descriptor, batch.Begin, batch.End, deltaTime);
+            }
+        });
+
+        // Batches of one emitter are contiguous, compact each pool on its own
+        for (size_t first = 0; first < batches_.size();) {
+            size_t last = first;
+            while (last + 1 < batches_.size() && batches_[last + 1].Emitter == batches_[first].Emitter) {
+                ++last;
+            }
+            kill(emitters_[batches_[first].Emitter], first, last);
+            first = last + 1;
+        }
+
+        stats_.Particles = getParticleCount();
+    }
+
+    void ParticleSystem::emit(ParticleEmitter& emitter, uint32_t count) {
+        auto& pool = emitter.Pool;
+        const auto& descriptor = emitter.Descriptor;
+        count = std::min(count, pool.Capacity - pool.Count);
+        if (count == 0) {
+            // Do not build up spawn debt while the pool is full
+            emitter.SpawnAccumulator = 0.0f;
+            return;
+        }
+
+        const uint32_t first = pool.Count;
+        const float rangeX = descriptor.VelocityMax.X - descriptor.VelocityMin.X;
+        const float rangeY = descriptor.VelocityMax.Y - descriptor.VelocityMin.Y;
+        const float rangeZ = descriptor.VelocityMax.Z - descriptor.VelocityMin.Z;
+        const float lifetimeRange = descriptor.LifetimeMax - descriptor.LifetimeMin;
+
+#if TRIHARDER_PARTICLES_SSE2
+        __m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(emitter.Random));
+        const __m128 positionX = _mm_set1_ps(descriptor.Position.X);
+        const __m128 positionY = _mm_set1_ps(descriptor.Position.Y);
+        const __m128 positionZ = _mm_set1_ps(descriptor.Position.Z);
+        const __m128 minX = _mm_set1_ps(descriptor.VelocityMin.X);
+        const __m128 minY = _mm_set1_ps(descriptor.VelocityMin.Y);
+        const __m128 minZ = _mm_set1_ps(descriptor.VelocityMin.Z);
+        const __m128 spanX = _mm_set1_ps(rangeX);
+        const __m128 spanY = _mm_set1_ps(rangeY);
+        const __m128 spanZ = _mm_set1_ps(rangeZ);
+        const __m128 lifetimeMin = _mm_set1_ps(descriptor.LifetimeMin);
+        const __m128 lifetimeSpan = _mm_set1_ps(lifetimeRange);
+        const __m128 minLifetime = _mm_set1_ps(MinLifetime);
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        // Whole SIMD groups are written, lanes past the new count are ignored
+        for (uint32_t i = 0; i < count; i += SimdWidth) {
+            uint32_t index = first + i;
+            _mm_storeu_ps(&pool.PositionX[index], positionX);
+            _mm_storeu_ps(&pool.PositionY[index], positionY);
+            _mm_storeu_ps(&pool.PositionZ[index], positionZ);
+            _mm_storeu_ps(&pool.VelocityX[index], _mm_add_ps(minX, _mm_mul_ps(nextRandom4(state), spanX)));
+            _mm_storeu_ps(&pool.VelocityY[index], _mm_add_ps(minY, _mm_mul_ps(nextRandom4(state), spanY)));
+            _mm_storeu_ps(&pool.VelocityZ[index], _mm_add_ps(minZ, _mm_mul_ps(nextRandom4(state), spanZ)));
+
+            __m128 lifetime = _mm_add_ps(lifetimeMin, _mm_mul_ps(nextRandom4(state), lifetimeSpan));
+            _mm_storeu_ps(&pool.Life[index], _mm_setzero_ps());
+            _mm_storeu_ps(&pool.LifeRate[index], _mm_div_ps(one, _mm_max_ps(lifetime, minLifetime)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(emitter.Random), state);
+#else
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t index = first + i;
+            uint32_t& state = emitter.Random[i % SimdWidth];
+            pool.PositionX[index] = descriptor.Position.X;
+            pool.PositionY[index] = descriptor.Position.Y;
+            pool.PositionZ[index] = descriptor.Position.Z;
+            pool.VelocityX[index] = descriptor.VelocityMin.X + toUnitFloat(nextRandom(state)) * rangeX;
+            pool.VelocityY[index] = descriptor.VelocityMin.Y + toUnitFloat(nextRandom(state)) * rangeY;
+            pool.VelocityZ[index] = descriptor.VelocityMin.Z + toUnitFloat(nextRandom(state)) * rangeZ;
+            float lifetime = descriptor.LifetimeMin + toUnitFloat(nextRandom(state)) * lifetimeRange;
+            pool.Life[index] = 0.0f;
+            pool.LifeRate[index] = 1.0f / std::max(lifetime, MinLifetime);
+        }
+#endif
+
+        pool.Count += count;
+        stats_.Emitted += count;
+    }
+
+    void ParticleSystem::kill(ParticleEmitter& emitter, size_t firstBatch, size_t lastBatch) {
+        // Dead indices are visited in descending order, so every particle moved from the
+        // end into a hole is alive: all dead particles behind it were removed before.
+        auto& pool = emitter.Pool;
+        for (size_t b = lastBatch + 1; b-- > firstBatch;) {
+            const auto& batch = batches_[b];
+            for (uint32_t d = batch.DeadCount; d-- > 0;) {
+                uint32_t index = pool.DeadIndices[batch.Begin + d];
+                uint32_t last = --pool.Count;
+                if (index != last) {
+                    pool.PositionX[index] = pool.PositionX[last];
+                    pool.PositionY[index] = pool.PositionY[last];
+                    pool.PositionZ[index] = pool.PositionZ[last];
+                    pool.VelocityX[index] = pool.VelocityX[last];
+                    pool.VelocityY[index] = pool.VelocityY[last];
+                    pool.VelocityZ[index] = pool.VelocityZ[last];
+                    pool.Life[index] = pool.Life[last];
+                    pool.LifeRate[index] = pool.LifeRate[last];
+                }
+            }
+            stats_.Killed += batch.DeadCount;
+        }
+    }
+}
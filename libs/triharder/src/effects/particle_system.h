@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../triharder.h"
+#include "../core/vector_math.h"
+
+namespace TriHarder {
+
+    //! Identifies a material registered with the ParticleRenderer.
+    using ParticleMaterialId = uint32_t;
+
+    //! Identifies an emitter of a ParticleSystem.
+    using EmitterHandle = uint32_t;
+
+    //! @struct EmitterDescriptor
+    //! @brief Spawn and simulation parameters of a particle emitter.
+    struct EmitterDescriptor {
+        Float3 Position;
+        Float3 VelocityMin{-1.0f, 2.0f, -1.0f}; //!< Initial velocity is picked uniformly from [VelocityMin, VelocityMax].
+        Float3 VelocityMax{1.0f, 4.0f, 1.0f};
+        Float3 Gravity{0.0f, -9.81f, 0.0f};
+        float Drag = 0.0f; //!< Fraction of the velocity lost per second.
+        float SpawnRate = 1000.0f; //!< Particles per second while the emitter is active.
+        float LifetimeMin = 1.0f; //!< Lifetime in seconds is picked uniformly from [LifetimeMin, LifetimeMax].
+        float LifetimeMax = 2.0f;
+        float StartSize = 0.1f;
+        float EndSize = 0.0f;
+        uint32_t StartColor = 0xFFFFFFFF; //!< Packed RGBA8 color, red in the lowest byte.
+        uint32_t EndColor = 0x00FFFFFF;
+        uint32_t MaxParticles = 10000;
+        ParticleMaterialId Material = 0;
+        uint32_t Seed = 1;
+    };
+
+    //! @struct ParticlePool
+    //! @brief Structure of arrays storage of the live particles of one emitter.
+    //!
+    //! Live particles occupy [0, Count). The arrays are padded so kernels can always
+    //! write whole SIMD lanes past the end.
+    struct ParticlePool {
+        std::vector<float> PositionX;
+        std::vector<float> PositionY;
+        std::vector<float> PositionZ;
+        std::vector<float> VelocityX;
+        std::vector<float> VelocityY;
+        std::vector<float> VelocityZ;
+        std::vector<float> Life; //!< Normalized age, the particle dies when it reaches 1.
+        std::vector<float> LifeRate; //!< Reciprocal lifetime in seconds.
+        std::vector<uint32_t> DeadIndices; //!< Scratch space filled by the integrate kernel.
+        uint32_t Count = 0;
+        uint32_t Capacity = 0;
+    };
+
+    //! @struct ParticleEmitter
+    //! @brief An emitter and its particles.
+    struct ParticleEmitter {
+        EmitterDescriptor Descriptor;
+        ParticlePool Pool;
+        float SpawnAccumulator = 0.0f;
+        uint32_t PendingBurst = 0;
+        uint32_t Random[4] = {}; //!< One xorshift state per SIMD lane.
+        bool Active = true; //!< Spawns particles over time.
+        bool Alive = false; //!< False for destroyed emitters whose slot is free.
+    };
+
+    //! @struct ParticleSystemStats
+    //! @brief Counters of the last update.
+    struct ParticleSystemStats {
+        uint32_t Emitters = 0;
+        uint64_t Particles = 0;
+        uint32_t Emitted = 0;
+        uint32_t Killed = 0;
+        uint32_t Batches = 0;
+    };
+
+    //! @class ParticleSystem
+    //! @brief Simulates particles of many emitters on the job system.
+    //!
+    //! Call update() from IScene::updateTick() and hand the system to a ParticleRenderer
+    //! in IScene::draw(). Each update emits new particles, integrates all emitters in
+    //! batches across the workers with SIMD kernels and removes dead particles by moving
+    //! the last live particle into their slot, so pools never allocate after creation.
+    class ParticleSystem {
+    public:
+        //! @param batchSize Particles per job, rounded up to a multiple of the SIMD width.
+        explicit ParticleSystem(uint32_t batchSize = DefaultBatchSize);
+
+        //! Creates an emitter and allocates its pool.
+        EmitterHandle createEmitter(const EmitterDescriptor& descriptor);
+
+        //! Destroys an emitter together with its live particles.
+        void destroyEmitter(EmitterHandle handle);
+
+        void setEmitterPosition(EmitterHandle handle, const Float3& position);
+
+        //! Pauses or resumes spawning, live particles keep simulating.
+        void setEmitterActive(EmitterHandle handle, bool active);
+
+        //! Spawns count particles on the next update regardless of the spawn rate.
+        void burst(EmitterHandle handle, uint32_t count);
+
+        //! Advances the simulation by deltaTime seconds.
+        void update(float deltaTime);
+
+        [[nodiscard]] const ParticleEmitter& getEmitter(EmitterHandle handle) const { return emitters_[handle]; }
+        [[nodiscard]] const std::vector<ParticleEmitter>& getEmitters() const { return emitters_; }
+        [[nodiscard]] const ParticleSystemStats& getStats() const { return stats_; }
+
+        //! @return Number of live particles across all emitters.
+        [[nodiscard]] uint64_t getParticleCount() const;
+
+        static constexpr uint32_t DefaultBatchSize = 16384;
+
+    private:
+        struct Batch {
+            uint32_t Emitter;
+            uint32_t Begin;
+            uint32_t End;
+            uint32_t DeadCount;
+        };
+
+        void emit(ParticleEmitter& emitter, uint32_t count);
+        void kill(ParticleEmitter& emitter, size_t firstBatch, size_t lastBatch);
+
+        std::vector<ParticleEmitter> emitters_;
+        std::vector<EmitterHandle> freeEmitters_;
+        std::vector<Batch> batches_;
+        uint32_t batchSize_;
+        ParticleSystemStats stats_;
+    };
+}
@@ -0,0 +1,97 @@
+#include "font.h"
+#include "../core/logging.h"
+#include "../core/memory_tracker.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+namespace TriHarder {
+
+    static FT_Library getFreeTypeLibrary() {
+        static FT_Library library = nullptr;
+        static std::once_flag initialized;
+        std::call_once(initialized, []() {
+            if (FT_Init_FreeType(&library) != 0) {
+                auto logger = LogManager::getInstance().getLogger();
+                logger->error("Failed to initialize FreeType");
+                library = nullptr;
+            }
+        });
+        return library;
+    }
+
+    static std::atomic<uint32_t> nextFontId{1};
+
+    Result<SharedPtr<Font>> Font::load(const String& path, uint32_t pixelSize) {
+        MemoryTagScope scope(MemoryTag::Assets);
+        auto library = getFreeTypeLibrary();
+        if (!library) {
+            return Result<SharedPtr<Font>>::error("FreeType is not available");
+        }
+
+        FT_Face face = nullptr;
+        if (FT_New_Face(library, path.c_str(), 0, &face) != 0) {
+            return Result<SharedPtr<Font>>::error("Failed to load font: " + path);
+        }
+
+        if (FT_Set_Pixel_Sizes(face, 0, pixelSize) != 0) {
+            FT_Done_Face(face);
+            return Result<SharedPtr<Font>>::error(std::format("Font {} does not support size {}", path, pixelSize));
+        }
+
+        auto font = SharedPtr<Font>(new Font());
+        font->m_id = nextFontId++;
+        font->m_pixelSize = pixelSize;
+        font->m_face = face;
+        font->m_hasKerning = FT_HAS_KERNING(face);
+        // FreeType metrics are 26.6 fixed point
+        font->m_lineHeight = static_cast<float>(face->size->metrics.height) / 64.0f;
+        font->m_ascender = static_cast<float>(face->size->metrics.ascender) / 64.0f;
+        return Result<SharedPtr<Font>>::ok(font);
+    }
+
+    Font::~Font() {
+        if (m_face) {
+            FT_Done_Face(m_face);
+        }
+    }
+
+    uint32_t Font::getGlyphIndex(char32_t codepoint) const {
+        return FT_Get_Char_Index(m_face, codepoint);
+    }
+
+    float Font::getKerning(uint32_t leftGlyph, uint32_t rightGlyph) const {
+        if (!m_hasKerning || leftGlyph == 0 || rightGlyph == 0) {
+            return 0.0f;
+        }
+
+        FT_Vector kerning;
+        if (FT_Get_Kerning(m_face, leftGlyph, rightGlyph, FT_KERNING_DEFAULT, &kerning) != 0) {
+            return 0.0f;
+        }
+        return static_cast<float>(kerning.x) / 64.0f;
+    }
+
+    bool Font::rasterize(uint32_t glyphIndex, GlyphBitmap& bitmap) const {
+        if (FT_Load_Glyph(m_face, glyphIndex, FT_LOAD_RENDER) != 0) {
+            return false;
+        }
+
+        const auto glyph = m_face->glyph;
+        const auto& source = glyph->bitmap;
+        bitmap.Width = source.width;
+        bitmap.Height = source.rows;
+        bitmap.BearingX = glyph->bitmap_left;
+        bitmap.BearingY = glyph->bitmap_top;
+        bitmap.Advance = static_cast<float>(glyph->advance.x) / 64.0f;
+        bitmap.Pixels.resize(size_t(source.width) * source.rows);
+
+        // Copy row by row, the FreeType pitch may include padding
+        for (uint32_t row = 0; row < source.rows; ++row) {
+            std::copy_n(source.buffer + row * source.pitch, source.width, bitmap.Pixels.data() + row * source.width);
+        }
+        return true;
+    }
+}
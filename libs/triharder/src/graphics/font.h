@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../triharder.h"
+#include "../core/result.h"
+
+// Forward declaration keeps FreeType out of the public headers
+typedef struct FT_FaceRec_* FT_Face;
+
+namespace TriHarder {
+
+    //! @struct GlyphBitmap
+    //! @brief A rasterized glyph as 8-bit coverage values plus its metrics in pixels.
+    struct GlyphBitmap {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        int32_t BearingX = 0;   //!< Offset from the pen position to the left edge of the bitmap.
+        int32_t BearingY = 0;   //!< Offset from the baseline up to the top edge of the bitmap.
+        float Advance = 0.0f;   //!< Horizontal pen advance after this glyph.
+        std::vector<uint8_t> Pixels;
+    };
+
+    //! @class Font
+    //! @brief A font face loaded with FreeType at a fixed pixel size.
+    class Font {
+    public:
+        //! Loads a TrueType/OpenType font from disk.
+        //! @param path Path of the font file.
+        //! @param pixelSize Nominal glyph height in pixels.
+        //! @return The font or an error message.
+        static Result<SharedPtr<Font>> load(const String& path, uint32_t pixelSize);
+        ~Font();
+
+        Font(const Font&) = delete;
+        Font& operator=(const Font&) = delete;
+
+        //! @return A process-wide unique id used as part of glyph and text cache keys.
+        [[nodiscard]] uint32_t getId() const { return m_id; }
+        [[nodiscard]] uint32_t getPixelSize() const { return m_pixelSize; }
+        [[nodiscard]] float getLineHeight() const { return m_lineHeight; }
+        [[nodiscard]] float getAscender() const { return m_ascender; }
+
+        [[nodiscard]] uint32_t getGlyphIndex(char32_t codepoint) const;
+
+        //! @return The kerning adjustment in pixels between two glyphs.
+        [[nodiscard]] float getKerning(uint32_t leftGlyph, uint32_t rightGlyph) const;
+
+        //! Renders a glyph into an 8-bit coverage bitmap.
+        //! @return False if FreeType failed to load or render the glyph.
+        bool rasterize(uint32_t glyphIndex, GlyphBitmap& bitmap) const;
+
+    private:
+        Font() = default;
+
+        uint32_t m_id = 0;
+        uint32_t m_pixelSize = 0;
+        float m_lineHeight = 0.0f;
+        float m_ascender = 0.0f;
+        bool m_hasKerning = false;
+        FT_Face m_face = nullptr;
+    };
+}
@@ -0,0 +1,283 @@
+#include "frame_capture.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include "image_io.h"
+#include "../core/job_system.h"
+#include "../core/logging.h"
+#include "../core/memory_tracker.h"
+
+namespace TriHarder {
+
+    static constexpr GLuint64 FenceWaitTimeoutNs = 1'000'000'000;
+
+    static String getFramePath(const String& directory, uint64_t frame, const char* suffix = "") {
+        return (std::filesystem::path(directory) / std::format("frame_{:06}{}.png", frame, suffix)).string();
+    }
+
+    UniquePtr<FrameCapture> FrameCapture::create(const FrameCaptureDescriptor& descriptor) {
+        MemoryTagScope scope(MemoryTag::Rendering);
+        return UniquePtr<FrameCapture>(new FrameCapture(descriptor));
+    }
+
+    FrameCapture::FrameCapture(const FrameCaptureDescriptor& descriptor) : descriptor_(descriptor) {
+        if (descriptor_.RingSize == 0) {
+            descriptor_.RingSize = 1;
+        }
+        if (descriptor_.MaxEncodeJobs == 0) {
+            descriptor_.MaxEncodeJobs = 1;
+        }
+        // Every frame must be compared, a dropped frame would hide a failure
+        if (!descriptor_.GoldenDirectory.empty()) {
+            descriptor_.DropWhenBusy = false;
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(descriptor_.OutputDirectory, error);
+        if (error) {
+            auto logger = LogManager::getInstance().getLogger();
+            logger->error(std::format("Failed to create capture directory {}: {}",
+                                      descriptor_.OutputDirectory, error.message()));
+        }
+
+        slots_.resize(descriptor_.RingSize);
+        for (auto& slot : slots_) {
+            glGenBuffers(1, &slot.PixelBuffer);
+        }
+    }
+
+    FrameCapture::~FrameCapture() {
+        finish();
+        for (auto& slot : slots_) {
+            glDeleteBuffers(1, &slot.PixelBuffer);
+            MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Buffer, -static_cast<int64_t>(slot.Capacity));
+        }
+    }
+
+    void FrameCapture::captureFrame(uint32_t width, uint32_t height) {
+        ++framesRequested_;
+
+        // Reusing the oldest slot requires its frame to be delivered first
+        auto& slot = slots_[nextSlot_];
+        if (slot.Fence) {
+            ++ringStalls_;
+            deliver(slot, true);
+        }
+
+        size_t size = size_t(width) * height * 4;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PixelBuffer);
+        if (slot.Capacity < size) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+            MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Buffer,
+                                          static_cast<int64_t>(size) - static_cast<int64_t>(slot.Capacity));
+            slot.Capacity = size;
+        }
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height),
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.Frame = frame_++;
+        slot.Width = width;
+        slot.Height = height;
+        nextSlot_ = (nextSlot_ + 1) % slots_.size();
+
+        // Deliver finished frames oldest first so jobs are issued in frame order
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            auto& pending = slots_[(nextSlot_ + i) % slots_.size()];
+            if (pending.Fence && !deliver(pending, false)) {
+                break;
+            }
+        }
+    }
+
+    void FrameCapture::finish() {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            auto& pending = slots_[(nextSlot_ + i) % slots_.size()];
+            if (pending.Fence) {
+                deliver(pending, true);
+            }
+        }
+
+        for (auto& job : jobs_) {
+            job.get();
+        }
+        jobs_.clear();
+
+        std::lock_guard lock(rawMutex_);
+        if (rawFile_.is_open()) {
+            rawFile_.close();
+        }
+    }
+
+    bool FrameCapture::deliver(Slot& slot, bool wait) {
+        GLenum status = glClientWaitSync(slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? FenceWaitTimeoutNs : 0);
+        while (wait && status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(slot.Fence, 0, FenceWaitTimeoutNs);
+        }
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return false;
+        }
+
+        glDeleteSync(slot.Fence);
+        slot.Fence = nullptr;
+        if (status == GL_WAIT_FAILED) {
+            auto logger = LogManager::getInstance().getLogger();
+            logger->error(std::format("Waiting for the readback of frame {} failed", slot.Frame));
+            return true;
+        }
+
+        if (!reserveJob()) {
+            ++framesDropped_;
+            return true;
+        }
+
+        size_t size = size_t(slot.Width) * slot.Height * 4;
+        CapturedFrame frame{slot.Frame, slot.Width, slot.Height, acquireBuffer(size)};
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PixelBuffer);
+        auto data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT);
+        if (data) {
+            std::memcpy(frame.Pixels.data(), data, size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (!data) {
+            releaseBuffer(std::move(frame.Pixels));
+            return true;
+        }
+
+        ++framesDelivered_;
+        jobs_.push_back(JobSystem::getInstance().submit([this, frame = std::move(frame)]() mutable {
+            process(frame);
+        }));
+        return true;
+    }
+
+    bool FrameCapture::reserveJob() {
+        while (!jobs_.empty() && jobs_.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            jobs_.front().get();
+            jobs_.pop_front();
+        }
+
+        while (jobs_.size() >= descriptor_.MaxEncodeJobs) {
+            if (descriptor_.DropWhenBusy) {
+                return false;
+            }
+            ++encodeStalls_;
+            jobs_.front().get();
+            jobs_.pop_front();
+        }
+        return true;
+    }
+
+    void FrameCapture::process(CapturedFrame& frame) {
+        switch (descriptor_.Format) {
+            case CaptureFormat::Png:
+                if (writePng(getFramePath(descriptor_.OutputDirectory, frame.Frame),
+                             frame.Width, frame.Height, frame.Pixels.data(), true)) {
+                    ++framesWritten_;
+                } else {
+                    ++writeFailures_;
+                }
+                break;
+            case CaptureFormat::RawVideo:
+                writeRawFrame(frame);
+                break;
+            case CaptureFormat::None:
+                break;
+        }
+
+        if (!descriptor_.GoldenDirectory.empty()) {
+            compareWithGolden(frame);
+        }
+        releaseBuffer(std::move(frame.Pixels));
+    }
+
+    void FrameCapture::writeRawFrame(const CapturedFrame& frame) {
+        std::lock_guard lock(rawMutex_);
+        if (!rawFile_.is_open()) {
+            rawWidth_ = frame.Width;
+            rawHeight_ = frame.Height;
+            auto path = std::filesystem::path(descriptor_.OutputDirectory)
+                        / std::format("capture_{}x{}.rgba", rawWidth_, rawHeight_);
+            rawFile_.open(path, std::ios::binary | std::ios::trunc);
+        }
+
+        if (!rawFile_ || frame.Width != rawWidth_ || frame.Height != rawHeight_) {
+            ++writeFailures_;
+            return;
+        }
+
+        // Frames have a fixed size, so jobs finishing out of order still land in the right place
+        size_t rowBytes = size_t(frame.Width) * 4;
+        rawFile_.seekp(static_cast<std::streamoff>(frame.Frame * rowBytes * frame.Height));
+        for (uint32_t y = frame.Height; y > 0; --y) {
+            rawFile_.write(reinterpret_cast<const char*>(&frame.Pixels[(y - 1) * rowBytes]),
+                           static_cast<std::streamsize>(rowBytes));
+        }
+        ++framesWritten_;
+    }
+
+    void FrameCapture::compareWithGolden(const CapturedFrame& frame) {
+        auto logger = LogManager::getInstance().getLogger();
+        auto expected = readPng(getFramePath(descriptor_.GoldenDirectory, frame.Frame));
+        if (!expected) {
+            ++goldenFailed_;
+            logger->error(std::format("Golden image check of frame {} failed: {}", frame.Frame, expected.unwrap_err()));
+            return;
+        }
+
+        Image actual{frame.Width, frame.Height, acquireBuffer(frame.Pixels.size())};
+        size_t rowBytes = size_t(frame.Width) * 4;
+        for (uint32_t y = 0; y < frame.Height; ++y) {
+            std::memcpy(&actual.Pixels[y * rowBytes], &frame.Pixels[(frame.Height - 1 - y) * rowBytes], rowBytes);
+        }
+
+        auto difference = compareImages(actual, expected.unwrap(), descriptor_.GoldenTolerance);
+        if (!difference.SizeMismatch && difference.MismatchRatio <= descriptor_.GoldenMaxMismatchRatio) {
+            ++goldenPassed_;
+        } else {
+            ++goldenFailed_;
+            logger->error(std::format("Frame {} differs from its golden image: {} pixels ({:.4f}%), max delta {}{}",
+                                      frame.Frame, difference.MismatchedPixels, difference.MismatchRatio * 100.0f,
+                                      difference.MaxChannelDelta, difference.SizeMismatch ? ", size mismatch" : ""));
+            writePng(getFramePath(descriptor_.OutputDirectory, frame.Frame, "_actual"),
+                     actual.Width, actual.Height, actual.Pixels.data(), false);
+        }
+        releaseBuffer(std::move(actual.Pixels));
+    }
+
+    std::vector<uint8_t> FrameCapture::acquireBuffer(size_t size) {
+        std::vector<uint8_t> buffer;
+        {
+            std::lock_guard lock(bufferMutex_);
+            if (!freeBuffers_.empty()) {
+                buffer = std::move(freeBuffers_.back());
+                freeBuffers_.pop_back();
+            }
+        }
+        buffer.resize(size);
+        return buffer;
+    }
+
+    void FrameCapture::releaseBuffer(std::vector<uint8_t> buffer) {
+        std::lock_guard lock(bufferMutex_);
+        freeBuffers_.push_back(std::move(buffer));
+    }
+
+    FrameCaptureStats FrameCapture::getStats() const {
+        FrameCaptureStats stats;
+        stats.FramesRequested = framesRequested_.load();
+        stats.FramesDelivered = framesDelivered_.load();
+        stats.FramesWritten = framesWritten_.load();
+        stats.WriteFailures = writeFailures_.load();
+        stats.RingStalls = ringStalls_.load();
+        stats.EncodeStalls = encodeStalls_.load();
+        stats.FramesDropped = framesDropped_.load();
+        stats.GoldenPassed = goldenPassed_.load();
+        stats.GoldenFailed = goldenFailed_.load();
+        return stats;
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <vector>
+#include <glad/glad.h>
+#include "../triharder.h"
+
+namespace TriHarder {
+
+    //! How captured frames are written to disk.
+    enum class CaptureFormat {
+        None, //!< Frames are only compared against golden images.
+        Png, //!< One PNG file per frame.
+        RawVideo, //!< All frames appended to a single raw RGBA file, e.g. for ffmpeg -f rawvideo.
+    };
+
+    //! @struct FrameCaptureDescriptor
+    //! @brief Configures where captured frames go and how they are verified.
+    struct FrameCaptureDescriptor {
+        String OutputDirectory = "captures";
+        CaptureFormat Format = CaptureFormat::Png;
+        String GoldenDirectory; //!< Compares every frame against frame_NNNNNN.png in this directory if set.
+        uint8_t GoldenTolerance = 2; //!< Largest per-channel difference that counts as equal.
+        float GoldenMaxMismatchRatio = 0.001f; //!< Fraction of differing pixels a frame may have and still pass.
+        uint32_t RingSize = 3; //!< Number of frames in flight between readback and delivery.
+        uint32_t MaxEncodeJobs = 4; //!< Number of delivered frames being encoded or compared at once.
+        bool DropWhenBusy = false; //!< Drops frames instead of waiting when MaxEncodeJobs are busy, ignored with golden images.
+    };
+
+    //! @struct FrameCaptureStats
+    //! @brief Counters of the capture service, safe to read while capturing.
+    struct FrameCaptureStats {
+        uint64_t FramesRequested = 0;
+        uint64_t FramesDelivered = 0; //!< Frames mapped back to the CPU.
+        uint64_t FramesWritten = 0;
+        uint64_t WriteFailures = 0;
+        uint64_t RingStalls = 0; //!< Frames where the oldest readback had to be waited for.
+        uint64_t EncodeStalls = 0; //!< Frames where the oldest encoding job had to be waited for.
+        uint64_t FramesDropped = 0; //!< Frames dropped because every encoding job was busy.
+        uint64_t GoldenPassed = 0;
+        uint64_t GoldenFailed = 0;
+    };
+
+    //! @class FrameCapture
+    //! @brief Reads back rendered frames without stalling the pipeline.
+    //!
+    //! captureFrame() copies the current read framebuffer into a pixel buffer object and
+    //! fences it. The pixels are mapped a few frames later once the fence has signalled,
+    //! so the GPU never has to drain for the CPU. Encoding, writing and golden image
+    //! comparison run as jobs on the JobSystem. If every slot of the ring is still in
+    //! flight the oldest frame is waited for. At most MaxEncodeJobs frames are encoded at
+    //! once, which bounds the memory held by pending frames when encoding is slower than
+    //! rendering; beyond that the oldest job is waited for, or the frame is dropped.
+    class FrameCapture {
+    public:
+        //! Creates the capture service, the output directory is created if needed.
+        //! Requires a current OpenGL context.
+        static UniquePtr<FrameCapture> create(const FrameCaptureDescriptor& descriptor);
+
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        //! Queues the readback of the current read framebuffer. Call after rendering and
+        //! before swapping buffers. Completed earlier frames are delivered as a side effect.
+        void captureFrame(uint32_t width, uint32_t height);
+
+        //! Delivers every outstanding frame and waits for all encoding jobs.
+        void finish();
+
+        [[nodiscard]] FrameCaptureStats getStats() const;
+
+        [[nodiscard]] const FrameCaptureDescriptor& getDescriptor() const { return descriptor_; }
+
+    private:
+        struct Slot {
+            GLuint PixelBuffer = 0;
+            GLsync Fence = nullptr;
+            size_t Capacity = 0;
+            uint64_t Frame = 0;
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+        };
+
+        struct CapturedFrame {
+            uint64_t Frame;
+            uint32_t Width;
+            uint32_t Height;
+            std::vector<uint8_t> Pixels; //!< Bottom row first, as read by glReadPixels.
+        };
+
+        explicit FrameCapture(const FrameCaptureDescriptor& descriptor);
+
+        bool deliver(Slot& slot, bool wait);
+        bool reserveJob();
+        void process(CapturedFrame& frame);
+        void writeRawFrame(const CapturedFrame& frame);
+        void compareWithGolden(const CapturedFrame& frame);
+
+        std::vector<uint8_t> acquireBuffer(size_t size);
+        void releaseBuffer(std::vector<uint8_t> buffer);
+
+        FrameCaptureDescriptor descriptor_;
+        std::vector<Slot> slots_;
+        size_t nextSlot_ = 0;
+        uint64_t frame_ = 0;
+        std::deque<std::future<void>> jobs_;
+
+        std::mutex bufferMutex_;
+        std::vector<std::vector<uint8_t>> freeBuffers_;
+
+        std::mutex rawMutex_;
+        std::ofstream rawFile_;
+        uint32_t rawWidth_ = 0;
+        uint32_t rawHeight_ = 0;
+
+        std::atomic<uint64_t> framesRequested_ = 0;
+        std::atomic<uint64_t> framesDelivered_ = 0;
+        std::atomic<uint64_t> framesWritten_ = 0;
+        std::atomic<uint64_t> writeFailures_ = 0;
+        std::atomic<uint64_t> ringStalls_ = 0;
+        std::atomic<uint64_t> encodeStalls_ = 0;
+        std::atomic<uint64_t> framesDropped_ = 0;
+        std::atomic<uint64_t> goldenPassed_ = 0;
+        std::atomic<uint64_t> goldenFailed_ = 0;
+    };
+}
@@ -0,0 +1,143 @@
+#include "glyph_atlas.h"
+#include <algorithm>
+#include <bit>
+#include "../core/memory_tracker.h"
+
+namespace TriHarder {
+
+    GlyphAtlas::GlyphAtlas(uint32_t pageSize, uint32_t maxPages)
+        : pageSize_(pageSize), maxPages_(std::clamp(maxPages, 1u, MaxPageLimit)) {
+    }
+
+    GlyphAtlas::~GlyphAtlas() {
+        for (auto& page : pages_) {
+            glDeleteTextures(1, &page.Texture);
+        }
+        MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Texture,
+                                      -static_cast<int64_t>(pages_.size() * pageSize_ * pageSize_));
+    }
+
+    const AtlasGlyph* GlyphAtlas::getGlyph(const Font& font, uint32_t glyphIndex) {
+        auto key = makeKey(font.getId(), glyphIndex);
+        auto it = glyphs_.find(key);
+        if (it != glyphs_.end()) {
+            // Whitespace has no page, it must neither index pages_ nor keep page 0 alive
+            if (it->second.Width > 0.0f) {
+                pages_[it->second.Page].LastUsedFrame = frame_;
+            }
+            return &it->second;
+        }
+
+        if (!font.rasterize(glyphIndex, scratch_)) {
+            return nullptr;
+        }
+
+        AtlasGlyph glyph;
+        glyph.Width = static_cast<float>(scratch_.Width);
+        glyph.Height = static_cast<float>(scratch_.Height);
+        glyph.BearingX = static_cast<float>(scratch_.BearingX);
+        glyph.BearingY = static_cast<float>(scratch_.BearingY);
+        glyph.Advance = scratch_.Advance;
+
+        // Whitespace has no bitmap and only contributes its advance
+        if (scratch_.Width > 0 && scratch_.Height > 0) {
+            auto allocation = allocate(scratch_.Width, scratch_.Height);
+            if (!allocation) {
+                return nullptr;
+            }
+
+            auto [pageIndex, rect] = *allocation;
+            auto& page = pages_[pageIndex];
+            glBindTexture(GL_TEXTURE_2D, page.Texture);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, (GLint)rect.X, (GLint)rect.Y, (GLsizei)rect.Width, (GLsizei)rect.Height,
+                            GL_RED, GL_UNSIGNED_BYTE, scratch_.Pixels.data());
+
+            float scale = 1.0f / static_cast<float>(pageSize_);
+            glyph.Page = static_cast<uint16_t>(pageIndex);
+            glyph.U0 = static_cast<float>(rect.X) * scale;
+            glyph.V0 = static_cast<float>(rect.Y) * scale;
+            glyph.U1 = static_cast<float>(rect.X + rect.Width) * scale;
+            glyph.V1 = static_cast<float>(rect.Y + rect.Height) * scale;
+            page.LastUsedFrame = frame_;
+        }
+
+        return &glyphs_.emplace(key, glyph).first->second;
+    }
+
+    void GlyphAtlas::touchPages(uint32_t pageMask) {
+        while (pageMask) {
+            auto page = static_cast<size_t>(std::countr_zero(pageMask));
+            pages_[page].LastUsedFrame = frame_;
+            pageMask &= pageMask - 1;
+        }
+    }
+
+    std::optional<std::pair<size_t, PackedRect>> GlyphAtlas::allocate(uint32_t width, uint32_t height) {
+        if (width > pageSize_ || height > pageSize_) {
+            return std::nullopt;
+        }
+
+        // Newest pages are the most likely to still have room
+        for (size_t i = pages_.size(); i-- > 0;) {
+            if (auto rect = pages_[i].Packer.insert(width, height)) {
+                return std::make_pair(i, *rect);
+            }
+        }
+
+        if (pages_.size() < maxPages_) {
+            size_t page = addPage();
+            if (auto rect = pages_[page].Packer.insert(width, height)) {
+                return std::make_pair(page, *rect);
+            }
+            return std::nullopt;
+        }
+
+        if (!evictPage()) {
+            return std::nullopt;
+        }
+        return allocate(width, height);
+    }
+
+    size_t GlyphAtlas::addPage() {
+        Page page{0, SkylinePacker(pageSize_, pageSize_), frame_};
+        glGenTextures(1, &page.Texture);
+        glBindTexture(GL_TEXTURE_2D, page.Texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, (GLsizei)pageSize_, (GLsizei)pageSize_, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        pages_.push_back(std::move(page));
+        MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Texture, int64_t(pageSize_) * pageSize_);
+        return pages_.size() - 1;
+    }
+
+    bool GlyphAtlas::evictPage() {
+        auto lru = std::min_element(pages_.begin(), pages_.end(), [](const Page& lhs, const Page& rhs) {
+            return lhs.LastUsedFrame < rhs.LastUsedFrame;
+        });
+
+        // Glyphs of the current frame may already be queued for drawing
+        if (lru == pages_.end() || lru->LastUsedFrame == frame_) {
+            return false;
+        }
+
+        auto pageIndex = static_cast<uint16_t>(lru - pages_.begin());
+        std::erase_if(glyphs_, [pageIndex](const auto& entry) {
+            return entry.second.Page == pageIndex && entry.second.Width > 0.0f;
+        });
+
+        // Clear the texture so stale texels cannot bleed into the padding of new glyphs
+        std::vector<uint8_t> zeros(size_t(pageSize_) * pageSize_, 0);
+        glBindTexture(GL_TEXTURE_2D, lru->Texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei)pageSize_, (GLsizei)pageSize_, GL_RED, GL_UNSIGNED_BYTE, zeros.data());
+
+        lru->Packer.reset();
+        lru->LastUsedFrame = frame_;
+        epoch_++;
+        evictions_++;
+        return true;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <glad/glad.h>
+#include "font.h"
+#include "skyline_packer.h"
+
+namespace TriHarder {
+
+    //! @struct AtlasGlyph
+    //! @brief Location and metrics of a glyph stored in the atlas.
+    struct AtlasGlyph {
+        uint16_t Page = 0;
+        float U0 = 0.0f, V0 = 0.0f, U1 = 0.0f, V1 = 0.0f;
+        float Width = 0.0f;
+        float Height = 0.0f;
+        float BearingX = 0.0f;
+        float BearingY = 0.0f;
+        float Advance = 0.0f;
+    };
+
+    //! @class GlyphAtlas
+    //! @brief Caches rasterized glyphs in single channel textures (pages).
+    //!
+    //! Every page is packed with a SkylinePacker. When all pages are full the least
+    //! recently used page that has not been used in the current frame is cleared and
+    //! repacked. Every eviction increments the epoch, so caches holding atlas
+    //! coordinates can detect stale entries with a single compare.
+    class GlyphAtlas {
+    public:
+        explicit GlyphAtlas(uint32_t pageSize = 1024, uint32_t maxPages = 4);
+        ~GlyphAtlas();
+
+        GlyphAtlas(const GlyphAtlas&) = delete;
+        GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+        //! Advances the frame counter used for LRU eviction.
+        void beginFrame() { frame_++; }
+
+        //! Returns the glyph, rasterizing and uploading it on a cache miss.
+        //! @return The glyph or nullptr if it could not be rasterized or placed.
+        const AtlasGlyph* getGlyph(const Font& font, uint32_t glyphIndex);
+
+        //! Marks pages as used in the current frame, one bit per page.
+        void touchPages(uint32_t pageMask);
+
+        [[nodiscard]] uint64_t getEpoch() const { return epoch_; }
+        [[nodiscard]] size_t getPageCount() const { return pages_.size(); }
+        [[nodiscard]] GLuint getPageTexture(size_t page) const { return pages_[page].Texture; }
+        [[nodiscard]] size_t getGlyphCount() const { return glyphs_.size(); }
+        [[nodiscard]] uint64_t getEvictionCount() const { return evictions_; }
+
+        static constexpr uint32_t MaxPageLimit = 32;
+
+    private:
+        struct Page {
+            GLuint Texture = 0;
+            SkylinePacker Packer;
+            uint64_t LastUsedFrame = 0;
+        };
+
+        uint32_t pageSize_;
+        uint32_t maxPages_;
+        uint64_t frame_ = 0;
+        uint64_t epoch_ = 0;
+        uint64_t evictions_ = 0;
+        std::vector<Page> pages_;
+        std::unordered_map<uint64_t, AtlasGlyph> glyphs_;
+        GlyphBitmap scratch_;
+
+        static uint64_t makeKey(uint32_t fontId, uint32_t glyphIndex) {
+            return (uint64_t(fontId) << 32) | glyphIndex;
+        }
+
+        std::optional<std::pair<size_t, PackedRect>> allocate(uint32_t width, uint32_t height);
+        size_t addPage();
+        bool evictPage();
+    };
+}
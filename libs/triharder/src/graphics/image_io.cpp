@@ -0,0 +1,267 @@
+#include "image_io.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include "../core/memory_tracker.h"
+
+namespace TriHarder {
+
+    static constexpr uint8_t PngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    static constexpr size_t MaxStoredBlock = 65535;
+    static constexpr uint32_t MaxDimension = 16384;
+
+    static const std::array<uint32_t, 256>& getCrcTable() {
+        static const auto table = []() {
+            std::array<uint32_t, 256> result{};
+            for (uint32_t n = 0; n < 256; ++n) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                result[n] = c;
+            }
+            return result;
+        }();
+        return table;
+    }
+
+    static uint32_t updateCrc(uint32_t crc, const uint8_t* data, size_t size) {
+        const auto& table = getCrcTable();
+        for (size_t i = 0; i < size; ++i) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    //! Incremental Adler-32 as required by the zlib stream.
+    struct Adler32 {
+        uint32_t A = 1;
+        uint32_t B = 0;
+
+        void update(const uint8_t* data, size_t size) {
+            // 5552 is the largest block for which the sums cannot overflow before the modulo
+            while (size > 0) {
+                size_t block = std::min<size_t>(size, 5552);
+                for (size_t i = 0; i < block; ++i) {
+                    A += data[i];
+                    B += A;
+                }
+                A %= 65521;
+                B %= 65521;
+                data += block;
+                size -= block;
+            }
+        }
+
+        [[nodiscard]] uint32_t value() const { return (B << 16) | A; }
+    };
+
+    static void appendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static uint32_t readBigEndian(const uint8_t* data) {
+        return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+    }
+
+    static void writeChunk(std::ofstream& file, const char* type, const uint8_t* data, size_t size) {
+        std::vector<uint8_t> header;
+        appendBigEndian(header, static_cast<uint32_t>(size));
+        header.insert(header.end(), type, type + 4);
+        file.write(reinterpret_cast<const char*>(header.data()), 8);
+        file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+
+        uint32_t crc = updateCrc(0xFFFFFFFFu, reinterpret_cast<const uint8_t*>(type), 4);
+        crc = updateCrc(crc, data, size) ^ 0xFFFFFFFFu;
+        std::vector<uint8_t> footer;
+        appendBigEndian(footer, crc);
+        file.write(reinterpret_cast<const char*>(footer.data()), 4);
+    }
+
+    bool writePng(const String& path, uint32_t width, uint32_t height, const uint8_t* pixels, bool bottomUp) {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(PngSignature), sizeof(PngSignature));
+
+        std::vector<uint8_t> header;
+        appendBigEndian(header, width);
+        appendBigEndian(header, height);
+        header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bit, RGBA, deflate, adaptive filters, no interlace
+        writeChunk(file, "IHDR", header.data(), header.size());
+
+        // Raw scanlines: filter byte 0 followed by the row
+        size_t rowBytes = size_t(width) * 4;
+        size_t rawSize = (rowBytes + 1) * height;
+        size_t blockCount = std::max<size_t>(1, (rawSize + MaxStoredBlock - 1) / MaxStoredBlock);
+
+        std::vector<uint8_t> stream;
+        stream.reserve(2 + rawSize + blockCount * 5 + 4);
+        stream.push_back(0x78);
+        stream.push_back(0x01);
+
+        Adler32 adler;
+        size_t blockRemaining = 0;
+        size_t written = 0;
+        auto emit = [&](const uint8_t* data, size_t size) {
+            while (size > 0) {
+                if (blockRemaining == 0) {
+                    size_t blockSize = std::min(MaxStoredBlock, rawSize - written);
+                    bool last = written + blockSize == rawSize;
+                    stream.push_back(last ? 1 : 0);
+                    stream.push_back(static_cast<uint8_t>(blockSize));
+                    stream.push_back(static_cast<uint8_t>(blockSize >> 8));
+                    stream.push_back(static_cast<uint8_t>(~blockSize));
+                    stream.push_back(static_cast<uint8_t>(~blockSize >> 8));
+                    blockRemaining = blockSize;
+                }
+                size_t chunk = std::min(size, blockRemaining);
+                stream.insert(stream.end(), data, data + chunk);
+                adler.update(data, chunk);
+                data += chunk;
+                size -= chunk;
+                blockRemaining -= chunk;
+                written += chunk;
+            }
+        };
+
+        const uint8_t filter = 0;
+        for (uint32_t y = 0; y < height; ++y) {
+            uint32_t sourceRow = bottomUp ? height - 1 - y : y;
+            emit(&filter, 1);
+            emit(pixels + sourceRow * rowBytes, rowBytes);
+        }
+        appendBigEndian(stream, adler.value());
+
+        writeChunk(file, "IDAT", stream.data(), stream.size());
+        writeChunk(file, "IEND", nullptr, 0);
+        return static_cast<bool>(file);
+    }
+
+    Result<Image> readPng(const String& path) {
+        MemoryTagScope scope(MemoryTag::Assets);
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return Result<Image>::error("Failed to open " + path);
+        }
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (data.size() < 8 || std::memcmp(data.data(), PngSignature, 8) != 0) {
+            return Result<Image>::error("Not a PNG file: " + path);
+        }
+
+        Image image;
+        bool hasHeader = false;
+        std::vector<uint8_t> stream;
+        for (size_t offset = 8; offset + 12 <= data.size();) {
+            uint32_t length = readBigEndian(&data[offset]);
+            const char* type = reinterpret_cast<const char*>(&data[offset + 4]);
+            const uint8_t* chunk = &data[offset + 8];
+            if (length > data.size() - offset - 12) {
+                return Result<Image>::error("Truncated PNG file: " + path);
+            }
+
+            if (std::memcmp(type, "IHDR", 4) == 0) {
+                if (hasHeader || length < 13) {
+                    return Result<Image>::error("Invalid PNG header: " + path);
+                }
+                hasHeader = true;
+                image.Width = readBigEndian(chunk);
+                image.Height = readBigEndian(chunk + 4);
+                if (image.Width == 0 || image.Height == 0 || image.Width > MaxDimension || image.Height > MaxDimension) {
+                    return Result<Image>::error(std::format("Unsupported PNG size {}x{}: {}", image.Width, image.Height, path));
+                }
+                if (chunk[8] != 8 || chunk[9] != 6 || chunk[12] != 0) {
+                    return Result<Image>::error("Only 8-bit non-interlaced RGBA PNG files are supported: " + path);
+                }
+            } else if (std::memcmp(type, "IDAT", 4) == 0) {
+                if (!hasHeader) {
+                    return Result<Image>::error("PNG image data before the header: " + path);
+                }
+                stream.insert(stream.end(), chunk, chunk + length);
+            }
+            offset += 12 + length;
+        }
+        if (!hasHeader) {
+            return Result<Image>::error("Missing PNG header: " + path);
+        }
+
+        // Stored blocks never shrink the data, so a short stream cannot hold the image
+        size_t rowBytes = size_t(image.Width) * 4;
+        size_t rawSize = (rowBytes + 1) * image.Height;
+        if (rawSize > stream.size()) {
+            return Result<Image>::error("Truncated image data: " + path);
+        }
+
+        // Walk the stored deflate blocks behind the two byte zlib header
+        std::vector<uint8_t> raw;
+        raw.reserve(rawSize);
+        size_t position = 2;
+        bool last = false;
+        while (!last) {
+            if (position + 5 > stream.size()) {
+                return Result<Image>::error("Truncated image data: " + path);
+            }
+            uint8_t blockHeader = stream[position];
+            if ((blockHeader >> 1) != 0) {
+                return Result<Image>::error("Compressed PNG data is not supported, re-record the image: " + path);
+            }
+            last = blockHeader & 1;
+            size_t size = stream[position + 1] | (size_t(stream[position + 2]) << 8);
+            position += 5;
+            if (position + size > stream.size()) {
+                return Result<Image>::error("Truncated image data: " + path);
+            }
+            raw.insert(raw.end(), stream.begin() + static_cast<std::ptrdiff_t>(position),
+                       stream.begin() + static_cast<std::ptrdiff_t>(position + size));
+            position += size;
+        }
+
+        if (raw.size() != rawSize) {
+            return Result<Image>::error("Unexpected image data size: " + path);
+        }
+
+        image.Pixels.resize(rowBytes * image.Height);
+        for (uint32_t y = 0; y < image.Height; ++y) {
+            const uint8_t* row = &raw[y * (rowBytes + 1)];
+            if (row[0] != 0) {
+                return Result<Image>::error("Filtered PNG rows are not supported: " + path);
+            }
+            std::memcpy(&image.Pixels[y * rowBytes], row + 1, rowBytes);
+        }
+        return Result<Image>::ok(std::move(image));
+    }
+
+    ImageDifference compareImages(const Image& actual, const Image& expected, uint8_t tolerance) {
+        ImageDifference difference;
+        if (actual.Width != expected.Width || actual.Height != expected.Height
+            || actual.Pixels.size() != expected.Pixels.size()) {
+            difference.SizeMismatch = true;
+            difference.MismatchRatio = 1.0f;
+            return difference;
+        }
+
+        for (size_t i = 0; i < actual.Pixels.size(); i += 4) {
+            uint8_t pixelDelta = 0;
+            for (size_t c = 0; c < 4; ++c) {
+                int delta = std::abs(int(actual.Pixels[i + c]) - int(expected.Pixels[i + c]));
+                pixelDelta = std::max(pixelDelta, static_cast<uint8_t>(delta));
+            }
+            difference.MaxChannelDelta = std::max(difference.MaxChannelDelta, pixelDelta);
+            if (pixelDelta > tolerance) {
+                ++difference.MismatchedPixels;
+            }
+        }
+
+        size_t pixelCount = actual.Pixels.size() / 4;
+        difference.MismatchRatio = pixelCount > 0 ? float(difference.MismatchedPixels) / float(pixelCount) : 0.0f;
+        return difference;
+    }
+}
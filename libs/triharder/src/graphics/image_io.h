@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../triharder.h"
+#include "../core/result.h"
+
+namespace TriHarder {
+
+    //! @struct Image
+    //! @brief An 8-bit RGBA image stored top row first.
+    struct Image {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        std::vector<uint8_t> Pixels;
+    };
+
+    //! @struct ImageDifference
+    //! @brief Result of comparing two images pixel by pixel.
+    struct ImageDifference {
+        bool SizeMismatch = false;
+        uint64_t MismatchedPixels = 0; //!< Pixels with at least one channel beyond the tolerance.
+        uint8_t MaxChannelDelta = 0;
+        float MismatchRatio = 0.0f;
+    };
+
+    //! Compares two images channel by channel.
+    //! @param tolerance Largest per-channel difference that still counts as equal.
+    ImageDifference compareImages(const Image& actual, const Image& expected, uint8_t tolerance);
+
+    //! Writes RGBA pixels as PNG.
+    //!
+    //! The image data is stored with uncompressed deflate blocks: encoding is bound by
+    //! memory bandwidth instead of compression, which keeps capture workers ahead of
+    //! the frame rate at the cost of larger files.
+    //!
+    //! @param path Destination file.
+    //! @param width Width in pixels.
+    //! @param height Height in pixels.
+    //! @param pixels RGBA pixels, rows tightly packed.
+    //! @param bottomUp True if the first row in memory is the bottom row, as returned by glReadPixels.
+    //! @return True if the file has been written.
+    bool writePng(const String& path, uint32_t width, uint32_t height, const uint8_t* pixels, bool bottomUp);
+
+    //! Reads an RGBA PNG written by writePng().
+    //! Only stored (uncompressed) deflate blocks and filter type 0 are supported.
+    //! @return The image or an error message.
+    Result<Image> readPng(const String& path);
+}
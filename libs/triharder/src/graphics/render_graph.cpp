@@ -0,0 +1,339 @@
+#include "render_graph.h"
+#include "../core/logging.h"
+#include <algorithm>
+
+namespace TriHarder {
+
+    GLuint RenderPassContext::getTexture(RenderResource resource) const {
+        return graph_.resources_[resource].Texture;
+    }
+
+    const RenderTextureDesc& RenderPassContext::getDesc(RenderResource resource) const {
+        return graph_.resources_[resource].Desc;
+    }
+
+    RenderResource RenderGraph::PassBuilder::create(StringId name, const RenderTextureDesc& desc) {
+        graph_.resources_.push_back({name, desc});
+        return static_cast<RenderResource>(graph_.resources_.size() - 1);
+    }
+
+    RenderResource RenderGraph::PassBuilder::read(RenderResource resource) {
+        graph_.passes_[pass_].Reads.push_back(resource);
+        return resource;
+    }
+
+    RenderResource RenderGraph::PassBuilder::write(RenderResource resource, LoadOp loadOp, std::array<float, 4> clearColor) {
+        graph_.passes_[pass_].Writes.push_back({resource, loadOp, clearColor});
+        return resource;
+    }
+
+    void RenderGraph::PassBuilder::setSideEffect() {
+        graph_.passes_[pass_].SideEffect = true;
+    }
+
+    void RenderGraph::reset() {
+        passes_.clear();
+        resources_.clear();
+        physical_.clear();
+        stats_ = RenderGraphStats();
+        compiled_ = false;
+    }
+
+    RenderResource RenderGraph::importBackbuffer(uint32_t width, uint32_t height) {
+        Resource resource{"backbuffer", {width, height, GL_RGBA8}};
+        resource.Imported = true;
+        resource.Backbuffer = true;
+        resources_.push_back(resource);
+        return static_cast<RenderResource>(resources_.size() - 1);
+    }
+
+    RenderResource RenderGraph::importTexture(StringId name, GLuint texture, const RenderTextureDesc& desc) {
+        Resource resource{name, desc};
+        resource.Imported = true;
+        resource.Texture = texture;
+        resources_.push_back(resource);
+        return static_cast<RenderResource>(resources_.size() - 1);
+    }
+
+    void RenderGraph::addPass(StringId name, const SetupFunction& setup, ExecuteFunction execute) {
+        Pass pass;
+        pass.Name = name;
+        pass.Execute = std::move(execute);
+        passes_.push_back(std::move(pass));
+        PassBuilder builder(*this, static_cast<uint32_t>(passes_.size() - 1));
+        setup(builder);
+        compiled_ = false;
+    }
+
+    bool RenderGraph::isPassCulled(StringId name) const {
+        auto it = std::find_if(passes_.begin(), passes_.end(), [name](const Pass& pass) { return pass.Name == name; });
+        return it != passes_.end() && it->Culled;
+    }
+
+    void RenderGraph::compile() {
+        stats_ = RenderGraphStats();
+        stats_.Passes = static_cast<uint32_t>(passes_.size());
+        cullPasses();
+        computeLifetimes();
+        aliasResources();
+        compiled_ = true;
+    }
+
+    void RenderGraph::cullPasses() {
+        // Walk backwards from the passes with visible results to everything they depend on
+        std::vector<uint32_t> worklist;
+        for (uint32_t i = 0; i < passes_.size(); ++i) {
+            auto& pass = passes_[i];
+            pass.Culled = true;
+            pass.InvalidateAfter.clear();
+            bool writesImported = std::any_of(pass.Writes.begin(), pass.Writes.end(), [this](const Write& write) {
+                return resources_[write.Resource].Imported;
+            });
+            if (pass.SideEffect || writesImported) {
+                pass.Culled = false;
+                worklist.push_back(i);
+            }
+        }
+
+        while (!worklist.empty()) {
+            uint32_t consumer = worklist.back();
+            worklist.pop_back();
+
+            std::vector<RenderResource> dependencies = passes_[consumer].Reads;
+            for (const auto& write : passes_[consumer].Writes) {
+                if (write.Load == LoadOp::Load) {
+                    dependencies.push_back(write.Resource);
+                }
+            }
+
+            for (uint32_t producer = 0; producer < consumer; ++producer) {
+                auto& pass = passes_[producer];
+                if (!pass.Culled) {
+                    continue;
+                }
+                bool writesDependency = std::any_of(pass.Writes.begin(), pass.Writes.end(), [&](const Write& write) {
+                    return std::find(dependencies.begin(), dependencies.end(), write.Resource) != dependencies.end();
+                });
+                if (writesDependency) {
+                    pass.Culled = false;
+                    worklist.push_back(producer);
+                }
+            }
+        }
+
+        stats_.CulledPasses = static_cast<uint32_t>(std::count_if(passes_.begin(), passes_.end(), [](const Pass& pass) {
+            return pass.Culled;
+        }));
+    }
+
+    void RenderGraph::computeLifetimes() {
+        for (auto& resource : resources_) {
+            resource.FirstPass = -1;
+            resource.LastPass = -1;
+            resource.PhysicalSlot = -1;
+        }
+
+        auto use = [this](RenderResource handle, int32_t pass) {
+            auto& resource = resources_[handle];
+            if (resource.FirstPass < 0) {
+                resource.FirstPass = pass;
+            }
+            resource.LastPass = pass;
+        };
+
+        for (int32_t i = 0; i < static_cast<int32_t>(passes_.size()); ++i) {
+            auto& pass = passes_[i];
+            if (pass.Culled) {
+                continue;
+            }
+            for (auto read : pass.Reads) {
+                use(read, i);
+            }
+            for (auto& write : pass.Writes) {
+                auto& resource = resources_[write.Resource];
+
+                // A transient texture has no defined contents before its first write,
+                // loading them would only cost bandwidth
+                if (!resource.Imported && resource.FirstPass < 0 && write.Load == LoadOp::Load) {
+                    write.Load = LoadOp::DontCare;
+                }
+                use(write.Resource, i);
+
+                if (write.Load == LoadOp::Clear) {
+                    stats_.Clears++;
+                } else if (write.Load == LoadOp::DontCare) {
+                    stats_.Invalidations++;
+                }
+            }
+        }
+
+        // Contents of transient textures are dead after their last use
+        for (RenderResource handle = 0; handle < resources_.size(); ++handle) {
+            const auto& resource = resources_[handle];
+            if (!resource.Imported && resource.LastPass >= 0) {
+                passes_[resource.LastPass].InvalidateAfter.push_back(handle);
+                stats_.Invalidations++;
+            }
+        }
+    }
+
+    void RenderGraph::aliasResources() {
+        physical_.clear();
+
+        std::vector<RenderResource> transients;
+        for (RenderResource handle = 0; handle < resources_.size(); ++handle) {
+            if (!resources_[handle].Imported && resources_[handle].FirstPass >= 0) {
+                transients.push_back(handle);
+            }
+        }
+        std::sort(transients.begin(), transients.end(), [this](RenderResource lhs, RenderResource rhs) {
+            return resources_[lhs].FirstPass < resources_[rhs].FirstPass;
+        });
+
+        // Greedy interval assignment: reuse a texture of the same description whose last user ran earlier
+        for (auto handle : transients) {
+            auto& resource = resources_[handle];
+            stats_.TransientBytesWithoutAliasing += estimateTextureBytes(resource.Desc);
+
+            auto slot = std::find_if(physical_.begin(), physical_.end(), [&resource](const PhysicalTexture& texture) {
+                return texture.Desc == resource.Desc && texture.LastPass < resource.FirstPass;
+            });
+            if (slot == physical_.end()) {
+                physical_.push_back({resource.Desc, resource.LastPass, 0});
+                resource.PhysicalSlot = static_cast<int32_t>(physical_.size() - 1);
+                stats_.TransientBytesWithAliasing += estimateTextureBytes(resource.Desc);
+            } else {
+                slot->LastPass = resource.LastPass;
+                resource.PhysicalSlot = static_cast<int32_t>(slot - physical_.begin());
+            }
+        }
+
+        stats_.TransientResources = static_cast<uint32_t>(transients.size());
+        stats_.PhysicalTextures = static_cast<uint32_t>(physical_.size());
+    }
+
+    bool RenderGraph::canInvalidate() const {
+        return GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_invalidate_subdata;
+    }
+
+    void RenderGraph::bindPassTargets(const Pass& pass, RenderTargetPool& pool) {
+        std::vector<GLuint> colorAttachments;
+        GLuint depthAttachment = 0;
+        const RenderTextureDesc* size = nullptr;
+        bool backbuffer = false;
+        for (const auto& write : pass.Writes) {
+            const auto& resource = resources_[write.Resource];
+            size = &resource.Desc;
+            if (resource.Backbuffer) {
+                backbuffer = true;
+            } else if (isDepthFormat(resource.Desc.Format)) {
+                depthAttachment = resource.Texture;
+            } else {
+                colorAttachments.push_back(resource.Texture);
+            }
+        }
+
+        GLuint framebuffer = backbuffer ? 0 : pool.getFramebuffer(colorAttachments, depthAttachment);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        if (size) {
+            glViewport(0, 0, (GLsizei)size->Width, (GLsizei)size->Height);
+        }
+    }
+
+    void RenderGraph::invalidateAttachments(const Pass& pass, const std::vector<RenderResource>& resources) {
+        if (resources.empty() || !canInvalidate()) {
+            return;
+        }
+
+        std::vector<GLenum> attachments;
+        GLenum colorIndex = 0;
+        for (const auto& write : pass.Writes) {
+            const auto& resource = resources_[write.Resource];
+            bool depth = isDepthFormat(resource.Desc.Format);
+            bool invalidate = std::find(resources.begin(), resources.end(), write.Resource) != resources.end();
+            if (invalidate) {
+                if (resource.Backbuffer) {
+                    attachments.push_back(GL_COLOR);
+                } else if (depth) {
+                    attachments.push_back(GL_DEPTH_ATTACHMENT);
+                } else {
+                    attachments.push_back(GL_COLOR_ATTACHMENT0 + colorIndex);
+                }
+            }
+            if (!depth && !resource.Backbuffer) {
+                colorIndex++;
+            }
+        }
+        if (!attachments.empty()) {
+            glInvalidateFramebuffer(GL_FRAMEBUFFER, static_cast<GLsizei>(attachments.size()), attachments.data());
+        }
+
+        // Textures that were only sampled by the pass are not attached, invalidate their image directly
+        for (auto handle : resources) {
+            bool attached = std::any_of(pass.Writes.begin(), pass.Writes.end(), [handle](const Write& write) {
+                return write.Resource == handle;
+            });
+            if (!attached && resources_[handle].Texture) {
+                glInvalidateTexImage(resources_[handle].Texture, 0);
+            }
+        }
+    }
+
+    void RenderGraph::execute(RenderTargetPool& pool) {
+        if (!compiled_) {
+            compile();
+        }
+
+        for (auto& texture : physical_) {
+            texture.Texture = pool.acquireTexture(texture.Desc);
+        }
+        for (auto& resource : resources_) {
+            if (resource.PhysicalSlot >= 0) {
+                resource.Texture = physical_[resource.PhysicalSlot].Texture;
+            }
+        }
+
+        RenderPassContext context(*this);
+        std::vector<RenderResource> dontCare;
+        for (const auto& pass : passes_) {
+            if (pass.Culled) {
+                continue;
+            }
+
+            if (!pass.Writes.empty()) {
+                bindPassTargets(pass, pool);
+
+                dontCare.clear();
+                GLint colorIndex = 0;
+                for (const auto& write : pass.Writes) {
+                    const auto& resource = resources_[write.Resource];
+                    bool depth = isDepthFormat(resource.Desc.Format);
+                    if (write.Load == LoadOp::Clear) {
+                        if (depth) {
+                            glClearBufferfi(GL_DEPTH_STENCIL, 0, write.ClearColor[0], 0);
+                        } else {
+                            glClearBufferfv(GL_COLOR, resource.Backbuffer ? 0 : colorIndex, write.ClearColor.data());
+                        }
+                    } else if (write.Load == LoadOp::DontCare) {
+                        dontCare.push_back(write.Resource);
+                    }
+                    if (!depth && !resource.Backbuffer) {
+                        colorIndex++;
+                    }
+                }
+                invalidateAttachments(pass, dontCare);
+            }
+
+            pass.Execute(context);
+
+            if (!pass.InvalidateAfter.empty()) {
+                invalidateAttachments(pass, pass.InvalidateAfter);
+            }
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        for (auto& texture : physical_) {
+            pool.releaseTexture(texture.Texture);
+        }
+    }
+}
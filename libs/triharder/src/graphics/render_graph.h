@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <vector>
+#include "render_target_pool.h"
+#include "../core/string_id.h"
+
+namespace TriHarder {
+
+    //! @typedef RenderResource
+    //! @brief Handle of a texture declared in a RenderGraph.
+    using RenderResource = uint32_t;
+    constexpr RenderResource InvalidRenderResource = ~0u;
+
+    //! @enum LoadOp
+    //! @brief What happens to the previous contents of a written attachment when a pass starts.
+    enum class LoadOp : uint8_t {
+        Load,     //!< Keep the contents written by an earlier pass.
+        Clear,    //!< Clear the attachment before the pass.
+        DontCare, //!< The pass overwrites everything; the old contents are invalidated.
+    };
+
+    //! @struct RenderGraphStats
+    //! @brief Result of the last RenderGraph::compile() call.
+    struct RenderGraphStats {
+        uint32_t Passes = 0;               //!< Declared passes.
+        uint32_t CulledPasses = 0;         //!< Passes whose outputs nobody consumes.
+        uint32_t TransientResources = 0;   //!< Transient textures used by the remaining passes.
+        uint32_t PhysicalTextures = 0;     //!< Textures actually needed after aliasing.
+        uint64_t TransientBytesWithoutAliasing = 0; //!< Memory if every transient texture had its own storage.
+        uint64_t TransientBytesWithAliasing = 0;    //!< Memory of the aliased physical textures.
+        uint32_t Clears = 0;               //!< Clears issued per frame.
+        uint32_t Invalidations = 0;        //!< Attachments invalidated per frame.
+    };
+
+    class RenderGraph;
+
+    //! @class RenderPassContext
+    //! @brief Gives pass execution access to the physical textures of the graph.
+    class RenderPassContext {
+    public:
+        //! @return The GL texture bound to a resource for this frame.
+        [[nodiscard]] GLuint getTexture(RenderResource resource) const;
+
+        //! @return The description of a resource.
+        [[nodiscard]] const RenderTextureDesc& getDesc(RenderResource resource) const;
+
+    private:
+        friend class RenderGraph;
+        explicit RenderPassContext(const RenderGraph& graph) : graph_(graph) {}
+        const RenderGraph& graph_;
+    };
+
+    //! @class RenderGraph
+    //! @brief Frame graph of render passes with declared texture reads and writes.
+    //!
+    //! Passes are recorded every frame with addPass(), then compile() culls passes that do
+    //! not contribute to an imported target or side effect, computes the lifetime of every
+    //! transient texture and assigns transient textures with disjoint lifetimes to the same
+    //! physical texture. execute() runs the passes in declaration order, binding pooled
+    //! framebuffers and issuing clears and invalidations only where the declared load
+    //! operations and lifetimes require them.
+    class RenderGraph {
+    public:
+        //! @class PassBuilder
+        //! @brief Declares the resources of a pass during setup.
+        class PassBuilder {
+        public:
+            //! Declares a transient texture that only lives inside this frame's graph.
+            RenderResource create(StringId name, const RenderTextureDesc& desc);
+
+            //! Declares that the pass samples from the resource.
+            RenderResource read(RenderResource resource);
+
+            //! Declares that the pass renders into the resource.
+            RenderResource write(RenderResource resource, LoadOp loadOp = LoadOp::Load,
+                                 std::array<float, 4> clearColor = {0.0f, 0.0f, 0.0f, 1.0f});
+
+            //! Keeps the pass even if no other pass consumes its output, e.g. for readbacks.
+            void setSideEffect();
+
+        private:
+            friend class RenderGraph;
+            PassBuilder(RenderGraph& graph, uint32_t pass) : graph_(graph), pass_(pass) {}
+            RenderGraph& graph_;
+            uint32_t pass_;
+        };
+
+        using SetupFunction = std::function<void(PassBuilder&)>;
+        using ExecuteFunction = std::function<void(const RenderPassContext&)>;
+
+        //! Drops all passes and resources of the previous frame.
+        void reset();
+
+        //! Imports the default framebuffer. Passes writing it are never culled.
+        RenderResource importBackbuffer(uint32_t width, uint32_t height);
+
+        //! Imports an externally owned texture. Passes writing it are never culled.
+        RenderResource importTexture(StringId name, GLuint texture, const RenderTextureDesc& desc);
+
+        //! Records a pass. setup runs immediately, execute runs in execute() unless the pass is culled.
+        void addPass(StringId name, const SetupFunction& setup, ExecuteFunction execute);
+
+        //! Culls passes, computes lifetimes and aliases transient textures.
+        void compile();
+
+        //! Runs the surviving passes. compile() must have been called.
+        void execute(RenderTargetPool& pool);
+
+        [[nodiscard]] const RenderGraphStats& getStats() const { return stats_; }
+        [[nodiscard]] bool isPassCulled(StringId name) const;
+
+        //! @return The physical texture slot a transient resource was aliased to, for diagnostics.
+        [[nodiscard]] int32_t getPhysicalSlot(RenderResource resource) const { return resources_[resource].PhysicalSlot; }
+
+    private:
+        friend class RenderPassContext;
+
+        struct Write {
+            RenderResource Resource;
+            LoadOp Load;
+            std::array<float, 4> ClearColor;
+        };
+
+        struct Pass {
+            StringId Name;
+            std::vector<RenderResource> Reads;
+            std::vector<Write> Writes;
+            ExecuteFunction Execute;
+            bool SideEffect = false;
+            bool Culled = false;
+            std::vector<RenderResource> InvalidateAfter; //!< Attachments whose contents are dead after the pass.
+        };
+
+        struct Resource {
+            StringId Name;
+            RenderTextureDesc Desc;
+            bool Imported = false;
+            bool Backbuffer = false;
+            GLuint Texture = 0;
+            int32_t FirstPass = -1;
+            int32_t LastPass = -1;
+            int32_t PhysicalSlot = -1;
+        };
+
+        struct PhysicalTexture {
+            RenderTextureDesc Desc;
+            int32_t LastPass;
+            GLuint Texture;
+        };
+
+        std::vector<Pass> passes_;
+        std::vector<Resource> resources_;
+        std::vector<PhysicalTexture> physical_;
+        RenderGraphStats stats_;
+        bool compiled_ = false;
+
+        void cullPasses();
+        void computeLifetimes();
+        void aliasResources();
+        void bindPassTargets(const Pass& pass, RenderTargetPool& pool);
+        void invalidateAttachments(const Pass& pass, const std::vector<RenderResource>& resources);
+        [[nodiscard]] bool canInvalidate() const;
+    };
+}
@@ -0,0 +1,179 @@
+#include "render_target_pool.h"
+#include "../core/logging.h"
+#include "../core/memory_tracker.h"
+#include <algorithm>
+
+namespace TriHarder {
+
+    static uint32_t bytesPerPixel(GLenum format) {
+        switch (format) {
+            case GL_R8:
+                return 1;
+            case GL_RG8:
+            case GL_R16F:
+            case GL_DEPTH_COMPONENT16:
+                return 2;
+            case GL_DEPTH_COMPONENT24:
+            case GL_RGB8:
+            case GL_SRGB8:
+                return 3;
+            case GL_RGBA16F:
+            case GL_RG32F:
+                return 8;
+            case GL_RGBA32F:
+                return 16;
+            case GL_R11F_G11F_B10F:
+            case GL_RGB10_A2:
+            case GL_RG16F:
+            case GL_R32F:
+            case GL_DEPTH_COMPONENT32F:
+            case GL_DEPTH24_STENCIL8:
+            case GL_SRGB8_ALPHA8:
+            case GL_RGBA8:
+            default:
+                return 4;
+        }
+    }
+
+    uint64_t estimateTextureBytes(const RenderTextureDesc& desc) {
+        return uint64_t(desc.Width) * desc.Height * bytesPerPixel(desc.Format);
+    }
+
+    bool isDepthFormat(GLenum format) {
+        switch (format) {
+            case GL_DEPTH_COMPONENT16:
+            case GL_DEPTH_COMPONENT24:
+            case GL_DEPTH_COMPONENT32F:
+            case GL_DEPTH24_STENCIL8:
+            case GL_DEPTH32F_STENCIL8:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static bool hasStencil(GLenum format) {
+        return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+    }
+
+    RenderTargetPool::~RenderTargetPool() {
+        for (auto& framebuffer : framebuffers_) {
+            glDeleteFramebuffers(1, &framebuffer.Framebuffer);
+        }
+        for (auto& texture : textures_) {
+            glDeleteTextures(1, &texture.Texture);
+        }
+        MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Texture, -static_cast<int64_t>(allocatedBytes_));
+    }
+
+    void RenderTargetPool::beginFrame() {
+        frame_++;
+
+        auto expired = [this](uint64_t lastUsedFrame) { return frame_ - lastUsedFrame > RetentionFrames; };
+        std::erase_if(framebuffers_, [&](PooledFramebuffer& framebuffer) {
+            if (expired(framebuffer.LastUsedFrame)) {
+                glDeleteFramebuffers(1, &framebuffer.Framebuffer);
+                return true;
+            }
+            return false;
+        });
+        std::erase_if(textures_, [&](PooledTexture& texture) {
+            if (!texture.InUse && expired(texture.LastUsedFrame)) {
+                glDeleteTextures(1, &texture.Texture);
+                allocatedBytes_ -= estimateTextureBytes(texture.Desc);
+                MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Texture,
+                                              -static_cast<int64_t>(estimateTextureBytes(texture.Desc)));
+                return true;
+            }
+            return false;
+        });
+    }
+
+    GLuint RenderTargetPool::acquireTexture(const RenderTextureDesc& desc) {
+        for (auto& texture : textures_) {
+            if (!texture.InUse && texture.Desc == desc) {
+                texture.InUse = true;
+                texture.LastUsedFrame = frame_;
+                return texture.Texture;
+            }
+        }
+
+        GLuint handle = 0;
+        glGenTextures(1, &handle);
+        glBindTexture(GL_TEXTURE_2D, handle);
+        // glTexStorage2D needs GL 4.2, the pixel format only has to be compatible as no data is uploaded
+        GLenum pixelFormat = GL_RGBA;
+        GLenum pixelType = GL_UNSIGNED_BYTE;
+        if (hasStencil(desc.Format)) {
+            pixelFormat = GL_DEPTH_STENCIL;
+            pixelType = desc.Format == GL_DEPTH32F_STENCIL8 ? GL_FLOAT_32_UNSIGNED_INT_24_8_REV : GL_UNSIGNED_INT_24_8;
+        } else if (isDepthFormat(desc.Format)) {
+            pixelFormat = GL_DEPTH_COMPONENT;
+            pixelType = GL_FLOAT;
+        }
+        glTexImage2D(GL_TEXTURE_2D, 0, (GLint)desc.Format, (GLsizei)desc.Width, (GLsizei)desc.Height, 0,
+                     pixelFormat, pixelType, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        textures_.push_back({handle, desc, true, frame_});
+        allocatedBytes_ += estimateTextureBytes(desc);
+        MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Texture,
+                                      static_cast<int64_t>(estimateTextureBytes(desc)));
+        return handle;
+    }
+
+    void RenderTargetPool::releaseTexture(GLuint texture) {
+        for (auto& pooled : textures_) {
+            if (pooled.Texture == texture) {
+                pooled.InUse = false;
+                pooled.LastUsedFrame = frame_;
+                return;
+            }
+        }
+    }
+
+    GLuint RenderTargetPool::getFramebuffer(const std::vector<GLuint>& colorAttachments, GLuint depthAttachment) {
+        for (auto& framebuffer : framebuffers_) {
+            if (framebuffer.DepthAttachment == depthAttachment && framebuffer.ColorAttachments == colorAttachments) {
+                framebuffer.LastUsedFrame = frame_;
+                return framebuffer.Framebuffer;
+            }
+        }
+
+        GLuint handle = 0;
+        glGenFramebuffers(1, &handle);
+        glBindFramebuffer(GL_FRAMEBUFFER, handle);
+
+        std::vector<GLenum> drawBuffers;
+        for (size_t i = 0; i < colorAttachments.size(); ++i) {
+            auto attachment = static_cast<GLenum>(GL_COLOR_ATTACHMENT0 + i);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, colorAttachments[i], 0);
+            drawBuffers.push_back(attachment);
+        }
+        if (depthAttachment) {
+            auto it = std::find_if(textures_.begin(), textures_.end(), [depthAttachment](const PooledTexture& texture) {
+                return texture.Texture == depthAttachment;
+            });
+            bool stencil = it != textures_.end() && hasStencil(it->Desc.Format);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                                   GL_TEXTURE_2D, depthAttachment, 0);
+        }
+
+        if (drawBuffers.empty()) {
+            glDrawBuffer(GL_NONE);
+        } else {
+            glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+        }
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            auto logger = LogManager::getInstance().getLogger();
+            logger->error("Render graph framebuffer is incomplete");
+        }
+
+        framebuffers_.push_back({handle, colorAttachments, depthAttachment, frame_});
+        return handle;
+    }
+}
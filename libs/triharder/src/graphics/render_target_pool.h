@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "../triharder.h"
+
+namespace TriHarder {
+
+    //! @struct RenderTextureDesc
+    //! @brief Describes a 2D render target texture.
+    struct RenderTextureDesc {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        GLenum Format = GL_RGBA8; //!< Sized internal format, depth formats become depth attachments.
+
+        bool operator==(const RenderTextureDesc&) const = default;
+    };
+
+    //! @return The estimated size of a texture with this description in bytes.
+    uint64_t estimateTextureBytes(const RenderTextureDesc& desc);
+
+    //! @return True if the format has to be attached as depth (and stencil) attachment.
+    bool isDepthFormat(GLenum format);
+
+    //! @class RenderTargetPool
+    //! @brief Recycles render target textures and framebuffer objects across frames.
+    //!
+    //! Textures are matched by their exact description. Framebuffers are cached by their
+    //! attachment set, so rebinding the same targets does not re-validate an FBO. Entries
+    //! not used for a number of frames are deleted in beginFrame().
+    class RenderTargetPool {
+    public:
+        RenderTargetPool() = default;
+        ~RenderTargetPool();
+
+        RenderTargetPool(const RenderTargetPool&) = delete;
+        RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+        void beginFrame();
+
+        //! Returns an unused texture matching the description, creating one if needed.
+        GLuint acquireTexture(const RenderTextureDesc& desc);
+
+        //! Returns a texture to the pool for reuse in this or a later frame.
+        void releaseTexture(GLuint texture);
+
+        //! Returns a framebuffer with the given attachments, creating one if needed.
+        GLuint getFramebuffer(const std::vector<GLuint>& colorAttachments, GLuint depthAttachment);
+
+        [[nodiscard]] uint64_t getAllocatedBytes() const { return allocatedBytes_; }
+        [[nodiscard]] size_t getTextureCount() const { return textures_.size(); }
+
+        //! Number of frames an unused texture or framebuffer is kept alive.
+        static constexpr uint64_t RetentionFrames = 60;
+
+    private:
+        struct PooledTexture {
+            GLuint Texture;
+            RenderTextureDesc Desc;
+            bool InUse;
+            uint64_t LastUsedFrame;
+        };
+
+        struct PooledFramebuffer {
+            GLuint Framebuffer;
+            std::vector<GLuint> ColorAttachments;
+            GLuint DepthAttachment;
+            uint64_t LastUsedFrame;
+        };
+
+        std::vector<PooledTexture> textures_;
+        std::vector<PooledFramebuffer> framebuffers_;
+        uint64_t frame_ = 0;
+        uint64_t allocatedBytes_ = 0;
+    };
+}
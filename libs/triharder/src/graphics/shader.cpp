@@ -0,0 +1,62 @@
+#include "shader.h"
+#include "../core/logging.h"
+
+namespace TriHarder {
+
+    UniquePtr<Shader> Shader::create(const String& name, const char* vertexSource, const char* fragmentSource) {
+        auto shader = UniquePtr<Shader>(new Shader(name));
+        GLuint vertex = shader->compile(GL_VERTEX_SHADER, vertexSource);
+        GLuint fragment = shader->compile(GL_FRAGMENT_SHADER, fragmentSource);
+
+        shader->m_program = glCreateProgram();
+        glAttachShader(shader->m_program, vertex);
+        glAttachShader(shader->m_program, fragment);
+        glLinkProgram(shader->m_program);
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+
+        GLint linked = GL_FALSE;
+        glGetProgramiv(shader->m_program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            char log[1024];
+            glGetProgramInfoLog(shader->m_program, sizeof(log), nullptr, log);
+            auto logger = LogManager::getInstance().getLogger();
+            logger->error(std::format("Failed to link shader {}: {}", name, log));
+            throw std::runtime_error("Failed to link shader " + name);
+        }
+        return shader;
+    }
+
+    Shader::~Shader() {
+        if (m_program) {
+            glDeleteProgram(m_program);
+        }
+    }
+
+    void Shader::use() const {
+        glUseProgram(m_program);
+    }
+
+    GLint Shader::getUniformLocation(const char* uniform) const {
+        return glGetUniformLocation(m_program, uniform);
+    }
+
+    GLuint Shader::compile(GLenum stage, const char* source) const {
+        GLuint shader = glCreateShader(stage);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint compiled = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+        if (!compiled) {
+            char log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            glDeleteShader(shader);
+            auto logger = LogManager::getInstance().getLogger();
+            logger->error(std::format("Failed to compile {} shader {}: {}",
+                                      stage == GL_VERTEX_SHADER ? "vertex" : "fragment", m_name, log));
+            throw std::runtime_error("Failed to compile shader " + m_name);
+        }
+        return shader;
+    }
+}
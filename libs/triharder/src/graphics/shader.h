@@ -0,0 +1,33 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "../triharder.h"
+
+namespace TriHarder {
+
+    //! @class Shader
+    //! @brief A linked OpenGL program built from a vertex and a fragment shader.
+    class Shader {
+    public:
+        //! Compiles and links a program.
+        //! @throws std::runtime_error if compiling or linking fails. The info log is written to the logger.
+        static UniquePtr<Shader> create(const String& name, const char* vertexSource, const char* fragmentSource);
+        ~Shader();
+
+        Shader(const Shader&) = delete;
+        Shader& operator=(const Shader&) = delete;
+
+        void use() const;
+
+        [[nodiscard]] GLint getUniformLocation(const char* uniform) const;
+        [[nodiscard]] GLuint getHandle() const { return m_program; }
+
+    private:
+        explicit Shader(String name) : m_name(std::move(name)) {}
+
+        String m_name;
+        GLuint m_program = 0;
+
+        GLuint compile(GLenum stage, const char* source) const;
+    };
+}
@@ -0,0 +1,109 @@
+#include "skyline_packer.h"
+#include <algorithm>
+#include <limits>
+
+namespace TriHarder {
+
+    SkylinePacker::SkylinePacker(uint32_t width, uint32_t height, uint32_t padding)
+        : width_(width), height_(height), padding_(padding) {
+        reset();
+    }
+
+    void SkylinePacker::reset() {
+        skyline_.clear();
+        skyline_.push_back({0, 0, width_});
+        usedArea_ = 0;
+    }
+
+    float SkylinePacker::getOccupancy() const {
+        return static_cast<float>(usedArea_) / static_cast<float>(uint64_t(width_) * height_);
+    }
+
+    std::optional<PackedRect> SkylinePacker::insert(uint32_t width, uint32_t height) {
+        uint32_t paddedWidth = width + padding_;
+        uint32_t paddedHeight = height + padding_;
+
+        // Bottom-left: pick the position with the lowest top edge, ties go to the narrower node
+        size_t bestIndex = skyline_.size();
+        uint32_t bestTop = std::numeric_limits<uint32_t>::max();
+        uint32_t bestWidth = std::numeric_limits<uint32_t>::max();
+        uint32_t bestY = 0;
+        for (size_t i = 0; i < skyline_.size(); ++i) {
+            auto y = fit(i, paddedWidth, paddedHeight);
+            if (!y) {
+                continue;
+            }
+
+            uint32_t top = *y + paddedHeight;
+            if (top < bestTop || (top == bestTop && skyline_[i].Width < bestWidth)) {
+                bestIndex = i;
+                bestTop = top;
+                bestWidth = skyline_[i].Width;
+                bestY = *y;
+            }
+        }
+
+        if (bestIndex == skyline_.size()) {
+            return std::nullopt;
+        }
+
+        uint32_t x = skyline_[bestIndex].X;
+        addNode(bestIndex, x, bestY, paddedWidth, paddedHeight);
+        usedArea_ += uint64_t(paddedWidth) * paddedHeight;
+        return PackedRect{x, bestY, width, height};
+    }
+
+    std::optional<uint32_t> SkylinePacker::fit(size_t index, uint32_t width, uint32_t height) const {
+        uint32_t x = skyline_[index].X;
+        if (x + width > width_) {
+            return std::nullopt;
+        }
+
+        uint32_t y = 0;
+        int64_t remaining = width;
+        for (size_t i = index; remaining > 0; ++i) {
+            if (i == skyline_.size()) {
+                return std::nullopt;
+            }
+            y = std::max(y, skyline_[i].Y);
+            if (y + height > height_) {
+                return std::nullopt;
+            }
+            remaining -= skyline_[i].Width;
+        }
+        return y;
+    }
+
+    void SkylinePacker::addNode(size_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+        skyline_.insert(skyline_.begin() + static_cast<std::ptrdiff_t>(index), {x, y + height, width});
+
+        // Shrink or remove the nodes that are now covered by the new one
+        size_t i = index + 1;
+        while (i < skyline_.size()) {
+            auto& previous = skyline_[i - 1];
+            auto& node = skyline_[i];
+            uint32_t previousEnd = previous.X + previous.Width;
+            if (node.X >= previousEnd) {
+                break;
+            }
+
+            uint32_t shrink = previousEnd - node.X;
+            if (node.Width > shrink) {
+                node.X += shrink;
+                node.Width -= shrink;
+                break;
+            }
+            skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+
+        // Merge neighbours at the same height
+        for (size_t j = 0; j + 1 < skyline_.size();) {
+            if (skyline_[j].Y == skyline_[j + 1].Y) {
+                skyline_[j].Width += skyline_[j + 1].Width;
+                skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(j + 1));
+            } else {
+                ++j;
+            }
+        }
+    }
+}
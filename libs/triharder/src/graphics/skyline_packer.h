@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace TriHarder {
+
+    //! @struct PackedRect
+    //! @brief A rectangle allocated inside a texture atlas, in pixels.
+    struct PackedRect {
+        uint32_t X = 0;
+        uint32_t Y = 0;
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+    };
+
+    //! @class SkylinePacker
+    //! @brief Packs rectangles into a fixed size area using the skyline bottom-left heuristic.
+    //!
+    //! The skyline only tracks the top edge of the allocated area, so single rectangles
+    //! cannot be freed. Callers evict by resetting the whole packer.
+    class SkylinePacker {
+    public:
+        SkylinePacker(uint32_t width, uint32_t height, uint32_t padding = 1);
+
+        //! Allocates a rectangle of the given size.
+        //! @return The allocated rectangle, or std::nullopt if it does not fit anymore.
+        std::optional<PackedRect> insert(uint32_t width, uint32_t height);
+
+        //! Releases all allocations.
+        void reset();
+
+        [[nodiscard]] uint32_t getWidth() const { return width_; }
+        [[nodiscard]] uint32_t getHeight() const { return height_; }
+
+        //! @return The fraction of the area covered by allocations, including padding.
+        [[nodiscard]] float getOccupancy() const;
+
+    private:
+        struct Node {
+            uint32_t X;
+            uint32_t Y;
+            uint32_t Width;
+        };
+
+        uint32_t width_;
+        uint32_t height_;
+        uint32_t padding_;
+        uint64_t usedArea_ = 0;
+        std::vector<Node> skyline_;
+
+        //! @return The y coordinate a rectangle would be placed at when starting at node index, or nullopt.
+        [[nodiscard]] std::optional<uint32_t> fit(size_t index, uint32_t width, uint32_t height) const;
+        void addNode(size_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+    };
+}
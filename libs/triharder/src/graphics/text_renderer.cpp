@@ -0,0 +1,241 @@
+#include "text_renderer.h"
+#include <cstddef>
+#include "../core/memory_tracker.h"
+
+namespace TriHarder {
+
+    //! Four corners of two floats, the instances are tracked by their capacity.
+    static constexpr int64_t QuadBufferBytes = 8 * sizeof(float);
+
+    static const char* TextVertexShader = R"(#version 330 core
+layout(location = 0) in vec2 aCorner;
+layout(location = 1) in vec4 aRect;
+layout(location = 2) in vec4 aUv;
+layout(location = 3) in vec4 aColor;
+uniform vec2 uViewport;
+out vec2 vUv;
+out vec4 vColor;
+void main() {
+    vec2 position = aRect.xy + aCorner * aRect.zw;
+    vec2 ndc = position / uViewport * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+    vUv = mix(aUv.xy, aUv.zw, aCorner);
+    vColor = aColor;
+}
+)";
+
+    static const char* TextFragmentShader = R"(#version 330 core
+in vec2 vUv;
+in vec4 vColor;
+uniform sampler2D uAtlas;
+out vec4 fragColor;
+void main() {
+    fragColor = vec4(vColor.rgb, vColor.a * texture(uAtlas, vUv).r);
+}
+)";
+
+    //! Decodes the next UTF-8 code point and advances the position. Invalid bytes become U+FFFD.
+    static char32_t decodeUtf8(std::string_view text, size_t& position) {
+        auto byte = static_cast<uint8_t>(text[position++]);
+        if (byte < 0x80) {
+            return byte;
+        }
+
+        int extra = byte >= 0xF0 ? 3 : byte >= 0xE0 ? 2 : byte >= 0xC0 ? 1 : -1;
+        if (extra < 0 || position + extra > text.size()) {
+            return 0xFFFD;
+        }
+
+        char32_t codepoint = byte & (0x3F >> extra);
+        for (int i = 0; i < extra; ++i) {
+            codepoint = (codepoint << 6) | (static_cast<uint8_t>(text[position++]) & 0x3F);
+        }
+        return codepoint;
+    }
+
+    UniquePtr<TextRenderer> TextRenderer::create(uint32_t atlasPageSize, uint32_t maxAtlasPages) {
+        MemoryTagScope scope(MemoryTag::Rendering);
+        auto renderer = UniquePtr<TextRenderer>(new TextRenderer(atlasPageSize, maxAtlasPages));
+        renderer->initializeGpuResources();
+        return renderer;
+    }
+
+    TextRenderer::~TextRenderer() {
+        glDeleteBuffers(1, &instanceBuffer_);
+        glDeleteBuffers(1, &quadBuffer_);
+        glDeleteVertexArrays(1, &vao_);
+        MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Buffer,
+                                      -static_cast<int64_t>(QuadBufferBytes + instanceCapacity_ * sizeof(GlyphInstance)));
+    }
+
+    void TextRenderer::initializeGpuResources() {
+        shader_ = Shader::create("text", TextVertexShader, TextFragmentShader);
+        viewportLocation_ = shader_->getUniformLocation("uViewport");
+        shader_->use();
+        glUniform1i(shader_->getUniformLocation("uAtlas"), 0);
+
+        const float corners[] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+        glGenVertexArrays(1, &vao_);
+        glBindVertexArray(vao_);
+
+        glGenBuffers(1, &quadBuffer_);
+        glBindBuffer(GL_ARRAY_BUFFER, quadBuffer_);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Buffer, QuadBufferBytes);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+        glGenBuffers(1, &instanceBuffer_);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+        for (GLuint attribute = 1; attribute <= 3; ++attribute) {
+            glEnableVertexAttribArray(attribute);
+            glVertexAttribDivisor(attribute, 1);
+        }
+        glBindVertexArray(0);
+    }
+
+    void TextRenderer::beginFrame(uint32_t viewportWidth, uint32_t viewportHeight) {
+        frame_++;
+        atlas_.beginFrame();
+        viewportWidth_ = viewportWidth;
+        viewportHeight_ = viewportHeight;
+        stats_ = TextRendererStats();
+
+        // Drop runs that have not been drawn for a while; scanning every frame would cost more than it saves
+        if (frame_ % RunRetentionFrames == 0) {
+            std::erase_if(runs_, [this](const auto& entry) {
+                return frame_ - entry.second.LastUsedFrame > RunRetentionFrames;
+            });
+        }
+    }
+
+    void TextRenderer::drawText(std::string_view text, float x, float y, const TextStyle& style) {
+        if (!style.TextFont || text.empty()) {
+            return;
+        }
+        stats_.Labels++;
+
+        auto it = runs_.find(RunKeyView{text, style.TextFont->getId()});
+        if (it == runs_.end()) {
+            it = runs_.emplace(RunKey{String(text), style.TextFont->getId()}, TextRun()).first;
+            layout(text, *style.TextFont, it->second);
+            stats_.Layouts++;
+        } else if (it->second.Epoch != atlas_.getEpoch()) {
+            // Atlas pages were evicted since the run was laid out
+            layout(text, *style.TextFont, it->second);
+            stats_.Layouts++;
+        } else {
+            atlas_.touchPages(it->second.PageMask);
+            stats_.RunCacheHits++;
+        }
+
+        auto& run = it->second;
+        run.LastUsedFrame = frame_;
+        const float scale = style.Scale;
+        for (const auto& glyph : run.Glyphs) {
+            pageInstances_[glyph.Page].push_back({
+                {x + glyph.X * scale, y + glyph.Y * scale, glyph.Width * scale, glyph.Height * scale},
+                {glyph.U0, glyph.V0, glyph.U1, glyph.V1},
+                style.Color
+            });
+        }
+        stats_.Glyphs += static_cast<uint32_t>(run.Glyphs.size());
+    }
+
+    void TextRenderer::layout(std::string_view text, const Font& font, TextRun& run) {
+        run.Glyphs.clear();
+        run.PageMask = 0;
+
+        float penX = 0.0f;
+        float penY = 0.0f;
+        uint32_t previousGlyph = 0;
+        bool complete = true;
+        for (size_t position = 0; position < text.size();) {
+            char32_t codepoint = decodeUtf8(text, position);
+            if (codepoint == U'\n') {
+                penX = 0.0f;
+                penY += font.getLineHeight();
+                previousGlyph = 0;
+                continue;
+            }
+
+            uint32_t glyphIndex = font.getGlyphIndex(codepoint);
+            penX += font.getKerning(previousGlyph, glyphIndex);
+            previousGlyph = glyphIndex;
+
+            const AtlasGlyph* glyph = atlas_.getGlyph(font, glyphIndex);
+            if (!glyph) {
+                complete = false;
+                continue;
+            }
+
+            if (glyph->Width > 0.0f) {
+                run.Glyphs.push_back({glyph->Page, penX + glyph->BearingX, penY - glyph->BearingY,
+                                      glyph->Width, glyph->Height, glyph->U0, glyph->V0, glyph->U1, glyph->V1});
+                run.PageMask |= 1u << glyph->Page;
+            }
+            penX += glyph->Advance;
+        }
+
+        // Read the epoch last, laying out this run may have evicted a page itself.
+        // Runs with glyphs that did not fit are laid out again on the next use.
+        run.Epoch = complete ? atlas_.getEpoch() : InvalidEpoch;
+    }
+
+    void TextRenderer::flush() {
+        // Pack all pages into one upload, each page is drawn from its own range of the buffer
+        uploadBuffer_.clear();
+        for (size_t page = 0; page < atlas_.getPageCount(); ++page) {
+            uploadBuffer_.insert(uploadBuffer_.end(), pageInstances_[page].begin(), pageInstances_[page].end());
+        }
+        if (uploadBuffer_.empty()) {
+            return;
+        }
+
+        glBindVertexArray(vao_);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+        size_t bytes = uploadBuffer_.size() * sizeof(GlyphInstance);
+        if (uploadBuffer_.size() > instanceCapacity_) {
+            MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Buffer,
+                                          int64_t(uploadBuffer_.size() * 2 - instanceCapacity_) * int64_t(sizeof(GlyphInstance)));
+            instanceCapacity_ = uploadBuffer_.size() * 2;
+        }
+
+        // Orphaning the previous storage keeps the driver from waiting on the last frame
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(instanceCapacity_ * sizeof(GlyphInstance)), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)bytes, uploadBuffer_.data());
+
+        shader_->use();
+        glUniform2f(viewportLocation_, static_cast<float>(viewportWidth_), static_cast<float>(viewportHeight_));
+        glActiveTexture(GL_TEXTURE0);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        size_t first = 0;
+        for (size_t page = 0; page < atlas_.getPageCount(); ++page) {
+            auto& instances = pageInstances_[page];
+            if (instances.empty()) {
+                continue;
+            }
+
+            auto offset = reinterpret_cast<const void*>(first * sizeof(GlyphInstance));
+            auto stride = static_cast<GLsizei>(sizeof(GlyphInstance));
+            glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride,
+                                  static_cast<const char*>(offset) + offsetof(GlyphInstance, Rect));
+            glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride,
+                                  static_cast<const char*>(offset) + offsetof(GlyphInstance, Uv));
+            glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                                  static_cast<const char*>(offset) + offsetof(GlyphInstance, Color));
+
+            glBindTexture(GL_TEXTURE_2D, atlas_.getPageTexture(page));
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(instances.size()));
+            stats_.DrawCalls++;
+
+            first += instances.size();
+            instances.clear();
+        }
+
+        glDisable(GL_BLEND);
+        glBindVertexArray(0);
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "glyph_atlas.h"
+#include "shader.h"
+
+namespace TriHarder {
+
+    //! @struct TextStyle
+    //! @brief Visual properties of a text label.
+    struct TextStyle {
+        const Font* TextFont = nullptr; //!< Font used for layout and rasterization.
+        uint32_t Color = 0xFFFFFFFF;    //!< Packed RGBA8 color, red in the lowest byte.
+        float Scale = 1.0f;             //!< Scale applied to the laid out run.
+    };
+
+    //! @struct TextRendererStats
+    //! @brief Counters for the current frame.
+    struct TextRendererStats {
+        uint32_t Labels = 0;       //!< drawText calls.
+        uint32_t RunCacheHits = 0; //!< Labels served from the run cache.
+        uint32_t Layouts = 0;      //!< Labels that had to be laid out.
+        uint32_t Glyphs = 0;       //!< Glyph instances submitted.
+        uint32_t DrawCalls = 0;    //!< Instanced draw calls issued by flush().
+    };
+
+    //! @class TextRenderer
+    //! @brief Draws text from a glyph atlas with one instanced draw call per atlas page.
+    //!
+    //! Laid out runs are cached per font and string, so labels that did not change
+    //! since the last frames only cost a hash lookup and copying their glyph quads.
+    //! Positions are in pixels with the origin in the top-left corner and y pointing
+    //! down; the y coordinate passed to drawText() is the baseline of the first line.
+    class TextRenderer {
+    public:
+        static UniquePtr<TextRenderer> create(uint32_t atlasPageSize = 1024, uint32_t maxAtlasPages = 4);
+        ~TextRenderer();
+
+        TextRenderer(const TextRenderer&) = delete;
+        TextRenderer& operator=(const TextRenderer&) = delete;
+
+        //! Starts a new frame for the given framebuffer size.
+        void beginFrame(uint32_t viewportWidth, uint32_t viewportHeight);
+
+        //! Queues a label. Supports UTF-8 and '\n' line breaks.
+        void drawText(std::string_view text, float x, float y, const TextStyle& style);
+
+        //! Submits all queued labels.
+        void flush();
+
+        [[nodiscard]] const TextRendererStats& getStats() const { return stats_; }
+        [[nodiscard]] size_t getCachedRunCount() const { return runs_.size(); }
+        [[nodiscard]] const GlyphAtlas& getAtlas() const { return atlas_; }
+
+        //! Number of frames a run may stay unused before it is dropped from the cache.
+        static constexpr uint64_t RunRetentionFrames = 120;
+
+    private:
+        struct RunGlyph {
+            uint16_t Page;
+            float X, Y, Width, Height;
+            float U0, V0, U1, V1;
+        };
+
+        struct TextRun {
+            std::vector<RunGlyph> Glyphs;
+            uint64_t Epoch = 0;
+            uint64_t LastUsedFrame = 0;
+            uint32_t PageMask = 0;
+        };
+
+        struct GlyphInstance {
+            float Rect[4];
+            float Uv[4];
+            uint32_t Color;
+        };
+
+        struct RunKey {
+            String Text;
+            uint32_t FontId;
+        };
+
+        struct RunKeyView {
+            std::string_view Text;
+            uint32_t FontId;
+        };
+
+        // Transparent hashing lets drawText look up runs without allocating a key
+        struct RunKeyHash {
+            using is_transparent = void;
+            size_t operator()(const RunKeyView& key) const {
+                return std::hash<std::string_view>()(key.Text) ^ (size_t(key.FontId) * 0x9E3779B97F4A7C15ull);
+            }
+            size_t operator()(const RunKey& key) const { return (*this)(RunKeyView{key.Text, key.FontId}); }
+        };
+
+        struct RunKeyEqual {
+            using is_transparent = void;
+            static RunKeyView view(const RunKey& key) { return {key.Text, key.FontId}; }
+            static RunKeyView view(const RunKeyView& key) { return key; }
+            template<typename L, typename R>
+            bool operator()(const L& lhs, const R& rhs) const {
+                auto l = view(lhs);
+                auto r = view(rhs);
+                return l.FontId == r.FontId && l.Text == r.Text;
+            }
+        };
+
+        TextRenderer(uint32_t atlasPageSize, uint32_t maxAtlasPages) : atlas_(atlasPageSize, maxAtlasPages) {}
+
+        static constexpr uint64_t InvalidEpoch = ~0ull;
+
+        GlyphAtlas atlas_;
+        UniquePtr<Shader> shader_;
+        GLint viewportLocation_ = -1;
+        GLuint vao_ = 0;
+        GLuint quadBuffer_ = 0;
+        GLuint instanceBuffer_ = 0;
+        size_t instanceCapacity_ = 0;
+
+        std::unordered_map<RunKey, TextRun, RunKeyHash, RunKeyEqual> runs_;
+        std::array<std::vector<GlyphInstance>, GlyphAtlas::MaxPageLimit> pageInstances_;
+        std::vector<GlyphInstance> uploadBuffer_;
+        uint64_t frame_ = 0;
+        uint32_t viewportWidth_ = 0;
+        uint32_t viewportHeight_ = 0;
+        TextRendererStats stats_;
+
+        void layout(std::string_view text, const Font& font, TextRun& run);
+        void initializeGpuResources();
+    };
+}
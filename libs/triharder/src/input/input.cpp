@@ -0,0 +1,312 @@
+#include "input.h"
+#include "../core/logging.h"
+#include "../core/memory_tracker.h"
+#include <SDL.h>
+#include <algorithm>
+
+namespace TriHarder {
+
+    static double countsToMilliseconds(uint64_t counts) {
+        return static_cast<double>(counts) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+
+    Input::Input() {
+        clearBindings();
+    }
+
+    Input::~Input() {
+        for (auto& gamepad : gamepads_) {
+            if (gamepad.Controller) {
+                SDL_GameControllerClose(gamepad.Controller);
+            }
+        }
+    }
+
+    void Input::initialize() {
+        MemoryTagScope scope(MemoryTag::Input);
+        if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) != 0) {
+            auto logger = LogManager::getInstance().getLogger();
+            logger->warn(std::format("Failed to initialize game controller support: {}", SDL_GetError()));
+            return;
+        }
+
+        for (int i = 0; i < SDL_NumJoysticks(); ++i) {
+            openGamepad(i);
+        }
+    }
+
+    void Input::beginFrame() {
+        pressedKeys_.reset();
+        releasedKeys_.reset();
+        pressedMouseButtons_.reset();
+        releasedMouseButtons_.reset();
+        pressedActions_.reset();
+        releasedActions_.reset();
+        for (auto& gamepad : gamepads_) {
+            gamepad.PressedButtons.reset();
+            gamepad.ReleasedButtons.reset();
+        }
+        mouseDeltaX_ = 0;
+        mouseDeltaY_ = 0;
+        mouseWheel_ = 0.0f;
+    }
+
+    bool Input::processEvent(const SDL_Event& event) {
+        switch (event.type) {
+            case SDL_KEYDOWN:
+            case SDL_KEYUP: {
+                if (event.key.repeat) {
+                    return true;
+                }
+                bool down = event.type == SDL_KEYDOWN;
+                auto scancode = event.key.keysym.scancode;
+                if (scancode < 0 || scancode >= SDL_NUM_SCANCODES) {
+                    return true;
+                }
+                if (keys_.test(scancode) != down) {
+                    (down ? pressedKeys_ : releasedKeys_).set(scancode);
+                }
+                keys_.set(scancode, down);
+                updateAction(keyActions_[scancode], down);
+                notePendingInput(event.key.timestamp);
+                return true;
+            }
+            case SDL_MOUSEMOTION:
+                mouseX_ = event.motion.x;
+                mouseY_ = event.motion.y;
+                mouseDeltaX_ += event.motion.xrel;
+                mouseDeltaY_ += event.motion.yrel;
+                notePendingInput(event.motion.timestamp);
+                return true;
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP: {
+                bool down = event.type == SDL_MOUSEBUTTONDOWN;
+                size_t index = toMouseIndex(event.button.button);
+                if (mouseButtons_.test(index) != down) {
+                    (down ? pressedMouseButtons_ : releasedMouseButtons_).set(index);
+                }
+                mouseButtons_.set(index, down);
+                updateAction(mouseActions_[index], down);
+                notePendingInput(event.button.timestamp);
+                return true;
+            }
+            case SDL_MOUSEWHEEL:
+                mouseWheel_ += event.wheel.preciseY;
+                notePendingInput(event.wheel.timestamp);
+                return true;
+            case SDL_CONTROLLERBUTTONDOWN:
+            case SDL_CONTROLLERBUTTONUP: {
+                auto gamepad = findGamepad(event.cbutton.which);
+                if (gamepad && event.cbutton.button < SDL_CONTROLLER_BUTTON_MAX) {
+                    bool down = event.type == SDL_CONTROLLERBUTTONDOWN;
+                    if (gamepad->Buttons.test(event.cbutton.button) != down) {
+                        (down ? gamepad->PressedButtons : gamepad->ReleasedButtons).set(event.cbutton.button);
+                    }
+                    gamepad->Buttons.set(event.cbutton.button, down);
+                    updateAction(gamepadActions_[event.cbutton.button], down);
+                    notePendingInput(event.cbutton.timestamp);
+                }
+                return true;
+            }
+            case SDL_CONTROLLERAXISMOTION: {
+                auto gamepad = findGamepad(event.caxis.which);
+                if (gamepad && event.caxis.axis < SDL_CONTROLLER_AXIS_MAX) {
+                    gamepad->Axes[event.caxis.axis] = event.caxis.value;
+                    notePendingInput(event.caxis.timestamp);
+                }
+                return true;
+            }
+            case SDL_CONTROLLERDEVICEADDED:
+                openGamepad(event.cdevice.which);
+                return true;
+            case SDL_CONTROLLERDEVICEREMOVED:
+                closeGamepad(event.cdevice.which);
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void Input::markPresented() {
+        if (!hasPendingInput_) {
+            return;
+        }
+        hasPendingInput_ = false;
+
+        // SDL event timestamps only have millisecond resolution, the sample time uses the performance counter
+        double eventToPresent = static_cast<double>(SDL_GetTicks() - pendingEventTicks_);
+        double sampleToPresent = countsToMilliseconds(SDL_GetPerformanceCounter() - pendingSampleCounter_);
+
+        auto& stats = latency_;
+        stats.Frames++;
+        double weight = 1.0 / static_cast<double>(stats.Frames);
+        stats.AverageEventToPresentMs += (eventToPresent - stats.AverageEventToPresentMs) * weight;
+        stats.AverageSampleToPresentMs += (sampleToPresent - stats.AverageSampleToPresentMs) * weight;
+        stats.MaxEventToPresentMs = std::max(stats.MaxEventToPresentMs, eventToPresent);
+        stats.MaxSampleToPresentMs = std::max(stats.MaxSampleToPresentMs, sampleToPresent);
+    }
+
+    void Input::reset() {
+        for (auto& gamepad : gamepads_) {
+            if (gamepad.Controller) {
+                SDL_GameControllerClose(gamepad.Controller);
+            }
+            gamepad = Gamepad();
+        }
+        keys_.reset();
+        pressedKeys_.reset();
+        releasedKeys_.reset();
+        mouseButtons_.reset();
+        pressedMouseButtons_.reset();
+        releasedMouseButtons_.reset();
+        mouseX_ = 0;
+        mouseY_ = 0;
+        mouseDeltaX_ = 0;
+        mouseDeltaY_ = 0;
+        mouseWheel_ = 0.0f;
+        actionHoldCounts_.fill(0);
+        actions_.reset();
+        pressedActions_.reset();
+        releasedActions_.reset();
+        hasPendingInput_ = false;
+    }
+
+    bool Input::isGamepadButtonDown(size_t pad, uint8_t button) const {
+        return isGamepadConnected(pad) && button < SDL_CONTROLLER_BUTTON_MAX && gamepads_[pad].Buttons.test(button);
+    }
+
+    bool Input::isGamepadButtonPressed(size_t pad, uint8_t button) const {
+        return isGamepadConnected(pad) && button < SDL_CONTROLLER_BUTTON_MAX && gamepads_[pad].PressedButtons.test(button);
+    }
+
+    bool Input::isGamepadButtonReleased(size_t pad, uint8_t button) const {
+        return isGamepadConnected(pad) && button < SDL_CONTROLLER_BUTTON_MAX && gamepads_[pad].ReleasedButtons.test(button);
+    }
+
+    SDL_JoystickID Input::getGamepadInstanceId(size_t pad) const {
+        return isGamepadConnected(pad) ? gamepads_[pad].InstanceId : -1;
+    }
+
+    void Input::connectVirtualGamepad(SDL_JoystickID instanceId) {
+        if (findGamepad(instanceId)) {
+            return;
+        }
+
+        for (auto& gamepad : gamepads_) {
+            if (!gamepad.Connected) {
+                gamepad = Gamepad();
+                gamepad.InstanceId = instanceId;
+                gamepad.Connected = true;
+                return;
+            }
+        }
+    }
+
+    float Input::getGamepadAxis(size_t pad, uint8_t axis) const {
+        if (!isGamepadConnected(pad) || axis >= SDL_CONTROLLER_AXIS_MAX) {
+            return 0.0f;
+        }
+        return std::max(-1.0f, static_cast<float>(gamepads_[pad].Axes[axis]) / 32767.0f);
+    }
+
+    void Input::bindKey(ActionId action, SDL_Scancode key) {
+        if (action < MaxActions && key >= 0 && key < SDL_NUM_SCANCODES) {
+            keyActions_[key] = action;
+        }
+    }
+
+    void Input::bindMouseButton(ActionId action, uint8_t button) {
+        if (action < MaxActions) {
+            mouseActions_[toMouseIndex(button)] = action;
+        }
+    }
+
+    void Input::bindGamepadButton(ActionId action, uint8_t button) {
+        if (action < MaxActions && button < SDL_CONTROLLER_BUTTON_MAX) {
+            gamepadActions_[button] = action;
+        }
+    }
+
+    void Input::clearBindings() {
+        keyActions_.fill(NoAction);
+        mouseActions_.fill(NoAction);
+        gamepadActions_.fill(NoAction);
+        actionHoldCounts_.fill(0);
+        actions_.reset();
+        pressedActions_.reset();
+        releasedActions_.reset();
+    }
+
+    void Input::updateAction(ActionId action, bool down) {
+        if (action == NoAction) {
+            return;
+        }
+
+        // Several inputs can be bound to the same action, it is held while any of them is down
+        auto& holdCount = actionHoldCounts_[action];
+        if (down) {
+            holdCount++;
+        } else if (holdCount > 0) {
+            holdCount--;
+        }
+        bool held = holdCount > 0;
+        if (actions_.test(action) != held) {
+            (held ? pressedActions_ : releasedActions_).set(action);
+        }
+        actions_.set(action, held);
+    }
+
+    void Input::notePendingInput(uint32_t eventTicks) {
+        if (!hasPendingInput_) {
+            hasPendingInput_ = true;
+            pendingEventTicks_ = eventTicks;
+            pendingSampleCounter_ = SDL_GetPerformanceCounter();
+        }
+    }
+
+    void Input::openGamepad(int deviceIndex) {
+        if (!SDL_IsGameController(deviceIndex)) {
+            return;
+        }
+
+        SDL_JoystickID instanceId = SDL_JoystickGetDeviceInstanceID(deviceIndex);
+        if (findGamepad(instanceId)) {
+            return;
+        }
+
+        for (auto& gamepad : gamepads_) {
+            if (!gamepad.Connected) {
+                gamepad = Gamepad();
+                gamepad.Controller = SDL_GameControllerOpen(deviceIndex);
+                gamepad.InstanceId = instanceId;
+                gamepad.Connected = gamepad.Controller != nullptr;
+                return;
+            }
+        }
+    }
+
+    void Input::closeGamepad(SDL_JoystickID instanceId) {
+        auto gamepad = findGamepad(instanceId);
+        if (gamepad) {
+            // Release the actions held through this gamepad
+            for (size_t button = 0; button < gamepad->Buttons.size(); ++button) {
+                if (gamepad->Buttons.test(button)) {
+                    updateAction(gamepadActions_[button], false);
+                }
+            }
+            if (gamepad->Controller) {
+                SDL_GameControllerClose(gamepad->Controller);
+            }
+            *gamepad = Gamepad();
+        }
+    }
+
+    Input::Gamepad* Input::findGamepad(SDL_JoystickID instanceId) {
+        for (auto& gamepad : gamepads_) {
+            if (gamepad.Connected && gamepad.InstanceId == instanceId) {
+                return &gamepad;
+            }
+        }
+        return nullptr;
+    }
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <SDL_events.h>
+#include <SDL_gamecontroller.h>
+#include "../triharder.h"
+
+namespace TriHarder {
+
+    //! @typedef ActionId
+    //! @brief Identifier of a game action such as "jump" or "fire" bound to physical inputs.
+    using ActionId = uint16_t;
+
+    //! @struct InputLatencyStats
+    //! @brief Latency between input events and the presentation of the frame that consumed them.
+    struct InputLatencyStats {
+        uint64_t Frames = 0;                  //!< Number of frames that consumed at least one input event.
+        double AverageEventToPresentMs = 0.0; //!< Average time from the SDL event timestamp to present.
+        double MaxEventToPresentMs = 0.0;     //!< Worst time from the SDL event timestamp to present.
+        double AverageSampleToPresentMs = 0.0;//!< Average time from sampling the event to present.
+        double MaxSampleToPresentMs = 0.0;    //!< Worst time from sampling the event to present.
+    };
+
+    //! @class Input
+    //! @brief Keeps keyboard, mouse and gamepad state with per-frame pressed and released edges.
+    //!
+    //! State is stored in bitsets; pressed and released edges are latched as events arrive and
+    //! only cleared by beginFrame(), so a press and release within one sample is not lost.
+    //! Events can be sampled several times per frame (e.g. before simulation and again right
+    //! before rendering) to keep the input-to-photon latency low; edges of a later sample stay
+    //! visible for the rest of the frame. Actions map physical inputs
+    //! through flat lookup tables, so resolving an event or querying an action is O(1).
+    class Input {
+    public:
+        static constexpr size_t MaxActions = 256;
+        static constexpr size_t MaxMouseButtons = 8;
+        static constexpr size_t MaxGamepads = 4;
+        static constexpr ActionId NoAction = 0xFFFF;
+
+        using KeySet = std::bitset<SDL_NUM_SCANCODES>;
+        using MouseButtonSet = std::bitset<MaxMouseButtons>;
+        using GamepadButtonSet = std::bitset<SDL_CONTROLLER_BUTTON_MAX>;
+        using ActionSet = std::bitset<MaxActions>;
+
+        Input();
+        ~Input();
+
+        Input(const Input&) = delete;
+        Input& operator=(const Input&) = delete;
+
+        //! Initializes the SDL game controller subsystem and opens connected gamepads.
+        void initialize();
+
+        //! Clears the latched edges and per-frame deltas.
+        //! Call once at the start of every frame before sampling.
+        void beginFrame();
+
+        //! Updates the state from an SDL event.
+        //! @return True if the event was an input event.
+        bool processEvent(const SDL_Event& event);
+
+        //! Records that the current frame has been presented and updates the latency statistics.
+        void markPresented();
+
+        //! Releases every held key and button and disconnects all gamepads. Bindings are kept.
+        void reset();
+
+        // Keyboard
+        [[nodiscard]] bool isKeyDown(SDL_Scancode key) const { return keys_.test(key); }
+        [[nodiscard]] bool isKeyPressed(SDL_Scancode key) const { return pressedKeys_.test(key); }
+        [[nodiscard]] bool isKeyReleased(SDL_Scancode key) const { return releasedKeys_.test(key); }
+
+        // Mouse
+        [[nodiscard]] bool isMouseButtonDown(uint8_t button) const { return mouseButtons_.test(toMouseIndex(button)); }
+        [[nodiscard]] bool isMouseButtonPressed(uint8_t button) const { return pressedMouseButtons_.test(toMouseIndex(button)); }
+        [[nodiscard]] bool isMouseButtonReleased(uint8_t button) const { return releasedMouseButtons_.test(toMouseIndex(button)); }
+        [[nodiscard]] int32_t getMouseX() const { return mouseX_; }
+        [[nodiscard]] int32_t getMouseY() const { return mouseY_; }
+        [[nodiscard]] int32_t getMouseDeltaX() const { return mouseDeltaX_; }
+        [[nodiscard]] int32_t getMouseDeltaY() const { return mouseDeltaY_; }
+        [[nodiscard]] float getMouseWheel() const { return mouseWheel_; }
+
+        // Gamepads
+        [[nodiscard]] bool isGamepadConnected(size_t pad) const { return pad < MaxGamepads && gamepads_[pad].Connected; }
+        //! @return The SDL instance id of the gamepad, -1 if the slot is empty.
+        [[nodiscard]] SDL_JoystickID getGamepadInstanceId(size_t pad) const;
+        //! Connects a gamepad without a device that is driven by events only, e.g. during a replay.
+        void connectVirtualGamepad(SDL_JoystickID instanceId);
+        [[nodiscard]] bool isGamepadButtonDown(size_t pad, uint8_t button) const;
+        [[nodiscard]] bool isGamepadButtonPressed(size_t pad, uint8_t button) const;
+        [[nodiscard]] bool isGamepadButtonReleased(size_t pad, uint8_t button) const;
+        //! @return The axis value normalized to [-1, 1].
+        [[nodiscard]] float getGamepadAxis(size_t pad, uint8_t axis) const;
+
+        // Actions
+        void bindKey(ActionId action, SDL_Scancode key);
+        void bindMouseButton(ActionId action, uint8_t button);
+        void bindGamepadButton(ActionId action, uint8_t button);
+        void clearBindings();
+
+        [[nodiscard]] bool isActionDown(ActionId action) const { return actions_.test(action); }
+        [[nodiscard]] bool isActionPressed(ActionId action) const { return pressedActions_.test(action); }
+        [[nodiscard]] bool isActionReleased(ActionId action) const { return releasedActions_.test(action); }
+
+        [[nodiscard]] const InputLatencyStats& getLatencyStats() const { return latency_; }
+        void resetLatencyStats() { latency_ = InputLatencyStats(); }
+
+    private:
+        struct Gamepad {
+            SDL_GameController* Controller = nullptr;
+            SDL_JoystickID InstanceId = -1;
+            bool Connected = false; //!< Virtual gamepads are connected without a Controller.
+            GamepadButtonSet Buttons;
+            GamepadButtonSet PressedButtons;
+            GamepadButtonSet ReleasedButtons;
+            std::array<int16_t, SDL_CONTROLLER_AXIS_MAX> Axes{};
+        };
+
+        KeySet keys_;
+        KeySet pressedKeys_;
+        KeySet releasedKeys_;
+        MouseButtonSet mouseButtons_;
+        MouseButtonSet pressedMouseButtons_;
+        MouseButtonSet releasedMouseButtons_;
+        int32_t mouseX_ = 0;
+        int32_t mouseY_ = 0;
+        int32_t mouseDeltaX_ = 0;
+        int32_t mouseDeltaY_ = 0;
+        float mouseWheel_ = 0.0f;
+        std::array<Gamepad, MaxGamepads> gamepads_;
+
+        std::array<ActionId, SDL_NUM_SCANCODES> keyActions_;
+        std::array<ActionId, MaxMouseButtons> mouseActions_;
+        std::array<ActionId, SDL_CONTROLLER_BUTTON_MAX> gamepadActions_;
+        std::array<uint8_t, MaxActions> actionHoldCounts_{};
+        ActionSet actions_;
+        ActionSet pressedActions_;
+        ActionSet releasedActions_;
+
+        // Oldest input consumed since the last present, used for the latency measurement
+        bool hasPendingInput_ = false;
+        uint32_t pendingEventTicks_ = 0;
+        uint64_t pendingSampleCounter_ = 0;
+        InputLatencyStats latency_;
+
+        static size_t toMouseIndex(uint8_t button) { return (button - 1u) % MaxMouseButtons; }
+
+        void updateAction(ActionId action, bool down);
+        void notePendingInput(uint32_t eventTicks);
+        void openGamepad(int deviceIndex);
+        void closeGamepad(SDL_JoystickID instanceId);
+        Gamepad* findGamepad(SDL_JoystickID instanceId);
+    };
+}
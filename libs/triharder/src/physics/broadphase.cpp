@@ -0,0 +1,65 @@
+#include "broadphase.h"
+#include <algorithm>
+#include <cstring>
+#include "../core/job_system.h"
+
+namespace TriHarder {
+
+    bool intersectRay(const Aabb& box, const Float3& origin, const Float3& inverseDirection,
+                      float maxDistance, float& distance) {
+        float entry = 0.0f;
+        float exit = maxDistance;
+        for (int axis = 0; axis < 3; ++axis) {
+            float t0 = (box.Min[axis] - origin[axis]) * inverseDirection[axis];
+            float t1 = (box.Max[axis] - origin[axis]) * inverseDirection[axis];
+            if (t0 > t1) {
+                std::swap(t0, t1);
+            }
+            // Written so that NaN from a zero direction on the slab boundary keeps the previous bounds
+            entry = t0 > entry ? t0 : entry;
+            exit = t1 < exit ? t1 : exit;
+            if (entry > exit) {
+                return false;
+            }
+        }
+        distance = entry;
+        return true;
+    }
+
+    bool overlapsSphere(const Aabb& box, const Float3& center, float radius) {
+        float distanceSquared = 0.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            float closest = std::clamp(center[axis], box.Min[axis], box.Max[axis]);
+            float delta = center[axis] - closest;
+            distanceSquared += delta * delta;
+        }
+        return distanceSquared <= radius * radius;
+    }
+
+    void PairCollector::begin() {
+        buffers_.resize(JobSystem::getInstance().getWorkerSlotCount());
+        for (auto& buffer : buffers_) {
+            buffer.clear();
+        }
+    }
+
+    void PairCollector::merge(std::vector<BroadphasePair>& output) {
+        offsets_.resize(buffers_.size());
+        size_t total = 0;
+        for (size_t i = 0; i < buffers_.size(); ++i) {
+            offsets_[i] = total;
+            total += buffers_[i].size();
+        }
+
+        // Every buffer owns a disjoint range of the output, so the copies need no synchronization
+        output.resize(total);
+        JobSystem::getInstance().parallelFor(buffers_.size(), 1, [this, &output](size_t begin, size_t end, uint32_t) {
+            for (size_t i = begin; i < end; ++i) {
+                if (!buffers_[i].empty()) {
+                    std::memcpy(output.data() + offsets_[i], buffers_[i].data(),
+                                buffers_[i].size() * sizeof(BroadphasePair));
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "../triharder.h"
+#include "../core/vector_math.h"
+
+namespace TriHarder {
+
+    //! @struct Aabb
+    //! @brief An axis aligned bounding box.
+    struct Aabb {
+        Float3 Min;
+        Float3 Max;
+
+        [[nodiscard]] bool overlaps(const Aabb& other) const {
+            return Min.X <= other.Max.X && other.Min.X <= Max.X
+                && Min.Y <= other.Max.Y && other.Min.Y <= Max.Y
+                && Min.Z <= other.Max.Z && other.Min.Z <= Max.Z;
+        }
+    };
+
+    //! Identifies an object registered with a broadphase.
+    using ProxyId = uint32_t;
+    static constexpr ProxyId InvalidProxy = ~0u;
+
+    //! @struct BroadphasePair
+    //! @brief Two proxies with overlapping bounds, A < B.
+    struct BroadphasePair {
+        ProxyId A;
+        ProxyId B;
+
+        bool operator==(const BroadphasePair&) const = default;
+    };
+
+    //! @struct RaycastHit
+    //! @brief A proxy whose bounds are crossed by a ray.
+    struct RaycastHit {
+        ProxyId Proxy;
+        float Distance; //!< Distance along the ray where it enters the bounds, 0 if the origin is inside.
+    };
+
+    //! Intersects a ray with a box using the slab method.
+    //! @param inverseDirection Component-wise reciprocal of the ray direction.
+    //! @return True if the box is hit within [0, maxDistance], distance receives the entry point.
+    bool intersectRay(const Aabb& box, const Float3& origin, const Float3& inverseDirection,
+                      float maxDistance, float& distance);
+
+    //! @return True if the sphere touches the box.
+    bool overlapsSphere(const Aabb& box, const Float3& center, float radius);
+
+    //! @class PairCollector
+    //! @brief Per worker pair buffers that are merged without locks.
+    //!
+    //! Every job appends to the buffer of its worker slot. merge() computes the offset
+    //! of each buffer with a prefix sum and copies the buffers into their ranges of the
+    //! output in parallel.
+    class PairCollector {
+    public:
+        //! Clears the buffers and sizes them for the current job system.
+        void begin();
+
+        [[nodiscard]] std::vector<BroadphasePair>& getBuffer(uint32_t worker) { return buffers_[worker]; }
+
+        //! Writes all collected pairs to output, replacing its contents.
+        void merge(std::vector<BroadphasePair>& output);
+
+    private:
+        std::vector<std::vector<BroadphasePair>> buffers_;
+        std::vector<size_t> offsets_;
+    };
+
+    //! @class IBroadphase
+    //! @brief Finds potentially colliding objects and answers spatial queries.
+    //!
+    //! Meant to be driven from IScene::updateTick(): move the proxies of objects that
+    //! changed, call update(), then findPairs() for the narrow phase. Queries reflect
+    //! the state of the last update() and may run concurrently with each other.
+    class IBroadphase {
+    public:
+        virtual ~IBroadphase() = default;
+
+        //! Registers an object with the given bounds.
+        virtual ProxyId createProxy(const Aabb& bounds, uint64_t userData) = 0;
+
+        virtual void destroyProxy(ProxyId proxy) = 0;
+
+        //! Changes the bounds of a proxy. Only objects that actually moved need to be updated.
+        virtual void moveProxy(ProxyId proxy, const Aabb& bounds) = 0;
+
+        //! Applies the changes since the last update.
+        virtual void update() = 0;
+
+        //! Collects all pairs of proxies with overlapping bounds. The order of the pairs is unspecified.
+        virtual void findPairs(std::vector<BroadphasePair>& pairs) = 0;
+
+        //! Appends the proxies whose bounds overlap the box.
+        virtual void queryAabb(const Aabb& box, std::vector<ProxyId>& results) const = 0;
+
+        //! Appends the proxies whose bounds touch the sphere.
+        virtual void queryRadius(const Float3& center, float radius, std::vector<ProxyId>& results) const = 0;
+
+        //! Appends the proxies whose bounds are crossed by the ray, nearest first.
+        //! @param direction Normalized ray direction.
+        virtual void raycast(const Float3& origin, const Float3& direction, float maxDistance,
+                             std::vector<RaycastHit>& hits) const = 0;
+
+        [[nodiscard]] virtual const Aabb& getBounds(ProxyId proxy) const = 0;
+        [[nodiscard]] virtual uint64_t getUserData(ProxyId proxy) const = 0;
+        [[nodiscard]] virtual size_t getProxyCount() const = 0;
+    };
+}
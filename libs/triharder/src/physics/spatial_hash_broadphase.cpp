@@ -0,0 +1,383 @@
+#include "spatial_hash_broadphase.h"
+#include <algorithm>
+#include <cmath>
+#include "../core/job_system.h"
+
+namespace TriHarder {
+
+    //! Cell coordinates are clamped so they fit into 21 bits each of the packed key.
+    static constexpr int32_t CellLimit = (1 << 20) - 1;
+
+    static int32_t toCell(float value, float inverseCellSize) {
+        float cell = std::floor(value * inverseCellSize);
+        return static_cast<int32_t>(std::clamp(cell, float(-CellLimit), float(CellLimit)));
+    }
+
+    //! Sorts raycast hits appended after first by distance and drops duplicates from neighbouring cells.
+    static void finishHits(std::vector<RaycastHit>& hits, size_t first) {
+        auto begin = hits.begin() + static_cast<std::ptrdiff_t>(first);
+        std::sort(begin, hits.end(), [](const RaycastHit& a, const RaycastHit& b) {
+            return a.Proxy < b.Proxy;
+        });
+        hits.erase(std::unique(begin, hits.end(), [](const RaycastHit& a, const RaycastHit& b) {
+            return a.Proxy == b.Proxy;
+        }), hits.end());
+        std::sort(begin, hits.end(), [](const RaycastHit& a, const RaycastHit& b) {
+            return a.Distance < b.Distance;
+        });
+    }
+
+    SpatialHashBroadphase::SpatialHashBroadphase(float cellSize)
+        : cellSize_(cellSize), inverseCellSize_(1.0f / cellSize) {}
+
+    SpatialHashBroadphase::CellRange SpatialHashBroadphase::getCellRange(const Aabb& bounds) const {
+        CellRange range{};
+        for (int axis = 0; axis < 3; ++axis) {
+            range.Min[axis] = toCell(bounds.Min[axis], inverseCellSize_);
+            range.Max[axis] = toCell(bounds.Max[axis], inverseCellSize_);
+        }
+        return range;
+    }
+
+    uint64_t SpatialHashBroadphase::getCellCount(const CellRange& range) {
+        uint64_t count = 1;
+        for (int axis = 0; axis < 3; ++axis) {
+            count *= uint64_t(range.Max[axis] - range.Min[axis] + 1);
+        }
+        return count;
+    }
+
+    uint64_t SpatialHashBroadphase::packCell(int32_t x, int32_t y, int32_t z) {
+        constexpr uint64_t Mask = (1ull << 21) - 1;
+        return ((uint64_t(x) & Mask) << 42) | ((uint64_t(y) & Mask) << 21) | (uint64_t(z) & Mask);
+    }
+
+    ProxyId SpatialHashBroadphase::createProxy(const Aabb& bounds, uint64_t userData) {
+        ProxyId id;
+        if (!freeProxies_.empty()) {
+            id = freeProxies_.back();
+            freeProxies_.pop_back();
+        } else {
+            id = static_cast<ProxyId>(proxies_.size());
+            proxies_.emplace_back();
+        }
+
+        auto& proxy = proxies_[id];
+        proxy.PendingBounds = bounds;
+        proxy.UserData = userData;
+        proxy.Alive = true;
+        proxy.InGrid = false;
+        proxy.Pending = true;
+        pendingProxies_.push_back(id);
+        proxyCount_++;
+        return id;
+    }
+
+    void SpatialHashBroadphase::destroyProxy(ProxyId proxy) {
+        if (proxy >= proxies_.size() || !proxies_[proxy].Alive) {
+            return;
+        }
+        auto& entry = proxies_[proxy];
+        if (entry.InGrid) {
+            remove(proxy);
+        }
+        // A queued change of a destroyed proxy is skipped, even if the id is reused before the next update
+        entry.Alive = false;
+        entry.InGrid = false;
+        entry.Pending = false;
+        freeProxies_.push_back(proxy);
+        proxyCount_--;
+    }
+
+    void SpatialHashBroadphase::moveProxy(ProxyId proxy, const Aabb& bounds) {
+        auto& entry = proxies_[proxy];
+        entry.PendingBounds = bounds;
+        if (!entry.Pending) {
+            entry.Pending = true;
+            pendingProxies_.push_back(proxy);
+        }
+    }
+
+    const Aabb& SpatialHashBroadphase::getBounds(ProxyId proxy) const {
+        const auto& entry = proxies_[proxy];
+        return entry.Pending ? entry.PendingBounds : entry.Bounds;
+    }
+
+    void SpatialHashBroadphase::update() {
+        for (ProxyId id : pendingProxies_) {
+            auto& entry = proxies_[id];
+            if (!entry.Pending) {
+                continue;
+            }
+            entry.Pending = false;
+
+            if (!entry.InGrid) {
+                entry.Bounds = entry.PendingBounds;
+                entry.InGrid = true;
+                insert(id);
+                continue;
+            }
+
+            auto range = getCellRange(entry.PendingBounds);
+            bool large = getCellCount(range) > MaxCellsPerProxy;
+            if (range == entry.Cells && large == entry.Large) {
+                // Still covering the same cells, the hash map is not touched
+                entry.Bounds = entry.PendingBounds;
+                continue;
+            }
+
+            remove(id);
+            entry.Bounds = entry.PendingBounds;
+            insert(id);
+        }
+        pendingProxies_.clear();
+    }
+
+    void SpatialHashBroadphase::insert(ProxyId id) {
+        auto& proxy = proxies_[id];
+        proxy.Cells = getCellRange(proxy.Bounds);
+        proxy.Large = getCellCount(proxy.Cells) > MaxCellsPerProxy;
+        if (proxy.Large) {
+            largeProxies_.push_back(id);
+            return;
+        }
+
+        const auto& range = proxy.Cells;
+        for (int32_t x = range.Min[0]; x <= range.Max[0]; ++x) {
+            for (int32_t y = range.Min[1]; y <= range.Max[1]; ++y) {
+                for (int32_t z = range.Min[2]; z <= range.Max[2]; ++z) {
+                    auto [it, inserted] = cellLookup_.try_emplace(packCell(x, y, z), 0);
+                    if (inserted) {
+                        if (!freeCells_.empty()) {
+                            it->second = freeCells_.back();
+                            freeCells_.pop_back();
+                        } else {
+                            it->second = static_cast<uint32_t>(cells_.size());
+                            cells_.emplace_back();
+                        }
+                        auto& cell = cells_[it->second];
+                        cell.Coordinates[0] = x;
+                        cell.Coordinates[1] = y;
+                        cell.Coordinates[2] = z;
+                    }
+                    cells_[it->second].Proxies.push_back(id);
+                }
+            }
+        }
+    }
+
+    void SpatialHashBroadphase::remove(ProxyId id) {
+        const auto& proxy = proxies_[id];
+        if (proxy.Large) {
+            auto it = std::find(largeProxies_.begin(), largeProxies_.end(), id);
+            *it = largeProxies_.back();
+            largeProxies_.pop_back();
+            return;
+        }
+
+        const auto& range = proxy.Cells;
+        for (int32_t x = range.Min[0]; x <= range.Max[0]; ++x) {
+            for (int32_t y = range.Min[1]; y <= range.Max[1]; ++y) {
+                for (int32_t z = range.Min[2]; z <= range.Max[2]; ++z) {
+                    auto it = cellLookup_.find(packCell(x, y, z));
+                    auto& ids = cells_[it->second].Proxies;
+                    auto position = std::find(ids.begin(), ids.end(), id);
+                    *position = ids.back();
+                    ids.pop_back();
+
+                    // Keep the vector of an emptied cell, its capacity is reused by the next cell
+                    if (ids.empty()) {
+                        freeCells_.push_back(it->second);
+                        cellLookup_.erase(it);
+                    }
+                }
+            }
+        }
+    }
+
+    template<typename F>
+    void SpatialHashBroadphase::visitGrid(const Aabb& box, F&& visit) const {
+        auto range = getCellRange(box);
+        auto visitCell = [&](const Cell& cell) {
+            for (ProxyId id : cell.Proxies) {
+                const auto& proxy = proxies_[id];
+                // Report the proxy only from the first cell shared by the box and the proxy
+                bool owner = true;
+                for (int axis = 0; axis < 3; ++axis) {
+                    owner &= cell.Coordinates[axis] == std::max(range.Min[axis], proxy.Cells.Min[axis]);
+                }
+                if (owner && proxy.Bounds.overlaps(box)) {
+                    visit(id);
+                }
+            }
+        };
+
+        if (getCellCount(range) > cellLookup_.size()) {
+            // Scanning the occupied cells is cheaper than probing every cell of a large box
+            for (const auto& cell : cells_) {
+                bool inside = !cell.Proxies.empty();
+                for (int axis = 0; axis < 3; ++axis) {
+                    inside &= cell.Coordinates[axis] >= range.Min[axis] && cell.Coordinates[axis] <= range.Max[axis];
+                }
+                if (inside) {
+                    visitCell(cell);
+                }
+            }
+            return;
+        }
+
+        for (int32_t x = range.Min[0]; x <= range.Max[0]; ++x) {
+            for (int32_t y = range.Min[1]; y <= range.Max[1]; ++y) {
+                for (int32_t z = range.Min[2]; z <= range.Max[2]; ++z) {
+                    auto it = cellLookup_.find(packCell(x, y, z));
+                    if (it != cellLookup_.end()) {
+                        visitCell(cells_[it->second]);
+                    }
+                }
+            }
+        }
+    }
+
+    void SpatialHashBroadphase::findPairs(std::vector<BroadphasePair>& pairs) {
+        if (!pendingProxies_.empty()) {
+            update();
+        }
+
+        collector_.begin();
+        auto& jobs = JobSystem::getInstance();
+
+        jobs.parallelFor(cells_.size(), 64, [this](size_t begin, size_t end, uint32_t worker) {
+            auto& output = collector_.getBuffer(worker);
+            for (size_t c = begin; c < end; ++c) {
+                const auto& cell = cells_[c];
+                const auto& ids = cell.Proxies;
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    const auto& a = proxies_[ids[i]];
+                    for (size_t j = i + 1; j < ids.size(); ++j) {
+                        const auto& b = proxies_[ids[j]];
+                        // Pairs sharing several cells are reported by the first shared cell only
+                        if (cell.Coordinates[0] != std::max(a.Cells.Min[0], b.Cells.Min[0])
+                            || cell.Coordinates[1] != std::max(a.Cells.Min[1], b.Cells.Min[1])
+                            || cell.Coordinates[2] != std::max(a.Cells.Min[2], b.Cells.Min[2])
+                            || !a.Bounds.overlaps(b.Bounds)) {
+                            continue;
+                        }
+                        output.push_back({std::min(ids[i], ids[j]), std::max(ids[i], ids[j])});
+                    }
+                }
+            }
+        });
+
+        jobs.parallelFor(largeProxies_.size(), 1, [this](size_t begin, size_t end, uint32_t worker) {
+            auto& output = collector_.getBuffer(worker);
+            for (size_t k = begin; k < end; ++k) {
+                ProxyId id = largeProxies_[k];
+                const auto& bounds = proxies_[id].Bounds;
+                visitGrid(bounds, [&](ProxyId other) {
+                    output.push_back({std::min(id, other), std::max(id, other)});
+                });
+                for (size_t m = k + 1; m < largeProxies_.size(); ++m) {
+                    ProxyId other = largeProxies_[m];
+                    if (bounds.overlaps(proxies_[other].Bounds)) {
+                        output.push_back({std::min(id, other), std::max(id, other)});
+                    }
+                }
+            }
+        });
+
+        collector_.merge(pairs);
+    }
+
+    void SpatialHashBroadphase::queryAabb(const Aabb& box, std::vector<ProxyId>& results) const {
+        visitGrid(box, [&](ProxyId id) { results.push_back(id); });
+        for (ProxyId id : largeProxies_) {
+            if (proxies_[id].Bounds.overlaps(box)) {
+                results.push_back(id);
+            }
+        }
+    }
+
+    void SpatialHashBroadphase::queryRadius(const Float3& center, float radius, std::vector<ProxyId>& results) const {
+        Aabb box{{center.X - radius, center.Y - radius, center.Z - radius},
+                 {center.X + radius, center.Y + radius, center.Z + radius}};
+        visitGrid(box, [&](ProxyId id) {
+            if (overlapsSphere(proxies_[id].Bounds, center, radius)) {
+                results.push_back(id);
+            }
+        });
+        for (ProxyId id : largeProxies_) {
+            if (overlapsSphere(proxies_[id].Bounds, center, radius)) {
+                results.push_back(id);
+            }
+        }
+    }
+
+    void SpatialHashBroadphase::raycast(const Float3& origin, const Float3& direction, float maxDistance,
+                                        std::vector<RaycastHit>& hits) const {
+        size_t first = hits.size();
+        Float3 inverse{1.0f / direction.X, 1.0f / direction.Y, 1.0f / direction.Z};
+        auto test = [&](ProxyId id) {
+            float distance = 0.0f;
+            if (intersectRay(proxies_[id].Bounds, origin, inverse, maxDistance, distance)) {
+                hits.push_back({id, distance});
+            }
+        };
+
+        // An unbounded ray cannot be walked through the grid, and a ray crossing more cells than
+        // there are proxies is cheaper to test against every proxy
+        double cellSteps = double(maxDistance) * double(inverseCellSize_) * 3.0 + 3.0;
+        if (!std::isfinite(maxDistance) || cellSteps > double(proxies_.size())) {
+            for (ProxyId id = 0; id < proxies_.size(); ++id) {
+                if (proxies_[id].InGrid) {
+                    test(id);
+                }
+            }
+            finishHits(hits, first);
+            return;
+        }
+
+        // Walk the cells along the ray (Amanatides & Woo)
+        int32_t cell[3];
+        int32_t step[3];
+        float next[3];
+        float delta[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            cell[axis] = toCell(origin[axis], inverseCellSize_);
+            if (direction[axis] > 0.0f) {
+                step[axis] = 1;
+                next[axis] = (float(cell[axis] + 1) * cellSize_ - origin[axis]) * inverse[axis];
+                delta[axis] = cellSize_ * inverse[axis];
+            } else if (direction[axis] < 0.0f) {
+                step[axis] = -1;
+                next[axis] = (float(cell[axis]) * cellSize_ - origin[axis]) * inverse[axis];
+                delta[axis] = -cellSize_ * inverse[axis];
+            } else {
+                step[axis] = 0;
+                next[axis] = std::numeric_limits<float>::infinity();
+                delta[axis] = 0.0f;
+            }
+        }
+
+        auto maxSteps = static_cast<uint64_t>(cellSteps);
+        for (uint64_t i = 0; i < maxSteps; ++i) {
+            auto it = cellLookup_.find(packCell(cell[0], cell[1], cell[2]));
+            if (it != cellLookup_.end()) {
+                for (ProxyId id : cells_[it->second].Proxies) {
+                    test(id);
+                }
+            }
+
+            int axis = next[0] < next[1] ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2);
+            if (next[axis] > maxDistance) {
+                break;
+            }
+            cell[axis] += step[axis];
+            next[axis] += delta[axis];
+        }
+
+        for (ProxyId id : largeProxies_) {
+            test(id);
+        }
+        finishHits(hits, first);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <unordered_map>
+#include "broadphase.h"
+
+namespace TriHarder {
+
+    //! @class SpatialHashBroadphase
+    //! @brief A uniform grid stored in a hash map of occupied cells.
+    //!
+    //! Proxies are inserted into every cell their bounds touch. New and moved proxies
+    //! are queued and applied to the grid by update(). Moving a proxy only touches the
+    //! hash map if its cell range changed, which makes small movements almost free. A pair or query result shared by several cells is reported only by
+    //! the cell holding the minimum corner of the overlap, so no deduplication pass is
+    //! needed. Proxies spanning more than MaxCellsPerProxy cells are kept in a separate
+    //! list and tested against the grid instead.
+    //!
+    //! Works best when the cell size is about the size of a typical object.
+    class SpatialHashBroadphase : public IBroadphase {
+    public:
+        explicit SpatialHashBroadphase(float cellSize = 1.0f);
+
+        ProxyId createProxy(const Aabb& bounds, uint64_t userData) override;
+        void destroyProxy(ProxyId proxy) override;
+        void moveProxy(ProxyId proxy, const Aabb& bounds) override;
+        void update() override;
+        void findPairs(std::vector<BroadphasePair>& pairs) override;
+        void queryAabb(const Aabb& box, std::vector<ProxyId>& results) const override;
+        void queryRadius(const Float3& center, float radius, std::vector<ProxyId>& results) const override;
+        void raycast(const Float3& origin, const Float3& direction, float maxDistance,
+                     std::vector<RaycastHit>& hits) const override;
+
+        [[nodiscard]] const Aabb& getBounds(ProxyId proxy) const override;
+        [[nodiscard]] uint64_t getUserData(ProxyId proxy) const override { return proxies_[proxy].UserData; }
+        [[nodiscard]] size_t getProxyCount() const override { return proxyCount_; }
+
+        [[nodiscard]] size_t getCellCount() const { return cellLookup_.size(); }
+
+        static constexpr uint64_t MaxCellsPerProxy = 64;
+
+    private:
+        struct CellRange {
+            int32_t Min[3];
+            int32_t Max[3];
+
+            bool operator==(const CellRange&) const = default;
+        };
+
+        struct Proxy {
+            Aabb Bounds; //!< Bounds stored in the grid, seen by queries.
+            Aabb PendingBounds; //!< Bounds applied by the next update().
+            uint64_t UserData = 0;
+            CellRange Cells{};
+            bool Large = false;
+            bool Alive = false;
+            bool InGrid = false;
+            bool Pending = false;
+        };
+
+        struct Cell {
+            int32_t Coordinates[3];
+            std::vector<ProxyId> Proxies;
+        };
+
+        [[nodiscard]] CellRange getCellRange(const Aabb& bounds) const;
+        [[nodiscard]] static uint64_t getCellCount(const CellRange& range);
+        [[nodiscard]] static uint64_t packCell(int32_t x, int32_t y, int32_t z);
+
+        void insert(ProxyId proxy);
+        void remove(ProxyId proxy);
+
+        //! Calls visit(proxy) once for every grid proxy overlapping the box.
+        template<typename F>
+        void visitGrid(const Aabb& box, F&& visit) const;
+
+        float cellSize_;
+        float inverseCellSize_;
+        std::vector<Proxy> proxies_;
+        std::vector<ProxyId> freeProxies_;
+        std::vector<ProxyId> largeProxies_;
+        std::vector<ProxyId> pendingProxies_;
+        size_t proxyCount_ = 0;
+
+        std::vector<Cell> cells_;
+        std::vector<uint32_t> freeCells_;
+        std::unordered_map<uint64_t, uint32_t> cellLookup_;
+        PairCollector collector_;
+    };
+}
@@ -0,0 +1,324 @@
+#include "sweep_and_prune_broadphase.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <type_traits>
+#include "../core/job_system.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define TRIHARDER_BROADPHASE_SSE2 1
+#else
+#define TRIHARDER_BROADPHASE_SSE2 0
+#endif
+
+namespace TriHarder {
+
+    //! A full sort is cheaper than insertion sorting this fraction of newly added entries.
+    static constexpr size_t FullSortFraction = 8;
+
+    //! Switch to another axis only if its spread is clearly larger, so the axis does not flip every frame.
+    static constexpr float AxisSwitchRatio = 1.5f;
+
+    template<int Axis>
+    static float minOn(const Aabb& box) {
+        if constexpr (Axis == 0) {
+            return box.Min.X;
+        } else if constexpr (Axis == 1) {
+            return box.Min.Y;
+        } else {
+            return box.Min.Z;
+        }
+    }
+
+    template<int Axis>
+    static float maxOn(const Aabb& box) {
+        if constexpr (Axis == 0) {
+            return box.Max.X;
+        } else if constexpr (Axis == 1) {
+            return box.Max.Y;
+        } else {
+            return box.Max.Z;
+        }
+    }
+
+    //! Calls function with the axis as a compile time constant.
+    template<typename F>
+    static void dispatchAxis(int axis, F&& function) {
+        switch (axis) {
+            case 0:
+                function(std::integral_constant<int, 0>());
+                break;
+            case 1:
+                function(std::integral_constant<int, 1>());
+                break;
+            default:
+                function(std::integral_constant<int, 2>());
+                break;
+        }
+    }
+
+    ProxyId SweepAndPruneBroadphase::createProxy(const Aabb& bounds, uint64_t userData) {
+        ProxyId id;
+        if (!freeProxies_.empty()) {
+            id = freeProxies_.back();
+            freeProxies_.pop_back();
+        } else {
+            id = static_cast<ProxyId>(proxies_.size());
+            proxies_.emplace_back();
+        }
+
+        proxies_[id] = {bounds, userData, true};
+        pendingCreate_.push_back(id);
+        proxyCount_++;
+        dirty_ = true;
+        return id;
+    }
+
+    void SweepAndPruneBroadphase::destroyProxy(ProxyId proxy) {
+        if (proxy >= proxies_.size() || !proxies_[proxy].Alive) {
+            return;
+        }
+        proxies_[proxy].Alive = false;
+        pendingDestroy_.push_back(proxy);
+        proxyCount_--;
+        dirty_ = true;
+    }
+
+    void SweepAndPruneBroadphase::moveProxy(ProxyId proxy, const Aabb& bounds) {
+        // The sorted entries keep the old bounds for queries until the next update
+        proxies_[proxy].Bounds = bounds;
+        dirty_ = true;
+    }
+
+    const Aabb& SweepAndPruneBroadphase::getBounds(ProxyId proxy) const {
+        return proxies_[proxy].Bounds;
+    }
+
+    void SweepAndPruneBroadphase::update() {
+        if (!pendingDestroy_.empty()) {
+            std::erase_if(entries_, [this](const Entry& entry) { return !proxies_[entry.Proxy].Alive; });
+            freeProxies_.insert(freeProxies_.end(), pendingDestroy_.begin(), pendingDestroy_.end());
+            pendingDestroy_.clear();
+        }
+
+        for (auto& entry : entries_) {
+            entry.Bounds = proxies_[entry.Proxy].Bounds;
+        }
+        size_t created = 0;
+        for (ProxyId id : pendingCreate_) {
+            // Proxies destroyed before their first update never get an entry
+            if (proxies_[id].Alive) {
+                entries_.push_back({proxies_[id].Bounds, id});
+                created++;
+            }
+        }
+        pendingCreate_.clear();
+
+        selectAxis();
+        if (needsFullSort_ || created * FullSortFraction > entries_.size()) {
+            dispatchAxis(axis_, [this](auto axis) {
+                constexpr int Axis = decltype(axis)::value;
+                std::sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+                    return minOn<Axis>(a.Bounds) < minOn<Axis>(b.Bounds);
+                });
+            });
+        } else {
+            insertionSort();
+        }
+
+        buildSweepArrays();
+        needsFullSort_ = false;
+        dirty_ = false;
+    }
+
+    void SweepAndPruneBroadphase::buildSweepArrays() {
+        const int axes[3] = {axis_, (axis_ + 1) % 3, (axis_ + 2) % 3};
+        for (int k = 0; k < 3; ++k) {
+            sweepMin_[k].resize(entries_.size());
+            sweepMax_[k].resize(entries_.size());
+            for (size_t i = 0; i < entries_.size(); ++i) {
+                sweepMin_[k][i] = entries_[i].Bounds.Min[axes[k]];
+                sweepMax_[k][i] = entries_[i].Bounds.Max[axes[k]];
+            }
+        }
+    }
+
+    void SweepAndPruneBroadphase::selectAxis() {
+        // One pass gathers the spread of the centers and the largest extent on every axis
+        double sum[3] = {};
+        double sumSquares[3] = {};
+        float extent[3] = {};
+        for (const auto& entry : entries_) {
+            for (int axis = 0; axis < 3; ++axis) {
+                double center = 0.5 * (double(entry.Bounds.Min[axis]) + double(entry.Bounds.Max[axis]));
+                sum[axis] += center;
+                sumSquares[axis] += center * center;
+                extent[axis] = std::max(extent[axis], entry.Bounds.Max[axis] - entry.Bounds.Min[axis]);
+            }
+        }
+
+        if (!entries_.empty()) {
+            double count = double(entries_.size());
+            double variance[3];
+            for (int axis = 0; axis < 3; ++axis) {
+                double mean = sum[axis] / count;
+                variance[axis] = sumSquares[axis] / count - mean * mean;
+            }
+
+            int best = int(std::max_element(variance, variance + 3) - variance);
+            if (best != axis_ && variance[best] > variance[axis_] * AxisSwitchRatio) {
+                axis_ = best;
+                needsFullSort_ = true;
+            }
+        }
+        maxExtent_ = extent[axis_];
+    }
+
+    void SweepAndPruneBroadphase::insertionSort() {
+        dispatchAxis(axis_, [this](auto axis) {
+            constexpr int Axis = decltype(axis)::value;
+            for (size_t i = 1; i < entries_.size(); ++i) {
+                if (minOn<Axis>(entries_[i - 1].Bounds) <= minOn<Axis>(entries_[i].Bounds)) {
+                    continue;
+                }
+
+                Entry entry = entries_[i];
+                float key = minOn<Axis>(entry.Bounds);
+                size_t j = i;
+                for (; j > 0 && minOn<Axis>(entries_[j - 1].Bounds) > key; --j) {
+                    entries_[j] = entries_[j - 1];
+                }
+                entries_[j] = entry;
+            }
+        });
+    }
+
+    void SweepAndPruneBroadphase::sweep(size_t begin, size_t end, std::vector<BroadphasePair>& output) const {
+        const size_t count = entries_.size();
+        const float* min0 = sweepMin_[0].data();
+        const float* min1 = sweepMin_[1].data();
+        const float* max1 = sweepMax_[1].data();
+        const float* min2 = sweepMin_[2].data();
+        const float* max2 = sweepMax_[2].data();
+
+        for (size_t i = begin; i < end; ++i) {
+            const float limit = sweepMax_[0][i];
+            const ProxyId a = entries_[i].Proxy;
+            auto emit = [&](size_t j) {
+                ProxyId b = entries_[j].Proxy;
+                output.push_back({std::min(a, b), std::max(a, b)});
+            };
+
+            size_t j = i + 1;
+#if TRIHARDER_BROADPHASE_SSE2
+            // Test four candidates at once; the candidates are sorted, so the first lane
+            // past the limit ends the sweep
+            const __m128 sweepLimit = _mm_set1_ps(limit);
+            const __m128 aMin1 = _mm_set1_ps(min1[i]);
+            const __m128 aMax1 = _mm_set1_ps(max1[i]);
+            const __m128 aMin2 = _mm_set1_ps(min2[i]);
+            const __m128 aMax2 = _mm_set1_ps(max2[i]);
+            bool done = false;
+            for (; j + 4 <= count; j += 4) {
+                int inRange = _mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(min0 + j), sweepLimit));
+                __m128 overlap = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(min1 + j), aMax1),
+                                            _mm_cmple_ps(aMin1, _mm_loadu_ps(max1 + j)));
+                overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(min2 + j), aMax2),
+                                                         _mm_cmple_ps(aMin2, _mm_loadu_ps(max2 + j))));
+                auto mask = static_cast<uint32_t>(_mm_movemask_ps(overlap) & inRange);
+                while (mask != 0) {
+                    emit(j + std::countr_zero(mask));
+                    mask &= mask - 1;
+                }
+                if (inRange != 0xF) {
+                    done = true;
+                    break;
+                }
+            }
+            if (done) {
+                continue;
+            }
+#endif
+            for (; j < count && min0[j] <= limit; ++j) {
+                if (min1[j] <= max1[i] && min1[i] <= max1[j] && min2[j] <= max2[i] && min2[i] <= max2[j]) {
+                    emit(j);
+                }
+            }
+        }
+    }
+
+    void SweepAndPruneBroadphase::findPairs(std::vector<BroadphasePair>& pairs) {
+        if (dirty_) {
+            update();
+        }
+
+        collector_.begin();
+        JobSystem::getInstance().parallelFor(entries_.size(), 1024, [this](size_t begin, size_t end, uint32_t worker) {
+            sweep(begin, end, collector_.getBuffer(worker));
+        });
+        collector_.merge(pairs);
+    }
+
+    template<typename F>
+    void SweepAndPruneBroadphase::visitRange(const Aabb& box, F&& visit) const {
+        dispatchAxis(axis_, [&](auto axis) {
+            constexpr int Axis = decltype(axis)::value;
+            // Every entry overlapping the box starts at most maxExtent_ before it
+            float first = minOn<Axis>(box) - maxExtent_;
+            auto it = std::lower_bound(entries_.begin(), entries_.end(), first, [](const Entry& entry, float value) {
+                return minOn<Axis>(entry.Bounds) < value;
+            });
+            const float last = maxOn<Axis>(box);
+            for (; it != entries_.end() && minOn<Axis>(it->Bounds) <= last; ++it) {
+                if (it->Bounds.overlaps(box) && proxies_[it->Proxy].Alive) {
+                    visit(*it);
+                }
+            }
+        });
+    }
+
+    void SweepAndPruneBroadphase::queryAabb(const Aabb& box, std::vector<ProxyId>& results) const {
+        visitRange(box, [&](const Entry& entry) { results.push_back(entry.Proxy); });
+    }
+
+    void SweepAndPruneBroadphase::queryRadius(const Float3& center, float radius,
+                                              std::vector<ProxyId>& results) const {
+        Aabb box{{center.X - radius, center.Y - radius, center.Z - radius},
+                 {center.X + radius, center.Y + radius, center.Z + radius}};
+        visitRange(box, [&](const Entry& entry) {
+            if (overlapsSphere(entry.Bounds, center, radius)) {
+                results.push_back(entry.Proxy);
+            }
+        });
+    }
+
+    void SweepAndPruneBroadphase::raycast(const Float3& origin, const Float3& direction, float maxDistance,
+                                          std::vector<RaycastHit>& hits) const {
+        size_t first = hits.size();
+        Float3 inverse{1.0f / direction.X, 1.0f / direction.Y, 1.0f / direction.Z};
+        auto test = [&](const Entry& entry) {
+            float distance = 0.0f;
+            if (intersectRay(entry.Bounds, origin, inverse, maxDistance, distance)) {
+                hits.push_back({entry.Proxy, distance});
+            }
+        };
+
+        if (std::isfinite(maxDistance)) {
+            Float3 end{origin.X + direction.X * maxDistance, origin.Y + direction.Y * maxDistance,
+                       origin.Z + direction.Z * maxDistance};
+            Aabb segment{{std::min(origin.X, end.X), std::min(origin.Y, end.Y), std::min(origin.Z, end.Z)},
+                         {std::max(origin.X, end.X), std::max(origin.Y, end.Y), std::max(origin.Z, end.Z)}};
+            visitRange(segment, test);
+        } else {
+            for (const auto& entry : entries_) {
+                if (proxies_[entry.Proxy].Alive) {
+                    test(entry);
+                }
+            }
+        }
+
+        std::sort(hits.begin() + static_cast<std::ptrdiff_t>(first), hits.end(),
+                  [](const RaycastHit& a, const RaycastHit& b) { return a.Distance < b.Distance; });
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "broadphase.h"
+
+namespace TriHarder {
+
+    //! @class SweepAndPruneBroadphase
+    //! @brief Sorts proxies along one axis and sweeps over the overlapping intervals.
+    //!
+    //! The sort axis is the one with the largest spread of object centers. Between
+    //! updates objects move little, so the list is re-sorted with an insertion sort
+    //! that runs in close to linear time; a full sort only happens when the axis
+    //! changes or many proxies were added. Pair generation sweeps from every entry
+    //! independently, which splits evenly across the workers, and tests four
+    //! candidates per step with SSE2.
+    //!
+    //! Created and moved proxies only enter the sorted list in update(), so queries between
+    //! updates see the state of the last update().
+    //!
+    //! Unlike the spatial hash it needs no tuning for object size, but every sweep
+    //! visits all objects within one object size along the sort axis. In large 3D
+    //! worlds with uniformly spread objects that grows faster than linear, so prefer
+    //! the spatial hash beyond about 100k objects.
+    class SweepAndPruneBroadphase : public IBroadphase {
+    public:
+        ProxyId createProxy(const Aabb& bounds, uint64_t userData) override;
+        void destroyProxy(ProxyId proxy) override;
+        void moveProxy(ProxyId proxy, const Aabb& bounds) override;
+        void update() override;
+        void findPairs(std::vector<BroadphasePair>& pairs) override;
+        void queryAabb(const Aabb& box, std::vector<ProxyId>& results) const override;
+        void queryRadius(const Float3& center, float radius, std::vector<ProxyId>& results) const override;
+        void raycast(const Float3& origin, const Float3& direction, float maxDistance,
+                     std::vector<RaycastHit>& hits) const override;
+
+        [[nodiscard]] const Aabb& getBounds(ProxyId proxy) const override;
+        [[nodiscard]] uint64_t getUserData(ProxyId proxy) const override { return proxies_[proxy].UserData; }
+        [[nodiscard]] size_t getProxyCount() const override { return proxyCount_; }
+
+        [[nodiscard]] int getSortAxis() const { return axis_; }
+
+    private:
+        struct Entry {
+            Aabb Bounds;
+            ProxyId Proxy;
+        };
+
+        struct Proxy {
+            Aabb Bounds; //!< Latest bounds, copied into the entry by update().
+            uint64_t UserData = 0;
+            bool Alive = false;
+        };
+
+        void sweep(size_t begin, size_t end, std::vector<BroadphasePair>& output) const;
+
+        //! Calls visit(entry) for every entry of a live proxy overlapping the box.
+        template<typename F>
+        void visitRange(const Aabb& box, F&& visit) const;
+
+        void insertionSort();
+        void selectAxis();
+        void buildSweepArrays();
+
+        std::vector<Entry> entries_;
+        //! Bounds of entries_ as structure of arrays for the SIMD sweep. Index 0 is the sort axis.
+        std::vector<float> sweepMin_[3];
+        std::vector<float> sweepMax_[3];
+        std::vector<Proxy> proxies_;
+        std::vector<ProxyId> freeProxies_;
+        std::vector<ProxyId> pendingDestroy_; //!< Freed once update() removed their entries.
+        std::vector<ProxyId> pendingCreate_; //!< Added to entries_ by the next update().
+        size_t proxyCount_ = 0;
+        int axis_ = 0;
+        bool needsFullSort_ = false;
+        bool dirty_ = false; //!< Set by changes since the last update(), findPairs() updates first.
+        float maxExtent_ = 0.0f; //!< Largest size along the sort axis, bounds the backward search of queries.
+        PairCollector collector_;
+    };
+}
@@ -0,0 +1,118 @@
+#include "audio/audio_system.h"
+#include "core/job_system.h"
+#include "core/sdl_context.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace TriHarder;
+
+// Measures the mixer cost per callback with many voices playing.
+// Usage: AudioBench [--voices N] [--seconds N] [--buffer FRAMES] [--device [DRIVER]]
+// Without --device the mixer is driven directly, which measures the pure mixing cost.
+// --device opens an SDL audio device (default driver "dummy") and reports the callback
+// timing and underrun counters collected while it runs.
+
+static SharedPtr<AudioClip> createTone(float frequency, uint32_t channels, uint32_t sampleRate, float seconds) {
+    auto frames = static_cast<size_t>(seconds * float(sampleRate));
+    std::vector<float> samples(frames * channels);
+    for (size_t i = 0; i < frames; ++i) {
+        float value = 0.2f * std::sin(2.0f * 3.14159265f * frequency * float(i) / float(sampleRate));
+        for (uint32_t channel = 0; channel < channels; ++channel) {
+            samples[i * channels + channel] = value;
+        }
+    }
+    return AudioClip::fromSamples(std::move(samples), channels, sampleRate);
+}
+
+// Half the voices run at the output rate, the others need resampling
+static void startVoices(AudioMixer& mixer, uint32_t voices) {
+    auto native = createTone(440.0f, 2, mixer.getSampleRate(), 1.0f);
+    auto mono = createTone(220.0f, 1, 22050, 1.0f);
+    for (uint32_t i = 0; i < voices; ++i) {
+        VoiceParameters parameters;
+        parameters.Loop = true;
+        parameters.Gain = 1.0f / float(voices);
+        parameters.Pan = float(i % 5) * 0.5f - 1.0f;
+        parameters.Pitch = i % 4 == 3 ? 1.25f : 1.0f;
+        mixer.play(i % 2 == 0 ? native : mono, parameters);
+    }
+}
+
+static void printStats(const AudioMixerStats& stats) {
+    std::cout << std::fixed << std::setprecision(2)
+              << "callbacks=" << stats.Callbacks
+              << " avg_us=" << stats.AverageCallbackMicroseconds
+              << " max_us=" << stats.MaxCallbackMicroseconds
+              << " cpu_load_pct=" << stats.CpuLoad * 100.0
+              << " overruns=" << stats.Overruns
+              << " late=" << stats.LateCallbacks
+              << " starvations=" << stats.StreamStarvations
+              << " voices=" << stats.ActiveVoices << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t voices = 64;
+    uint32_t bufferFrames = 256;
+    double seconds = 10.0;
+    bool device = false;
+    String driver = "dummy";
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--voices") == 0 && hasValue) {
+            voices = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--buffer") == 0 && hasValue) {
+            bufferFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--device") == 0) {
+            device = true;
+            if (hasValue && argv[i + 1][0] != '-') {
+                driver = argv[++i];
+            }
+        }
+    }
+
+    if (!device) {
+        AudioMixer mixer(48000, voices, bufferFrames);
+        startVoices(mixer, voices);
+        std::vector<float> output(size_t(bufferFrames) * 2);
+        auto callbacks = static_cast<uint64_t>(seconds * 48000.0 / double(bufferFrames));
+        for (uint64_t i = 0; i < callbacks; ++i) {
+            mixer.render(output.data(), bufferFrames);
+            mixer.update();
+        }
+        std::cout << "mode=offline buffer=" << bufferFrames << " ";
+        printStats(mixer.getStats());
+        return 0;
+    }
+
+    SdlContext::getInstance().initialize();
+    JobSystem::getInstance().initialize();
+    AudioDescriptor descriptor;
+    descriptor.Driver = driver;
+    descriptor.BufferFrames = bufferFrames;
+    descriptor.MaxVoices = voices;
+    auto audio = AudioSystem::create(descriptor);
+    if (!audio) {
+        return 1;
+    }
+
+    startVoices(audio->getMixer(), voices);
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        audio->update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+
+    std::cout << "mode=device driver=" << audio->getDriver() << " buffer=" << audio->getBufferFrames() << " ";
+    printStats(audio->getMixer().getStats());
+    audio.reset();
+    JobSystem::getInstance().shutdown();
+    SdlContext::getInstance().destroy();
+    return 0;
+}
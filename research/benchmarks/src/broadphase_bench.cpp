@@ -0,0 +1,122 @@
+#include "core/job_system.h"
+#include "physics/spatial_hash_broadphase.h"
+#include "physics/sweep_and_prune_broadphase.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+using namespace TriHarder;
+
+// Measures update cost and pair throughput of the broadphases at 10k, 100k and 1M objects.
+// Usage: BroadphaseBench [--frames N] [--moving PERCENT] [--max N]
+// Objects are unit-sized boxes at a constant density; every frame a share of them
+// moves a small random step, then update() and findPairs() are timed.
+
+struct Result {
+    double updateMs = 0.0;
+    double pairsMs = 0.0;
+    size_t pairs = 0;
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static Result measure(IBroadphase& broadphase, size_t count, int frameCount, int movingPercent) {
+    std::mt19937 random(42);
+    // Keep about 0.05 objects per unit volume, so pair counts grow linearly with the object count
+    float worldSize = std::cbrt(float(count) / 0.05f) * 0.5f;
+    std::uniform_real_distribution<float> position(-worldSize, worldSize);
+    std::uniform_real_distribution<float> size(0.5f, 1.5f);
+    std::uniform_real_distribution<float> step(-0.1f, 0.1f);
+
+    std::vector<Aabb> boxes(count);
+    std::vector<ProxyId> ids(count);
+    for (size_t i = 0; i < count; ++i) {
+        Float3 min{position(random), position(random), position(random)};
+        boxes[i] = {min, {min.X + size(random), min.Y + size(random), min.Z + size(random)}};
+        ids[i] = broadphase.createProxy(boxes[i], i);
+    }
+    broadphase.update();
+
+    std::vector<BroadphasePair> pairs;
+    broadphase.findPairs(pairs);
+
+    size_t moving = count * size_t(movingPercent) / 100;
+    Result result;
+    for (int frame = 0; frame < frameCount; ++frame) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t m = 0; m < moving; ++m) {
+            size_t i = (size_t(frame) * moving + m) % count;
+            Float3 delta{step(random), step(random), step(random)};
+            for (int axis = 0; axis < 3; ++axis) {
+                boxes[i].Min[axis] += delta[axis];
+                boxes[i].Max[axis] += delta[axis];
+            }
+            broadphase.moveProxy(ids[i], boxes[i]);
+        }
+        broadphase.update();
+        result.updateMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        broadphase.findPairs(pairs);
+        result.pairsMs += elapsedMs(start);
+        result.pairs = pairs.size();
+    }
+
+    result.updateMs /= frameCount;
+    result.pairsMs /= frameCount;
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    int frameCount = 10;
+    int movingPercent = 10;
+    size_t maxCount = 1'000'000;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frameCount = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--moving") == 0 && i + 1 < argc) {
+            movingPercent = std::clamp(std::atoi(argv[++i]), 0, 100);
+        } else if (std::strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+            maxCount = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+    }
+
+    auto& jobs = JobSystem::getInstance();
+    jobs.initialize();
+    std::cout << "Worker slots: " << jobs.getWorkerSlotCount() << ", moving: " << movingPercent << "%\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Broadphase      objects   update(ms)  pairs(ms)     pairs   Mpairs/s\n";
+
+    for (size_t count : {size_t(10'000), size_t(100'000), size_t(1'000'000)}) {
+        if (count > maxCount) {
+            break;
+        }
+
+        for (int kind = 0; kind < 2; ++kind) {
+            UniquePtr<IBroadphase> broadphase;
+            if (kind == 0) {
+                broadphase = createUniquePtr<SpatialHashBroadphase>(2.0f);
+            } else {
+                broadphase = createUniquePtr<SweepAndPruneBroadphase>();
+            }
+
+            auto result = measure(*broadphase, count, frameCount, movingPercent);
+            double throughput = result.pairsMs > 0.0 ? double(result.pairs) / result.pairsMs / 1000.0 : 0.0;
+            std::cout << std::left << std::setw(14) << (kind == 0 ? "spatial-hash" : "sweep-prune") << std::right
+                      << std::setw(9) << count
+                      << std::setw(13) << result.updateMs
+                      << std::setw(11) << result.pairsMs
+                      << std::setw(10) << result.pairs
+                      << std::setw(11) << throughput << "\n";
+        }
+    }
+
+    jobs.shutdown();
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "core/window.h"
+#include "core/sdl_context.h"
+#include "core/job_system.h"
+#include "graphics/frame_capture.h"
+#include <glad/glad.h>
+#include <SDL_hints.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+using namespace TriHarder;
+
+// Measures the frame time cost of capturing every frame at 1080p.
+// Usage: CaptureBench [--frames N] [--windowed] [--output DIR]
+// Compares no capture, a synchronous glReadPixels per frame and the asynchronous
+// PBO ring writing PNG files and a raw video dump.
+
+enum class CaptureMode {
+    Off,
+    Synchronous,
+    AsyncPng,
+    AsyncRaw,
+};
+
+static const char* toString(CaptureMode mode) {
+    switch (mode) {
+        case CaptureMode::Off:
+            return "off";
+        case CaptureMode::Synchronous:
+            return "sync";
+        case CaptureMode::AsyncPng:
+            return "async-png";
+        case CaptureMode::AsyncRaw:
+            return "async-raw";
+        default:
+            return "unknown";
+    }
+}
+
+static double toMilliseconds(Uint64 ticks) {
+    return static_cast<double>(ticks) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+static double measure(Window& window, CaptureMode mode, int frameCount, const String& output) {
+    uint32_t width = window.getDrawableWidth();
+    uint32_t height = window.getDrawableHeight();
+    std::vector<uint8_t> pixels(size_t(width) * height * 4);
+
+    UniquePtr<FrameCapture> capture;
+    if (mode == CaptureMode::AsyncPng || mode == CaptureMode::AsyncRaw) {
+        FrameCaptureDescriptor descriptor;
+        descriptor.OutputDirectory = (std::filesystem::path(output) / toString(mode)).string();
+        descriptor.Format = mode == CaptureMode::AsyncPng ? CaptureFormat::Png : CaptureFormat::RawVideo;
+        capture = FrameCapture::create(descriptor);
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < frameCount; ++i) {
+        glClearColor(static_cast<float>(i % 60) / 60.0f, 0.1f, 0.25f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+        if (mode == CaptureMode::Synchronous) {
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glReadPixels(0, 0, (GLsizei)width, (GLsizei)height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        } else if (capture) {
+            capture->captureFrame(width, height);
+        }
+        window.SwapBuffers();
+    }
+    if (capture) {
+        capture->finish();
+    }
+    glFinish();
+    return toMilliseconds(SDL_GetPerformanceCounter() - start) / frameCount;
+}
+
+int main(int argc, char* argv[]) {
+    int frameCount = 300;
+    bool headless = true;
+    String output = "capture_bench";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frameCount = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--windowed") == 0) {
+            headless = false;
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        }
+    }
+
+    if (headless) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+    }
+    SdlContext::getInstance().initialize();
+    JobSystem::getInstance().initialize();
+
+    WindowDescriptor descriptor("CaptureBench", 1920, 1080);
+    descriptor.SwapMode = SwapInterval::Immediate;
+    descriptor.Hidden = true;
+    descriptor.Resizable = false;
+    auto window = Window::create(descriptor);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Mode        frame(ms)  overhead\n";
+    double baseline = 0.0;
+    for (auto mode : {CaptureMode::Off, CaptureMode::Synchronous, CaptureMode::AsyncPng, CaptureMode::AsyncRaw}) {
+        double frameTime = measure(*window, mode, frameCount, output);
+        if (mode == CaptureMode::Off) {
+            baseline = frameTime;
+        }
+        std::cout << std::left << std::setw(12) << toString(mode) << std::right
+                  << std::setw(9) << frameTime << "  "
+                  << std::setw(7) << (frameTime / baseline - 1.0) * 100.0 << "%\n";
+    }
+
+    window.reset();
+    JobSystem::getInstance().shutdown();
+    SdlContext::getInstance().destroy();
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "core/job_system.h"
+#include "core/sdl_context.h"
+#include "core/window.h"
+#include "effects/particle_renderer.h"
+#include "effects/particle_system.h"
+#include <glad/glad.h>
+#include <SDL_hints.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+using namespace TriHarder;
+
+// Measures particle simulation (and optionally rendering) cost at a fixed particle count.
+// Usage: ParticleBench [--particles N] [--emitters N] [--frames N] [--render]
+// The simulation runs once on the calling thread only and once on the job system.
+// --render draws every frame into a hidden 1080p window on the offscreen video driver.
+
+struct Timing {
+    double average = 0.0;
+    double p99 = 0.0;
+    double renderAverage = 0.0;
+    uint64_t particles = 0;
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static Timing measure(uint32_t particles, uint32_t emitterCount, int frameCount, ParticleRenderer* renderer) {
+    ParticleSystem system;
+    uint32_t perEmitter = particles / emitterCount;
+    for (uint32_t i = 0; i < emitterCount; ++i) {
+        EmitterDescriptor descriptor;
+        descriptor.Position = {float(i % 10) - 5.0f, 0.0f, float(i / 10) - 5.0f};
+        descriptor.MaxParticles = perEmitter;
+        descriptor.LifetimeMin = 1.0f;
+        descriptor.LifetimeMax = 1.5f;
+        // Slightly more than the pool can hold, so the pools stay full in steady state
+        descriptor.SpawnRate = float(perEmitter) * 1.1f;
+        descriptor.Drag = 0.2f;
+        descriptor.Seed = i + 1;
+        system.createEmitter(descriptor);
+    }
+
+    const float deltaTime = 1.0f / 60.0f;
+    for (int i = 0; i < 120; ++i) {
+        system.update(deltaTime);
+    }
+
+    ParticleCamera camera;
+    const float scale = 0.1f;
+    for (int i = 0; i < 3; ++i) {
+        camera.ViewProjection[i * 5] = scale;
+    }
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(frameCount);
+    double renderTotal = 0.0;
+    Timing timing;
+    for (int i = 0; i < frameCount; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        system.update(deltaTime);
+        frameTimes.push_back(elapsedMs(start));
+        timing.particles = std::max(timing.particles, system.getParticleCount());
+
+        if (renderer) {
+            auto renderStart = std::chrono::steady_clock::now();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            renderer->draw(system, camera);
+            glFinish();
+            renderTotal += elapsedMs(renderStart);
+        }
+    }
+
+    for (double t : frameTimes) {
+        timing.average += t;
+    }
+    timing.average /= frameCount;
+    timing.renderAverage = renderTotal / frameCount;
+    std::sort(frameTimes.begin(), frameTimes.end());
+    timing.p99 = frameTimes[std::min(frameTimes.size() - 1, frameTimes.size() * 99 / 100)];
+    return timing;
+}
+
+static void print(const char* label, const Timing& timing, bool render) {
+    std::cout << std::left << std::setw(10) << label << std::right
+              << std::setw(10) << timing.particles
+              << std::setw(11) << timing.average
+              << std::setw(11) << timing.p99;
+    if (render) {
+        std::cout << std::setw(11) << timing.renderAverage;
+    }
+    std::cout << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t particles = 1'000'000;
+    uint32_t emitterCount = 16;
+    int frameCount = 300;
+    bool render = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--particles") == 0 && i + 1 < argc) {
+            particles = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--emitters") == 0 && i + 1 < argc) {
+            emitterCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frameCount = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--render") == 0) {
+            render = true;
+        }
+    }
+
+    UniquePtr<Window> window;
+    UniquePtr<ParticleRenderer> renderer;
+    if (render) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+        SdlContext::getInstance().initialize();
+        WindowDescriptor descriptor("ParticleBench", 1920, 1080);
+        descriptor.SwapMode = SwapInterval::Immediate;
+        descriptor.Hidden = true;
+        window = Window::create(descriptor);
+        renderer = ParticleRenderer::create();
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Threads   particles  update(ms)  p99(ms)" << (render ? "  draw(ms)" : "") << "\n";
+    print("1", measure(particles, emitterCount, frameCount, renderer.get()), render);
+
+    auto& jobs = JobSystem::getInstance();
+    jobs.initialize();
+    auto label = std::to_string(jobs.getWorkerSlotCount());
+    print(label.c_str(), measure(particles, emitterCount, frameCount, renderer.get()), render);
+    jobs.shutdown();
+
+    if (render) {
+        renderer.reset();
+        window.reset();
+        SdlContext::getInstance().destroy();
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "core/string_id.h"
+#include "core/string_id_map.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+using namespace TriHarder;
+
+// Compares name lookups through std::unordered_map<std::string, ...> against StringIdMap.
+// Usage: StringIdBench [--names N] [--lookups N]
+
+template<typename F>
+static double measureNs(size_t lookups, F&& function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(lookups);
+}
+
+int main(int argc, char* argv[]) {
+    size_t nameCount = 512;
+    size_t lookupCount = 10'000'000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (String(argv[i]) == "--names") {
+            nameCount = std::max(1, std::atoi(argv[i + 1]));
+        } else if (String(argv[i]) == "--lookups") {
+            lookupCount = std::max(1, std::atoi(argv[i + 1]));
+        }
+    }
+
+    // Names shaped like uniform and asset names with a shared prefix
+    std::vector<String> names;
+    std::vector<StringId> ids;
+    std::unordered_map<String, int> stringMap;
+    StringIdMap<int> idMap;
+    for (size_t i = 0; i < nameCount; ++i) {
+        names.push_back(std::format("u_material.layers[{}].albedo", i));
+        ids.push_back(StringId::intern(names.back()));
+        stringMap[names.back()] = static_cast<int>(i);
+        idMap[ids.back()] = static_cast<int>(i);
+    }
+
+    // Precomputed access pattern so both maps see the same keys
+    std::vector<uint32_t> order(lookupCount);
+    uint32_t state = 12345;
+    for (auto& index : order) {
+        state = state * 1664525u + 1013904223u;
+        index = state % nameCount;
+    }
+
+    int64_t checksum = 0;
+    double stringNs = measureNs(lookupCount, [&]() {
+        for (auto index : order) {
+            checksum += stringMap.find(names[index])->second;
+        }
+    });
+    double idNs = measureNs(lookupCount, [&]() {
+        for (auto index : order) {
+            checksum += *idMap.find(ids[index]);
+        }
+    });
+    double hashAndIdNs = measureNs(lookupCount, [&]() {
+        for (auto index : order) {
+            checksum += *idMap.find(StringId::hash(names[index]));
+        }
+    });
+
+    std::cout << std::format("names={} lookups={}\n", nameCount, lookupCount);
+    std::cout << std::format("unordered_map<string>       {:7.2f} ns/lookup\n", stringNs);
+    std::cout << std::format("StringIdMap (prehashed id)  {:7.2f} ns/lookup\n", idNs);
+    std::cout << std::format("StringIdMap (hash + lookup) {:7.2f} ns/lookup\n", hashAndIdNs);
+    std::cout << std::format("checksum={}\n", checksum);
+    return 0;
+}
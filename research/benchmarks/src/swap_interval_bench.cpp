@@ -0,0 +1,108 @@
+#include "core/window.h"
+#include "core/sdl_context.h"
+#include <glad/glad.h>
+#include <SDL_hints.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+using namespace TriHarder;
+
+// Compares frame times and swap call overhead across swap intervals.
+// Usage: SwapIntervalBench [--frames N] [--windowed]
+// Without --windowed the SDL offscreen video driver is used so the benchmark runs headless.
+
+struct FrameStats {
+    SwapInterval active = SwapInterval::VSync;
+    double average = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    double swapAverage = 0.0;
+};
+
+static double toMilliseconds(Uint64 ticks) {
+    return static_cast<double>(ticks) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+static FrameStats measure(SwapInterval interval, int frameCount) {
+    WindowDescriptor descriptor("SwapIntervalBench", 1280, 720);
+    descriptor.SwapMode = interval;
+    descriptor.Hidden = true;
+    descriptor.Resizable = false;
+    auto window = Window::create(descriptor);
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(frameCount);
+    double swapTotal = 0.0;
+
+    // Warm up the driver before taking measurements
+    for (int i = 0; i < 10; ++i) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        window->SwapBuffers();
+    }
+
+    Uint64 last = SDL_GetPerformanceCounter();
+    for (int i = 0; i < frameCount; ++i) {
+        glClearColor(static_cast<float>(i % 2), 0.1f, 0.25f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+        Uint64 swapStart = SDL_GetPerformanceCounter();
+        window->SwapBuffers();
+        Uint64 now = SDL_GetPerformanceCounter();
+
+        swapTotal += toMilliseconds(now - swapStart);
+        frameTimes.push_back(toMilliseconds(now - last));
+        last = now;
+    }
+
+    FrameStats stats;
+    stats.active = window->getSwapInterval();
+    for (double t : frameTimes) {
+        stats.average += t;
+    }
+    stats.average /= frameCount;
+    stats.swapAverage = swapTotal / frameCount;
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    stats.p50 = frameTimes[frameTimes.size() / 2];
+    stats.p99 = frameTimes[std::min(frameTimes.size() - 1, frameTimes.size() * 99 / 100)];
+    stats.max = frameTimes.back();
+    return stats;
+}
+
+int main(int argc, char* argv[]) {
+    int frameCount = 600;
+    bool headless = true;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frameCount = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--windowed") == 0) {
+            headless = false;
+        }
+    }
+
+    if (headless) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+    }
+    SdlContext::getInstance().initialize();
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Mode      Active      avg(ms)   p50(ms)   p99(ms)   max(ms)   swap(ms)\n";
+    for (auto interval : {SwapInterval::Immediate, SwapInterval::VSync, SwapInterval::Adaptive}) {
+        auto stats = measure(interval, frameCount);
+        std::cout << std::left << std::setw(10) << toString(interval)
+                  << std::setw(10) << toString(stats.active) << std::right
+                  << std::setw(9) << stats.average << " "
+                  << std::setw(9) << stats.p50 << " "
+                  << std::setw(9) << stats.p99 << " "
+                  << std::setw(9) << stats.max << " "
+                  << std::setw(9) << stats.swapAverage << "\n";
+    }
+
+    SdlContext::getInstance().destroy();
+    return 0;
+}
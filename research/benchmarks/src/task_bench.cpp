@@ -0,0 +1,63 @@
+#include "core/task.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+using namespace TriHarder;
+
+// Measures the per-frame cost of many scripted tasks.
+// Usage: TaskBench [--tasks N] [--frames N]
+// Every task loops on a timer of a few seconds, like idle NPC scripts, and one in a
+// hundred waits for every frame. Reports the spawn cost and the average frame cost.
+
+static Task<> idleScript(uint32_t id) {
+    double period = 1.0 + double(id % 97) * 0.05;
+    for (;;) {
+        if (id % 100 == 0) {
+            co_await nextFrame();
+        } else {
+            co_await waitSeconds(period);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t tasks = 100000;
+    uint32_t frames = 600;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--tasks") == 0 && hasValue) {
+            tasks = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--frames") == 0 && hasValue) {
+            frames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
+
+    TaskScheduler scheduler;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < tasks; ++i) {
+        scheduler.spawn(idleScript(i));
+    }
+    double spawnMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t resumed = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        scheduler.beginFrame(1.0 / 60.0);
+        scheduler.runPhase(TaskPhase::PreRender);
+        scheduler.runPhase(TaskPhase::FrameEnd);
+        resumed += scheduler.getResumedThisFrame();
+    }
+    double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    auto pool = TaskFramePool::getStats();
+    std::cout << std::fixed << std::setprecision(4)
+              << "tasks=" << tasks
+              << " spawn_ns_per_task=" << spawnMs * 1e6 / tasks
+              << " frame_ms=" << frameMs
+              << " resumed_per_frame=" << double(resumed) / frames
+              << " frame_pool_kb=" << pool.SlabBytes / 1024
+              << " large_frames=" << pool.LargeAllocations << std::endl;
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "core/window.h"
+#include "core/sdl_context.h"
+#include "graphics/text_renderer.h"
+#include <SDL_hints.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <vector>
+using namespace TriHarder;
+
+// Measures the CPU time of drawing many labels per frame, a part of them changing every frame.
+// Usage: TextBench <font.ttf> [--labels N] [--frames N] [--changing PERCENT] [--windowed]
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: TextBench <font.ttf> [--labels N] [--frames N] [--changing PERCENT] [--windowed]\n";
+        return 1;
+    }
+
+    int labelCount = 5000;
+    int frameCount = 300;
+    int changingPercent = 10;
+    bool headless = true;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--labels") == 0 && i + 1 < argc) {
+            labelCount = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frameCount = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--changing") == 0 && i + 1 < argc) {
+            changingPercent = std::clamp(std::atoi(argv[++i]), 0, 100);
+        } else if (std::strcmp(argv[i], "--windowed") == 0) {
+            headless = false;
+        }
+    }
+
+    if (headless) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+    }
+    SdlContext::getInstance().initialize();
+
+    WindowDescriptor descriptor("TextBench", 1920, 1080);
+    descriptor.SwapMode = SwapInterval::Immediate;
+    descriptor.Hidden = headless;
+    auto window = Window::create(descriptor);
+
+    auto fontResult = Font::load(argv[1], 14);
+    if (!fontResult) {
+        std::cerr << fontResult.unwrap_err() << "\n";
+        return 1;
+    }
+    auto font = fontResult.unwrap();
+    auto renderer = TextRenderer::create();
+    TextStyle style{font.get(), 0xFFFFFFFF, 1.0f};
+
+    // Static labels are formatted once, changing labels are formatted every frame like a HUD would
+    std::vector<String> labels(labelCount);
+    for (int i = 0; i < labelCount; ++i) {
+        labels[i] = std::format("Entity {:05} hp={}", i, 100 - i % 100);
+    }
+    int changingCount = labelCount * changingPercent / 100;
+
+    double totalMs = 0.0;
+    double worstMs = 0.0;
+    uint64_t layouts = 0;
+    uint64_t hits = 0;
+    for (int frame = 0; frame < frameCount; ++frame) {
+        for (int i = 0; i < changingCount; ++i) {
+            labels[i] = std::format("Entity {:05} t={}", i, frame);
+        }
+
+        glClear(GL_COLOR_BUFFER_BIT);
+        auto start = std::chrono::steady_clock::now();
+        renderer->beginFrame(window->getWidth(), window->getHeight());
+        for (int i = 0; i < labelCount; ++i) {
+            float x = static_cast<float>((i % 12) * 160);
+            float y = static_cast<float>(16 + (i / 12) % 64 * 16);
+            renderer->drawText(labels[i], x, y, style);
+        }
+        renderer->flush();
+        auto end = std::chrono::steady_clock::now();
+        window->SwapBuffers();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        totalMs += ms;
+        worstMs = std::max(worstMs, ms);
+        layouts += renderer->getStats().Layouts;
+        hits += renderer->getStats().RunCacheHits;
+    }
+
+    const auto& stats = renderer->getStats();
+    std::cout << std::format("labels={} changing={}% frames={}\n", labelCount, changingPercent, frameCount);
+    std::cout << std::format("cpu avg={:.3f} ms worst={:.3f} ms\n", totalMs / frameCount, worstMs);
+    std::cout << std::format("glyphs/frame={} draw calls/frame={} atlas pages={} evictions={}\n",
+                             stats.Glyphs, stats.DrawCalls, renderer->getAtlas().getPageCount(),
+                             renderer->getAtlas().getEvictionCount());
+    std::cout << std::format("run cache hit rate={:.1f}%\n", 100.0 * double(hits) / double(std::max<uint64_t>(1, hits + layouts)));
+
+    renderer.reset();
+    window.reset();
+    SdlContext::getInstance().destroy();
+    return 0;
+}
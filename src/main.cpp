@@ -1,6 +1,10 @@
 #include <core/application.h>
+#include <core/startup_profiler.h>
 
 int main(int argc, char* argv[]) {
-    TriHarder::Application app;
-    app.run();
+    // Touch the profiler first so its origin is as close to process start as possible
+    TriHarder::StartupProfiler::getInstance();
+
+    TriHarder::Application app(TriHarder::ApplicationDescriptor::fromCommandLine(argc, argv));
+    return app.run();
 }
@@ -0,0 +1,205 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "audio/audio_mixer.h"
+
+using namespace TriHarder;
+
+static std::vector<float> render(AudioMixer& mixer, uint32_t frames) {
+    std::vector<float> output(size_t(frames) * 2);
+    mixer.render(output.data(), frames);
+    mixer.update();
+    return output;
+}
+
+static void writeWav(const String& path, const std::vector<int16_t>& samples, uint16_t channels, uint32_t sampleRate) {
+    auto put32 = [](std::ofstream& file, uint32_t value) { file.write(reinterpret_cast<const char*>(&value), 4); };
+    auto put16 = [](std::ofstream& file, uint16_t value) { file.write(reinterpret_cast<const char*>(&value), 2); };
+    auto dataSize = static_cast<uint32_t>(samples.size() * 2);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write("RIFF", 4);
+    put32(file, 36 + dataSize);
+    file.write("WAVEfmt ", 8);
+    put32(file, 16);
+    put16(file, 1);
+    put16(file, channels);
+    put32(file, sampleRate);
+    put32(file, sampleRate * channels * 2);
+    put16(file, static_cast<uint16_t>(channels * 2));
+    put16(file, 16);
+    file.write("data", 4);
+    put32(file, dataSize);
+    file.write(reinterpret_cast<const char*>(samples.data()), dataSize);
+}
+
+TEST_CASE("AudioMixer plays a mono clip centered with constant power", "[AudioMixer]") {
+    AudioMixer mixer(48000, 4, 64);
+    std::vector<float> samples(100);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = float(i) / 100.0f;
+    }
+    auto voice = mixer.play(AudioClip::fromSamples(samples, 1, 48000));
+    REQUIRE(voice != InvalidVoice);
+    REQUIRE(mixer.isPlaying(voice));
+
+    auto output = render(mixer, 128);
+    float center = std::sqrt(0.5f);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        REQUIRE(output[i * 2] == Catch::Approx(samples[i] * center));
+        REQUIRE(output[i * 2 + 1] == Catch::Approx(samples[i] * center));
+    }
+    for (size_t i = samples.size() * 2; i < output.size(); ++i) {
+        REQUIRE(output[i] == 0.0f);
+    }
+
+    // The finished event was consumed by update()
+    REQUIRE_FALSE(mixer.isPlaying(voice));
+    REQUIRE(mixer.getStats().ActiveVoices == 0);
+    REQUIRE(mixer.getStats().Callbacks == 1);
+}
+
+TEST_CASE("AudioMixer pans stereo clips as a balance", "[AudioMixer]") {
+    AudioMixer mixer(48000, 4, 64);
+    std::vector<float> samples(64 * 2);
+    for (size_t i = 0; i < 64; ++i) {
+        samples[i * 2] = 0.25f;
+        samples[i * 2 + 1] = -0.5f;
+    }
+
+    VoiceParameters parameters;
+    parameters.Pan = -1.0f;
+    mixer.play(AudioClip::fromSamples(samples, 2, 48000), parameters);
+    auto output = render(mixer, 64);
+    for (size_t i = 0; i < 64; ++i) {
+        REQUIRE(output[i * 2] == Catch::Approx(0.25f));
+        REQUIRE(output[i * 2 + 1] == 0.0f);
+    }
+}
+
+TEST_CASE("AudioMixer resamples clips to the output rate", "[AudioMixer]") {
+    AudioMixer mixer(48000, 4, 256);
+    std::vector<float> samples(100);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = float(i) / 100.0f;
+    }
+
+    VoiceParameters parameters;
+    parameters.Pan = 1.0f;
+    auto voice = mixer.play(AudioClip::fromSamples(samples, 1, 24000), parameters);
+    auto output = render(mixer, 256);
+
+    // Every other output frame falls halfway between two source frames
+    for (size_t i = 0; i + 1 < 200; ++i) {
+        float expected = i % 2 == 0 ? samples[i / 2] : (samples[i / 2] + samples[i / 2 + 1]) * 0.5f;
+        REQUIRE(output[i * 2 + 1] == Catch::Approx(expected).margin(1e-6));
+        REQUIRE(output[i * 2] == Catch::Approx(0.0f).margin(1e-6));
+    }
+    for (size_t i = 200; i < 256; ++i) {
+        REQUIRE(output[i * 2 + 1] == 0.0f);
+    }
+    REQUIRE_FALSE(mixer.isPlaying(voice));
+}
+
+TEST_CASE("AudioMixer loops clips and applies the master gain", "[AudioMixer]") {
+    AudioMixer mixer(48000, 4, 64);
+    VoiceParameters parameters;
+    parameters.Loop = true;
+    parameters.Pan = 1.0f;
+    auto voice = mixer.play(AudioClip::fromSamples({0.5f, 0.25f, 0.0f}, 1, 48000), parameters);
+
+    auto output = render(mixer, 64);
+    for (size_t i = 0; i < 64; ++i) {
+        float expected = i % 3 == 0 ? 0.5f : i % 3 == 1 ? 0.25f : 0.0f;
+        REQUIRE(output[i * 2 + 1] == Catch::Approx(expected).margin(1e-6));
+    }
+    REQUIRE(mixer.isPlaying(voice));
+
+    // The first block ramps to the new master gain, the next one holds it and clips at 1
+    mixer.setMasterGain(4.0f);
+    render(mixer, 64);
+    output = render(mixer, 64);
+    float maximum = 0.0f;
+    for (size_t i = 0; i < 64; ++i) {
+        maximum = std::max(maximum, output[i * 2 + 1]);
+    }
+    REQUIRE(maximum == 1.0f);
+}
+
+TEST_CASE("AudioMixer fades out stopped voices and ignores stale handles", "[AudioMixer]") {
+    AudioMixer mixer(48000, 1, 64);
+    VoiceParameters parameters;
+    parameters.Loop = true;
+    auto clip = AudioClip::fromSamples(std::vector<float>(16, 1.0f), 1, 48000);
+
+    auto first = mixer.play(clip, parameters);
+    REQUIRE(mixer.play(clip, parameters) == InvalidVoice);
+    mixer.stop(first);
+    auto output = render(mixer, 64);
+
+    // Linear ramp from the start gain down to silence
+    REQUIRE(output[0] == Catch::Approx(std::sqrt(0.5f)));
+    REQUIRE(output[63 * 2] < output[0]);
+    REQUIRE_FALSE(mixer.isPlaying(first));
+
+    auto second = mixer.play(clip, parameters);
+    REQUIRE(second != InvalidVoice);
+    REQUIRE(second != first);
+    mixer.stop(first);
+    mixer.setGain(first, 0.0f);
+    render(mixer, 64);
+    REQUIRE(mixer.isPlaying(second));
+    REQUIRE(mixer.getStats().ActiveVoices == 1);
+}
+
+TEST_CASE("AudioMixer streams a WAV file from disk", "[AudioMixer]") {
+    auto path = (std::filesystem::temp_directory_path() / "triharder_audio_stream_test.wav").string();
+    constexpr uint32_t Frames = 3000;
+    std::vector<int16_t> samples(Frames * 2);
+    for (uint32_t i = 0; i < Frames; ++i) {
+        samples[i * 2] = static_cast<int16_t>(i);
+        samples[i * 2 + 1] = static_cast<int16_t>(-int32_t(i));
+    }
+    writeWav(path, samples, 2, 8000);
+
+    auto result = AudioStream::open(path, false);
+    REQUIRE(result.is_ok());
+    auto stream = result.unwrap();
+    REQUIRE(stream->getChannels() == 2);
+    REQUIRE(stream->getSampleRate() == 8000);
+    while (!stream->isPrimed()) {
+        std::this_thread::yield();
+    }
+
+    AudioMixer mixer(8000, 4, 256);
+    auto voice = mixer.play(stream);
+    REQUIRE(mixer.play(stream) == InvalidVoice);
+    stream.reset();
+
+    std::vector<float> output;
+    for (int block = 0; block < 16 && mixer.isPlaying(voice); ++block) {
+        auto part = render(mixer, 256);
+        output.insert(output.end(), part.begin(), part.end());
+    }
+    REQUIRE_FALSE(mixer.isPlaying(voice));
+    REQUIRE(output.size() >= Frames * 2);
+    for (uint32_t i = 0; i < Frames; ++i) {
+        REQUIRE(output[i * 2] == Catch::Approx(float(i) / 32768.0f));
+        REQUIRE(output[i * 2 + 1] == Catch::Approx(-float(i) / 32768.0f));
+    }
+    REQUIRE(output[Frames * 2] == 0.0f);
+    REQUIRE(mixer.getStats().StreamStarvations == 0);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("AudioStream rejects files that are not WAV", "[AudioMixer]") {
+    auto path = (std::filesystem::temp_directory_path() / "triharder_audio_invalid_test.wav").string();
+    std::ofstream(path, std::ios::binary) << "not a wave file";
+    REQUIRE(AudioStream::open(path, false).is_error());
+    REQUIRE(AudioClip::load(path).is_error());
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,172 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "core/frame_recording.h"
+#include "input/input.h"
+
+using namespace TriHarder;
+
+static SDL_Event makeKeyEvent(Uint32 type, SDL_Scancode scancode) {
+    SDL_Event event{};
+    event.type = type;
+    event.key.keysym.scancode = scancode;
+    return event;
+}
+
+static std::vector<uint8_t> readBytes(const String& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+TEST_CASE("Recorded frames replay with identical events and delta times", "[FrameRecording]") {
+    auto path = (std::filesystem::temp_directory_path() / "triharder_frame_recording_test.bin").string();
+    const double deltaTimes[] = {0.016, 1.0 / 60.0, 0.0333333333333, 0.0};
+
+    SDL_Event motion{};
+    motion.type = SDL_MOUSEMOTION;
+    motion.motion.x = 640;
+    motion.motion.y = 12;
+    motion.motion.xrel = -35;
+    motion.motion.yrel = 4;
+
+    SDL_Event axis{};
+    axis.type = SDL_CONTROLLERAXISMOTION;
+    axis.caxis.which = 3;
+    axis.caxis.axis = SDL_CONTROLLER_AXIS_LEFTY;
+    axis.caxis.value = -32768;
+
+    SDL_Event wheel{};
+    wheel.type = SDL_MOUSEWHEEL;
+    wheel.wheel.preciseY = -1.25f;
+
+    {
+        Input input;
+        auto recorder = FrameRecorder::create(path, input);
+        REQUIRE(recorder);
+
+        recorder->beginFrame(deltaTimes[0]);
+        recorder->recordEvent(0, makeKeyEvent(SDL_KEYDOWN, SDL_SCANCODE_W));
+        recorder->recordEvent(1, motion);
+        recorder->endFrame();
+
+        recorder->beginFrame(deltaTimes[1]);
+        auto repeat = makeKeyEvent(SDL_KEYDOWN, SDL_SCANCODE_W);
+        repeat.key.repeat = 1;
+        recorder->recordEvent(0, repeat);
+        recorder->recordEvent(0, axis);
+        recorder->endFrame();
+
+        recorder->beginFrame(deltaTimes[2]);
+        recorder->recordEvent(1, wheel);
+        recorder->recordEvent(1, makeKeyEvent(SDL_KEYUP, SDL_SCANCODE_W));
+        recorder->endFrame();
+
+        // An open frame is completed by the destructor
+        recorder->beginFrame(deltaTimes[3]);
+    }
+
+    auto loaded = FrameReplay::load(path);
+    REQUIRE(loaded.is_ok());
+    auto replay = loaded.unwrap();
+    REQUIRE(replay.getFrameCount() == 4);
+    REQUIRE(replay.getInitialGamepads().empty());
+
+    ReplayFrame frame;
+    for (int pass = 0; pass < 2; ++pass) {
+        replay.rewind();
+
+        REQUIRE(replay.readFrame(frame, 100));
+        REQUIRE(frame.DeltaTime == deltaTimes[0]);
+        REQUIRE(frame.Samples[0].size() == 1);
+        REQUIRE(frame.Samples[0][0].type == SDL_KEYDOWN);
+        REQUIRE(frame.Samples[0][0].key.keysym.scancode == SDL_SCANCODE_W);
+        REQUIRE(frame.Samples[0][0].key.timestamp == 100);
+        REQUIRE(frame.Samples[1].size() == 1);
+        REQUIRE(frame.Samples[1][0].type == SDL_MOUSEMOTION);
+        REQUIRE(frame.Samples[1][0].motion.x == 640);
+        REQUIRE(frame.Samples[1][0].motion.y == 12);
+        REQUIRE(frame.Samples[1][0].motion.xrel == -35);
+        REQUIRE(frame.Samples[1][0].motion.yrel == 4);
+
+        // Key repeats are not stored
+        REQUIRE(replay.readFrame(frame));
+        REQUIRE(frame.DeltaTime == deltaTimes[1]);
+        REQUIRE(frame.Samples[0].size() == 1);
+        REQUIRE(frame.Samples[0][0].type == SDL_CONTROLLERAXISMOTION);
+        REQUIRE(frame.Samples[0][0].caxis.which == 3);
+        REQUIRE(frame.Samples[0][0].caxis.axis == SDL_CONTROLLER_AXIS_LEFTY);
+        REQUIRE(frame.Samples[0][0].caxis.value == -32768);
+        REQUIRE(frame.Samples[1].empty());
+
+        REQUIRE(replay.readFrame(frame));
+        REQUIRE(frame.DeltaTime == deltaTimes[2]);
+        REQUIRE(frame.Samples[0].empty());
+        REQUIRE(frame.Samples[1].size() == 2);
+        REQUIRE(frame.Samples[1][0].type == SDL_MOUSEWHEEL);
+        REQUIRE(frame.Samples[1][0].wheel.preciseY == -1.25f);
+        REQUIRE(frame.Samples[1][1].type == SDL_KEYUP);
+
+        REQUIRE(replay.readFrame(frame));
+        REQUIRE(frame.DeltaTime == deltaTimes[3]);
+        REQUIRE_FALSE(replay.readFrame(frame));
+    }
+
+    SECTION("truncated recordings are rejected") {
+        auto bytes = readBytes(path);
+        bytes.pop_back();
+        REQUIRE(FrameReplay::fromBytes(bytes).is_error());
+    }
+
+    SECTION("unknown event types are rejected") {
+        auto bytes = readBytes(path);
+        // Header without gamepads is 8 bytes, the first event type follows the delta time and event count
+        bytes[8 + 8 + 1] = 0xFF;
+        REQUIRE(FrameReplay::fromBytes(bytes).is_error());
+    }
+
+    SECTION("other files are rejected") {
+        REQUIRE(FrameReplay::fromBytes({'R', 'I', 'F', 'F', 0, 0, 0, 0}).is_error());
+        REQUIRE(FrameReplay::load(path + ".missing").is_error());
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Replayed gamepad events drive a virtual gamepad", "[FrameRecording]") {
+    Input input;
+    input.connectVirtualGamepad(7);
+    REQUIRE(input.isGamepadConnected(0));
+    REQUIRE(input.getGamepadInstanceId(0) == 7);
+
+    SDL_Event button{};
+    button.type = SDL_CONTROLLERBUTTONDOWN;
+    button.cbutton.which = 7;
+    button.cbutton.button = SDL_CONTROLLER_BUTTON_A;
+    input.beginFrame();
+    input.processEvent(button);
+    REQUIRE(input.isGamepadButtonPressed(0, SDL_CONTROLLER_BUTTON_A));
+
+    input.processEvent(makeKeyEvent(SDL_KEYDOWN, SDL_SCANCODE_SPACE));
+    input.reset();
+    REQUIRE_FALSE(input.isGamepadConnected(0));
+    REQUIRE_FALSE(input.isKeyDown(SDL_SCANCODE_SPACE));
+}
+
+TEST_CASE("Frame time statistics use nearest rank percentiles", "[FrameRecording]") {
+    std::vector<double> frameTimes;
+    for (int i = 100; i >= 1; --i) {
+        frameTimes.push_back(static_cast<double>(i));
+    }
+
+    auto stats = computeFrameTimeStats(frameTimes);
+    REQUIRE(stats.Frames == 100);
+    REQUIRE(stats.AverageMs == 50.5);
+    REQUIRE(stats.P50Ms == 50.0);
+    REQUIRE(stats.P95Ms == 95.0);
+    REQUIRE(stats.P99Ms == 99.0);
+    REQUIRE(stats.MaxMs == 100.0);
+
+    std::vector<double> empty;
+    REQUIRE(computeFrameTimeStats(empty).Frames == 0);
+}
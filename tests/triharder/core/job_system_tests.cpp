@@ -0,0 +1,90 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "core/job_system.h"
+
+using namespace TriHarder;
+
+TEST_CASE("JobSystem executes jobs and parallel loops", "[JobSystem]") {
+    auto& jobs = JobSystem::getInstance();
+    jobs.initialize(3);
+
+    SECTION("submit returns the result of the job") {
+        auto future = jobs.submit([]() { return 42; });
+        REQUIRE(future.get() == 42);
+    }
+
+    SECTION("parallelFor visits every index exactly once") {
+        std::vector<int> visited(10000, 0);
+        jobs.parallelFor(visited.size(), 64, [&](size_t begin, size_t end, uint32_t) {
+            for (size_t i = begin; i < end; ++i) {
+                visited[i]++;
+            }
+        });
+        REQUIRE(std::accumulate(visited.begin(), visited.end(), 0) == 10000);
+        REQUIRE(std::all_of(visited.begin(), visited.end(), [](int count) { return count == 1; }));
+    }
+
+    SECTION("parallelFor reports worker slots within range") {
+        std::atomic<bool> inRange = true;
+        jobs.parallelFor(1000, 1, [&](size_t, size_t, uint32_t worker) {
+            if (worker >= jobs.getWorkerSlotCount()) {
+                inRange = false;
+            }
+        });
+        REQUIRE(inRange);
+    }
+
+    SECTION("parallelFor does not run unrelated queued jobs on the calling thread") {
+        // Keep all but one worker busy so the unrelated job stays queued
+        std::atomic<bool> release = false;
+        std::atomic<uint32_t> blocked = 0;
+        std::vector<std::future<void>> blockers;
+        for (uint32_t i = 1; i < jobs.getThreadCount(); ++i) {
+            blockers.push_back(jobs.submit([&]() {
+                blocked++;
+                while (!release) {
+                    std::this_thread::yield();
+                }
+            }));
+        }
+        while (blocked + 1 < jobs.getThreadCount()) {
+            std::this_thread::yield();
+        }
+
+        std::atomic<bool> workerStarted = false;
+        std::atomic<std::thread::id> unrelatedThread{};
+        std::future<void> unrelated;
+        jobs.parallelFor(jobs.getWorkerSlotCount(), 1, [&](size_t, size_t, uint32_t worker) {
+            if (worker != 0) {
+                // Keeps the caller waiting for this batch
+                workerStarted = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            } else if (!unrelated.valid()) {
+                unrelated = jobs.submit([&]() { unrelatedThread = std::this_thread::get_id(); });
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+                while (!workerStarted && std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        REQUIRE(unrelatedThread.load() != std::this_thread::get_id());
+
+        release = true;
+        for (auto& blocker : blockers) {
+            blocker.get();
+        }
+        unrelated.get();
+        REQUIRE(unrelatedThread.load() != std::this_thread::get_id());
+    }
+
+    SECTION("parallelFor with an empty range does nothing") {
+        bool called = false;
+        jobs.parallelFor(0, 1, [&](size_t, size_t, uint32_t) { called = true; });
+        REQUIRE_FALSE(called);
+    }
+}
@@ -0,0 +1,156 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <vector>
+#include "audio/audio_clip.h"
+#include "audio/audio_mixer.h"
+#include "core/memory_tracker.h"
+#include "core/task.h"
+#include "input/input.h"
+
+using namespace TriHarder;
+
+#if TRIHARDER_MEMORY_TRACKING
+
+static const MemoryTagStats& tagStats(const MemoryStats& stats, MemoryTag tag) {
+    return stats.Tags[static_cast<size_t>(tag)];
+}
+
+TEST_CASE("Allocations are accounted to the tag of the enclosing scope", "[MemoryTracker]") {
+    auto before = MemoryTracker::getStats();
+    UniquePtr<std::array<char, 1000>> block;
+    {
+        MemoryTagScope scope(MemoryTag::Scene);
+        REQUIRE(MemoryTracker::getCurrentTag() == MemoryTag::Scene);
+        block = createUniquePtr<std::array<char, 1000>>();
+    }
+    REQUIRE(MemoryTracker::getCurrentTag() == MemoryTag::General);
+
+    auto allocated = MemoryTracker::getStats();
+    REQUIRE(tagStats(allocated, MemoryTag::Scene).Allocations == tagStats(before, MemoryTag::Scene).Allocations + 1);
+    REQUIRE(tagStats(allocated, MemoryTag::Scene).LiveBytes == tagStats(before, MemoryTag::Scene).LiveBytes + 1000);
+
+    // The free is accounted to the allocating tag, also on another thread
+    std::thread([&block]() { block.reset(); }).join();
+    auto freed = MemoryTracker::getStats();
+    REQUIRE(tagStats(freed, MemoryTag::Scene).Frees == tagStats(before, MemoryTag::Scene).Frees + 1);
+    REQUIRE(tagStats(freed, MemoryTag::Scene).LiveBytes == tagStats(before, MemoryTag::Scene).LiveBytes);
+}
+
+TEST_CASE("Over-aligned allocations keep their alignment", "[MemoryTracker]") {
+    struct alignas(128) CacheBlock {
+        uint8_t Data[256];
+    };
+
+    MemoryTagScope scope(MemoryTag::Physics);
+    auto before = tagStats(MemoryTracker::getStats(), MemoryTag::Physics).LiveBytes;
+    std::vector<UniquePtr<CacheBlock>> blocks;
+    for (int i = 0; i < 8; ++i) {
+        blocks.push_back(createUniquePtr<CacheBlock>());
+        REQUIRE(reinterpret_cast<uintptr_t>(blocks.back().get()) % 128 == 0);
+    }
+    REQUIRE(tagStats(MemoryTracker::getStats(), MemoryTag::Physics).LiveBytes >= before + 8 * 256);
+    blocks.clear();
+    blocks.shrink_to_fit();
+    REQUIRE(tagStats(MemoryTracker::getStats(), MemoryTag::Physics).LiveBytes == before);
+    // An aligned allocation with a small alignment comes from the default allocator,
+    // the aligned delete must still free it with the matching function
+    void* small = ::operator new(64, std::align_val_t{8});
+    REQUIRE(tagStats(MemoryTracker::getStats(), MemoryTag::Physics).LiveBytes == before + 64);
+    ::operator delete(small, std::align_val_t{8});
+    REQUIRE(tagStats(MemoryTracker::getStats(), MemoryTag::Physics).LiveBytes == before);
+}
+
+TEST_CASE("GPU memory estimates are kept per tag", "[MemoryTracker]") {
+    auto before = tagStats(MemoryTracker::getStats(), MemoryTag::Rendering);
+    MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Texture, 4096);
+    MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Buffer, 512);
+
+    auto stats = tagStats(MemoryTracker::getStats(), MemoryTag::Rendering);
+    REQUIRE(stats.GpuTextureBytes == before.GpuTextureBytes + 4096);
+    REQUIRE(stats.GpuBufferBytes == before.GpuBufferBytes + 512);
+
+    MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Texture, -4096);
+    MemoryTracker::trackGpuMemory(MemoryTag::Rendering, GpuMemoryKind::Buffer, -512);
+    REQUIRE(tagStats(MemoryTracker::getStats(), MemoryTag::Rendering).GpuTextureBytes == before.GpuTextureBytes);
+}
+
+TEST_CASE("Captured callstacks follow live allocations", "[MemoryTracker]") {
+    MemoryTracker::setCallstackCapture(true);
+    auto leak = createUniquePtr<std::array<char, 64>>();
+    MemoryTracker::setCallstackCapture(false);
+    REQUIRE(MemoryTracker::reportCapturedAllocations(1) >= 1);
+
+    leak.reset();
+    REQUIRE(MemoryTracker::reportCapturedAllocations(0) == 0);
+}
+
+static Task<> frameScript(Input& input, uint32_t& presses) {
+    for (;;) {
+        co_await nextFrame();
+        if (input.isKeyPressed(SDL_SCANCODE_SPACE)) {
+            ++presses;
+        }
+        co_await waitSeconds(0.05);
+        co_await waitForPhase(TaskPhase::FrameEnd);
+    }
+}
+
+TEST_CASE("The steady state frame loop does not allocate", "[MemoryTracker]") {
+    TaskScheduler scheduler;
+    Input input;
+    AudioMixer mixer(48000);
+    std::vector<float> samples(4800);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = (i % 100) < 50 ? 0.25f : -0.25f;
+    }
+    mixer.play(AudioClip::fromSamples(std::move(samples), 1, 48000), {.Loop = true});
+    std::vector<float> output(256 * 2);
+
+    uint32_t presses = 0;
+    for (int i = 0; i < 64; ++i) {
+        scheduler.spawn(frameScript(input, presses));
+    }
+
+    SDL_Event key{};
+    key.key.keysym.scancode = SDL_SCANCODE_SPACE;
+    auto runFrame = [&](uint32_t frame) {
+        input.beginFrame();
+        key.type = frame % 2 == 0 ? SDL_KEYDOWN : SDL_KEYUP;
+        input.processEvent(key);
+        scheduler.beginFrame(1.0 / 60.0);
+        mixer.update();
+        mixer.render(output.data(), 256);
+        scheduler.runPhase(TaskPhase::PreRender);
+        scheduler.runPhase(TaskPhase::FrameEnd);
+    };
+
+    // Containers reach their final capacity during warm up
+    for (uint32_t frame = 0; frame < 120; ++frame) {
+        runFrame(frame);
+    }
+
+    MemoryFrameStats worst;
+    for (uint32_t frame = 0; frame < 240; ++frame) {
+        MemoryTracker::beginFrame();
+        runFrame(frame);
+        auto stats = MemoryTracker::endFrame();
+        worst.Allocations = std::max(worst.Allocations, stats.Allocations);
+        worst.Bytes = std::max(worst.Bytes, stats.Bytes);
+    }
+    REQUIRE(presses > 0);
+    REQUIRE(worst.Allocations == 0);
+    REQUIRE(worst.Bytes == 0);
+    REQUIRE(MemoryTracker::getStats().Frames >= 240);
+}
+
+#else
+
+TEST_CASE("The steady state frame loop does not allocate", "[MemoryTracker]") {
+    SKIP("Memory tracking is compiled out");
+}
+
+#endif
@@ -0,0 +1,70 @@
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+#include "core/spsc_queue.h"
+
+using namespace TriHarder;
+
+TEST_CASE("SpscQueue rounds the capacity up to a power of two", "[SpscQueue]") {
+    SpscQueue<int> queue(5);
+    REQUIRE(queue.capacity() == 8);
+
+    for (int i = 0; i < 8; ++i) {
+        REQUIRE(queue.push(i));
+    }
+    REQUIRE_FALSE(queue.push(8));
+    REQUIRE(queue.size() == 8);
+
+    int value = -1;
+    for (int i = 0; i < 8; ++i) {
+        REQUIRE(queue.pop(value));
+        REQUIRE(value == i);
+    }
+    REQUIRE_FALSE(queue.pop(value));
+}
+
+TEST_CASE("SpscQueue bulk operations wrap around the ring", "[SpscQueue]") {
+    SpscQueue<int> queue(8);
+    int input[6] = {1, 2, 3, 4, 5, 6};
+    int output[8] = {};
+
+    REQUIRE(queue.pushBulk(input, 6) == 6);
+    REQUIRE(queue.popBulk(output, 4) == 4);
+    // Writes past the end of the storage and continues at the front
+    REQUIRE(queue.pushBulk(input, 6) == 6);
+    REQUIRE(queue.pushBulk(input, 6) == 0);
+
+    REQUIRE(queue.popBulk(output, 8) == 8);
+    int expected[8] = {5, 6, 1, 2, 3, 4, 5, 6};
+    for (int i = 0; i < 8; ++i) {
+        REQUIRE(output[i] == expected[i]);
+    }
+    REQUIRE(queue.popBulk(output, 8) == 0);
+}
+
+TEST_CASE("SpscQueue delivers every item in order across threads", "[SpscQueue]") {
+    constexpr uint32_t Count = 200000;
+    SpscQueue<uint32_t> queue(64);
+
+    std::thread producer([&queue]() {
+        for (uint32_t i = 0; i < Count;) {
+            if (queue.push(i)) {
+                ++i;
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    bool ordered = true;
+    uint32_t value = 0;
+    while (expected < Count) {
+        if (queue.pop(value)) {
+            ordered = ordered && value == expected;
+            ++expected;
+        }
+    }
+    producer.join();
+
+    REQUIRE(ordered);
+    REQUIRE(queue.size() == 0);
+}
@@ -0,0 +1,75 @@
+#include <catch2/catch_test_macros.hpp>
+#include "core/string_id.h"
+#include "core/string_id_map.h"
+
+using namespace TriHarder;
+
+TEST_CASE("StringId hashes literals at compile time", "[StringId]") {
+    constexpr StringId literal = "player";
+    static_assert(literal == "player"_sid);
+    static_assert(literal.isValid());
+    static_assert(StringId::hash("player") == literal);
+    static_assert(StringId() != literal);
+
+    SECTION("runtime strings produce the same id as literals") {
+        String name = "player";
+        REQUIRE(StringId::intern(name) == literal);
+    }
+
+    SECTION("interned strings can be looked up again") {
+        auto id = StringId::intern("enemy.spawn");
+        REQUIRE(id.getString() == "enemy.spawn");
+    }
+
+    SECTION("ids that were never interned have no string") {
+        REQUIRE(StringId::hash("never interned").getString() == "<unknown>");
+    }
+}
+
+TEST_CASE("StringIdMap stores and removes values", "[StringIdMap]") {
+    StringIdMap<int> map;
+
+    SECTION("inserted values can be found") {
+        map.insertOrAssign("a"_sid, 1);
+        map.insertOrAssign("b"_sid, 2);
+        REQUIRE(map.size() == 2);
+        REQUIRE(*map.find("a"_sid) == 1);
+        REQUIRE(*map.find("b"_sid) == 2);
+        REQUIRE(map.find("c"_sid) == nullptr);
+    }
+
+    SECTION("assigning an existing key replaces the value") {
+        map.insertOrAssign("a"_sid, 1);
+        map.insertOrAssign("a"_sid, 5);
+        REQUIRE(map.size() == 1);
+        REQUIRE(*map.find("a"_sid) == 5);
+    }
+
+    SECTION("erase keeps colliding probe chains intact") {
+        // Ids sharing the low bits end up in one probe chain
+        map.reserve(8);
+        auto home = [](uint64_t slot, uint64_t tag) { return StringId::fromHash((tag << 32) | slot); };
+        for (uint64_t i = 1; i <= 5; ++i) {
+            map[home(3, i)] = static_cast<int>(i);
+        }
+        REQUIRE(map.erase(home(3, 2)));
+        REQUIRE_FALSE(map.erase(home(3, 2)));
+        for (uint64_t i = 1; i <= 5; ++i) {
+            if (i == 2) {
+                REQUIRE_FALSE(map.contains(home(3, i)));
+            } else {
+                REQUIRE(*map.find(home(3, i)) == static_cast<int>(i));
+            }
+        }
+    }
+
+    SECTION("growing keeps all entries") {
+        for (int i = 0; i < 1000; ++i) {
+            map[StringId::hash("key" + std::to_string(i))] = i;
+        }
+        REQUIRE(map.size() == 1000);
+        for (int i = 0; i < 1000; ++i) {
+            REQUIRE(*map.find(StringId::hash("key" + std::to_string(i))) == i);
+        }
+    }
+}
@@ -0,0 +1,231 @@
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+#include "core/task.h"
+
+using namespace TriHarder;
+
+static Task<> countFrames(int& counter, int frames) {
+    for (int i = 0; i < frames; ++i) {
+        ++counter;
+        co_await nextFrame();
+    }
+    co_return;
+}
+
+static Task<int> add(int a, int b) {
+    co_await nextFrame();
+    co_return a + b;
+}
+
+static Task<int> fail(String message) {
+    co_return Result<int>::error(std::move(message));
+}
+
+TEST_CASE("Tasks waiting for the next frame resume once per frame", "[Task]") {
+    TaskScheduler scheduler;
+    int counter = 0;
+    scheduler.spawn(countFrames(counter, 3));
+
+    // Runs until the first suspension inside spawn()
+    REQUIRE(counter == 1);
+    REQUIRE(scheduler.getTaskCount() == 1);
+
+    scheduler.runPhase(TaskPhase::PreRender);
+    REQUIRE(counter == 1);
+
+    scheduler.beginFrame(0.016);
+    REQUIRE(counter == 2);
+    scheduler.beginFrame(0.016);
+    REQUIRE(counter == 3);
+    scheduler.beginFrame(0.016);
+    REQUIRE(counter == 3);
+    REQUIRE(scheduler.getTaskCount() == 0);
+}
+
+TEST_CASE("Tasks resume at the requested frame phase", "[Task]") {
+    TaskScheduler scheduler;
+    std::vector<TaskPhase> order;
+    auto script = [](std::vector<TaskPhase>& order) -> Task<> {
+        co_await waitForPhase(TaskPhase::FrameEnd);
+        order.push_back(TaskPhase::FrameEnd);
+        co_await nextFrame();
+        order.push_back(TaskPhase::FrameStart);
+        co_await waitForPhase(TaskPhase::PreRender);
+        order.push_back(TaskPhase::PreRender);
+    };
+    scheduler.spawn(script(order));
+
+    scheduler.beginFrame(0.0);
+    scheduler.runPhase(TaskPhase::PreRender);
+    scheduler.runPhase(TaskPhase::FrameEnd);
+    scheduler.beginFrame(0.0);
+    scheduler.runPhase(TaskPhase::PreRender);
+    REQUIRE(order == std::vector<TaskPhase>{TaskPhase::FrameEnd, TaskPhase::FrameStart, TaskPhase::PreRender});
+}
+
+TEST_CASE("Tasks wait for scheduler time to pass", "[Task]") {
+    TaskScheduler scheduler;
+    std::vector<int> woken;
+    auto sleeper = [](std::vector<int>& woken, int id, double seconds) -> Task<> {
+        co_await waitSeconds(seconds);
+        woken.push_back(id);
+    };
+    scheduler.spawn(sleeper(woken, 2, 0.5));
+    scheduler.spawn(sleeper(woken, 1, 0.25));
+    scheduler.spawn(sleeper(woken, 3, 0.5));
+
+    scheduler.beginFrame(0.2);
+    REQUIRE(woken.empty());
+    scheduler.beginFrame(0.2);
+    REQUIRE(woken == std::vector<int>{1});
+    scheduler.beginFrame(0.2);
+    REQUIRE(woken == std::vector<int>{1, 2, 3});
+    REQUIRE(scheduler.getTaskCount() == 0);
+}
+
+TEST_CASE("Awaiting a task yields its result", "[Task]") {
+    TaskScheduler scheduler;
+    std::vector<String> log;
+    auto parent = [](std::vector<String>& log) -> Task<> {
+        auto sum = co_await add(2, 3);
+        log.push_back(std::to_string(sum.unwrap()));
+        auto error = co_await fail("missing texture");
+        log.push_back(error.unwrap_err());
+    };
+    scheduler.spawn(parent(log));
+
+    REQUIRE(log.empty());
+    scheduler.beginFrame(0.016);
+    REQUIRE(log == std::vector<String>{"5", "missing texture"});
+}
+
+TEST_CASE("Void tasks finish with co_return, their end or failTask", "[Task]") {
+    TaskScheduler scheduler;
+    auto finish = [](int mode) -> Task<> {
+        co_await nextFrame();
+        if (mode == 0) {
+            co_return;
+        }
+        if (mode == 1) {
+            co_await failTask("no scene");
+        }
+    };
+    auto parent = [&finish](std::vector<String>& log) -> Task<> {
+        for (int mode = 0; mode < 3; ++mode) {
+            auto result = co_await finish(mode);
+            log.push_back(result.is_ok() ? "ok" : result.unwrap_err());
+        }
+    };
+
+    std::vector<String> log;
+    scheduler.spawn(parent(log));
+    // A spawned task that fails is released like one that returns
+    scheduler.spawn(finish(1));
+    REQUIRE(scheduler.getTaskCount() == 2);
+    for (int frame = 0; frame < 3; ++frame) {
+        scheduler.beginFrame(0.016);
+    }
+    REQUIRE(log == std::vector<String>{"ok", "no scene", "ok"});
+    REQUIRE(scheduler.getTaskCount() == 0);
+}
+
+TEST_CASE("Exceptions propagate to the awaiting task", "[Task]") {
+    TaskScheduler scheduler;
+    bool caught = false;
+    auto thrower = []() -> Task<int> {
+        throw std::runtime_error("broken");
+        co_return 0;
+    };
+    auto parent = [&thrower](bool& caught) -> Task<> {
+        try {
+            co_await thrower();
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+    };
+    scheduler.spawn(parent(caught));
+    REQUIRE(caught);
+}
+
+TEST_CASE("Tasks wait for values produced on other threads", "[Task]") {
+    TaskScheduler scheduler;
+    auto texture = createSharedPtr<AsyncValue<int>>();
+    int loaded = 0;
+    auto waiter = [](SharedPtr<AsyncValue<int>> texture, int& loaded) -> Task<> {
+        auto result = co_await waitUntilReady(texture);
+        loaded = result.unwrap();
+    };
+    scheduler.spawn(waiter(texture, loaded));
+    scheduler.spawn(waiter(texture, loaded));
+
+    std::thread producer([texture]() { texture->set(Result<int>::ok(42)); });
+    producer.join();
+    REQUIRE(loaded == 0);
+
+    // Completions from other threads are picked up at the next frame start
+    scheduler.beginFrame(0.016);
+    REQUIRE(loaded == 42);
+    REQUIRE(scheduler.getTaskCount() == 0);
+
+    // An already set value does not suspend
+    loaded = 0;
+    scheduler.spawn(waiter(texture, loaded));
+    REQUIRE(loaded == 42);
+}
+
+TEST_CASE("Tasks wait for jobs", "[Task]") {
+    TaskScheduler scheduler;
+    int value = 0;
+    auto script = [](int& value) -> Task<> {
+        value = co_await runJob([]() { return 21 * 2; });
+        co_await runJob([&value]() { ++value; });
+    };
+    scheduler.spawn(script(value));
+
+    for (int frame = 0; frame < 1000 && scheduler.getTaskCount() > 0; ++frame) {
+        scheduler.beginFrame(0.016);
+        std::this_thread::yield();
+    }
+    REQUIRE(value == 43);
+}
+
+TEST_CASE("TaskScheduler destroys unfinished tasks and recycles their frames", "[Task]") {
+    struct Guard {
+        int& Alive;
+        explicit Guard(int& alive) : Alive(alive) { ++Alive; }
+        ~Guard() { --Alive; }
+    };
+    auto forever = [](int& alive) -> Task<> {
+        Guard guard(alive);
+        co_await waitSeconds(1e9);
+    };
+
+    int alive = 0;
+    auto before = TaskFramePool::getStats();
+    {
+        TaskScheduler scheduler;
+        for (int i = 0; i < 1000; ++i) {
+            scheduler.spawn(forever(alive));
+        }
+        REQUIRE(alive == 1000);
+        REQUIRE(TaskFramePool::getStats().LiveFrames == before.LiveFrames + 1000);
+
+        // Idle tasks are not resumed
+        scheduler.beginFrame(1.0);
+        REQUIRE(scheduler.getResumedThisFrame() == 0);
+    }
+    REQUIRE(alive == 0);
+
+    auto after = TaskFramePool::getStats();
+    REQUIRE(after.LiveFrames == before.LiveFrames);
+
+    // The second round reuses the frames of the first one
+    {
+        TaskScheduler scheduler;
+        for (int i = 0; i < 1000; ++i) {
+            scheduler.spawn(forever(alive));
+        }
+    }
+    REQUIRE(TaskFramePool::getStats().SlabBytes == after.SlabBytes);
+}
@@ -0,0 +1,96 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "effects/particle_system.h"
+
+using namespace TriHarder;
+
+static EmitterDescriptor createDescriptor() {
+    EmitterDescriptor descriptor;
+    descriptor.SpawnRate = 0.0f;
+    descriptor.LifetimeMin = 1.0f;
+    descriptor.LifetimeMax = 1.0f;
+    descriptor.MaxParticles = 1000;
+    return descriptor;
+}
+
+TEST_CASE("ParticleSystem emits up to the pool capacity", "[ParticleSystem]") {
+    ParticleSystem system(64);
+    auto descriptor = createDescriptor();
+    descriptor.SpawnRate = 100.0f;
+    auto emitter = system.createEmitter(descriptor);
+
+    system.update(0.1f);
+    REQUIRE(system.getEmitter(emitter).Pool.Count == 10);
+
+    system.burst(emitter, 5000);
+    system.update(0.1f);
+    REQUIRE(system.getEmitter(emitter).Pool.Count == 1000);
+
+    system.setEmitterActive(emitter, false);
+    system.update(0.1f);
+    REQUIRE(system.getStats().Emitted == 0);
+}
+
+TEST_CASE("ParticleSystem integrates velocity and gravity", "[ParticleSystem]") {
+    ParticleSystem system;
+    auto descriptor = createDescriptor();
+    descriptor.Position = {1.0f, 2.0f, 3.0f};
+    descriptor.VelocityMin = {1.0f, 0.0f, 0.0f};
+    descriptor.VelocityMax = {1.0f, 0.0f, 0.0f};
+    descriptor.Gravity = {0.0f, -10.0f, 0.0f};
+    auto emitter = system.createEmitter(descriptor);
+
+    // Odd count exercises the SIMD and the scalar remainder path
+    system.burst(emitter, 7);
+    system.update(0.1f);
+
+    const auto& pool = system.getEmitter(emitter).Pool;
+    REQUIRE(pool.Count == 7);
+    for (uint32_t i = 0; i < pool.Count; ++i) {
+        REQUIRE(pool.VelocityY[i] == Catch::Approx(-1.0f));
+        REQUIRE(pool.PositionX[i] == Catch::Approx(1.1f));
+        REQUIRE(pool.PositionY[i] == Catch::Approx(1.9f));
+        REQUIRE(pool.PositionZ[i] == Catch::Approx(3.0f));
+        REQUIRE(pool.Life[i] == Catch::Approx(0.1f));
+    }
+}
+
+TEST_CASE("ParticleSystem removes dead particles and keeps the live ones", "[ParticleSystem]") {
+    ParticleSystem system(16);
+    auto descriptor = createDescriptor();
+    descriptor.LifetimeMin = 0.5f;
+    descriptor.LifetimeMax = 1.5f;
+    auto emitter = system.createEmitter(descriptor);
+
+    system.burst(emitter, 999);
+    system.update(0.0f);
+    for (int frame = 0; frame < 10; ++frame) {
+        uint64_t before = system.getParticleCount();
+        system.update(0.1f);
+        const auto& stats = system.getStats();
+        REQUIRE(system.getParticleCount() == before - stats.Killed);
+
+        const auto& pool = system.getEmitter(emitter).Pool;
+        for (uint32_t i = 0; i < pool.Count; ++i) {
+            REQUIRE(pool.Life[i] < 1.0f);
+        }
+    }
+    REQUIRE(system.getParticleCount() > 0);
+
+    system.update(1.0f);
+    REQUIRE(system.getParticleCount() == 0);
+}
+
+TEST_CASE("ParticleSystem reuses destroyed emitter slots", "[ParticleSystem]") {
+    ParticleSystem system;
+    auto first = system.createEmitter(createDescriptor());
+    system.burst(first, 10);
+    system.update(0.0f);
+
+    system.destroyEmitter(first);
+    REQUIRE(system.getParticleCount() == 0);
+
+    auto second = system.createEmitter(createDescriptor());
+    REQUIRE(second == first);
+    REQUIRE(system.getEmitter(second).Alive);
+}
@@ -0,0 +1,46 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdlib>
+#include <filesystem>
+#include "graphics/glyph_atlas.h"
+
+using namespace TriHarder;
+
+//! The repository ships no font, TRIHARDER_TEST_FONT or a common system font is used instead.
+static String findTestFont() {
+    if (const char* path = std::getenv("TRIHARDER_TEST_FONT")) {
+        return path;
+    }
+    for (const char* path : {"/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+                             "/usr/share/fonts/TTF/DejaVuSans.ttf",
+                             "/System/Library/Fonts/Supplemental/Arial.ttf",
+                             "C:/Windows/Fonts/arial.ttf"}) {
+        if (std::filesystem::exists(path)) {
+            return path;
+        }
+    }
+    return {};
+}
+
+TEST_CASE("GlyphAtlas caches whitespace without allocating a page", "[GlyphAtlas]") {
+    auto path = findTestFont();
+    if (path.empty()) {
+        SKIP("No font found, set TRIHARDER_TEST_FONT");
+    }
+    auto font = Font::load(path, 16);
+    REQUIRE(font.is_ok());
+
+    // Only whitespace never creates a page, so no OpenGL context is needed
+    GlyphAtlas atlas;
+    uint32_t space = font.unwrap()->getGlyphIndex(U' ');
+    for (int frame = 0; frame < 3; ++frame) {
+        atlas.beginFrame();
+        for (int i = 0; i < 2; ++i) {
+            const AtlasGlyph* glyph = atlas.getGlyph(*font.unwrap(), space);
+            REQUIRE(glyph);
+            REQUIRE(glyph->Width == 0.0f);
+            REQUIRE(glyph->Advance > 0.0f);
+        }
+    }
+    REQUIRE(atlas.getPageCount() == 0);
+    REQUIRE(atlas.getGlyphCount() == 1);
+}
@@ -0,0 +1,126 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include "graphics/image_io.h"
+
+using namespace TriHarder;
+
+static Image createGradient(uint32_t width, uint32_t height) {
+    Image image{width, height, std::vector<uint8_t>(size_t(width) * height * 4)};
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* pixel = &image.Pixels[(size_t(y) * width + x) * 4];
+            pixel[0] = static_cast<uint8_t>(x);
+            pixel[1] = static_cast<uint8_t>(y);
+            pixel[2] = static_cast<uint8_t>(x ^ y);
+            pixel[3] = 255;
+        }
+    }
+    return image;
+}
+
+static void appendChunk(std::vector<uint8_t>& file, const char* type, std::vector<uint8_t> data) {
+    uint32_t length = static_cast<uint32_t>(data.size());
+    file.insert(file.end(), {uint8_t(length >> 24), uint8_t(length >> 16), uint8_t(length >> 8), uint8_t(length)});
+    file.insert(file.end(), type, type + 4);
+    file.insert(file.end(), data.begin(), data.end());
+    // readPng does not verify the CRC
+    file.insert(file.end(), 4, 0);
+}
+
+static std::vector<uint8_t> createHeader(uint32_t width, uint32_t height) {
+    return {uint8_t(width >> 24), uint8_t(width >> 16), uint8_t(width >> 8), uint8_t(width),
+            uint8_t(height >> 24), uint8_t(height >> 16), uint8_t(height >> 8), uint8_t(height),
+            8, 6, 0, 0, 0};
+}
+
+TEST_CASE("PNG files round trip through writePng and readPng", "[ImageIO]") {
+    auto path = (std::filesystem::temp_directory_path() / "triharder_image_io_test.png").string();
+
+    SECTION("top-down pixels are preserved") {
+        // Larger than one stored deflate block
+        auto image = createGradient(300, 70);
+        REQUIRE(writePng(path, image.Width, image.Height, image.Pixels.data(), false));
+
+        auto result = readPng(path);
+        REQUIRE(result.is_ok());
+        auto loaded = result.unwrap();
+        REQUIRE(loaded.Width == 300);
+        REQUIRE(loaded.Height == 70);
+        REQUIRE(loaded.Pixels == image.Pixels);
+    }
+
+    SECTION("bottom-up pixels are flipped") {
+        auto image = createGradient(4, 3);
+        REQUIRE(writePng(path, image.Width, image.Height, image.Pixels.data(), true));
+
+        auto loaded = readPng(path).unwrap();
+        for (uint32_t y = 0; y < 3; ++y) {
+            REQUIRE(loaded.Pixels[y * 16 + 1] == 2 - y);
+        }
+    }
+
+    SECTION("invalid files are rejected") {
+        std::ofstream(path, std::ios::binary) << "not a png";
+        REQUIRE(readPng(path).is_error());
+    }
+
+    SECTION("malformed headers are rejected") {
+        const std::vector<uint8_t> signature = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        const std::vector<uint8_t> storedRow = {0x78, 0x01, 0x01, 0x05, 0x00, 0xFA, 0xFF, 0, 1, 2, 3, 4};
+        auto writeFile = [&path](const std::vector<uint8_t>& bytes) {
+            std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()),
+                                                        static_cast<std::streamsize>(bytes.size()));
+        };
+
+        auto valid = signature;
+        appendChunk(valid, "IHDR", createHeader(1, 1));
+        appendChunk(valid, "IDAT", storedRow);
+        appendChunk(valid, "IEND", {});
+        writeFile(valid);
+        REQUIRE(readPng(path).is_ok());
+
+        auto shortHeader = signature;
+        appendChunk(shortHeader, "IHDR", {0, 0, 0, 1});
+        writeFile(shortHeader);
+        REQUIRE(readPng(path).is_error());
+
+        auto dataFirst = signature;
+        appendChunk(dataFirst, "IDAT", storedRow);
+        appendChunk(dataFirst, "IHDR", createHeader(1, 1));
+        writeFile(dataFirst);
+        REQUIRE(readPng(path).is_error());
+
+        for (auto [width, height] : {std::pair{0u, 1u}, std::pair{1u, 0u}, std::pair{0xFFFFFFFFu, 0xFFFFFFFFu}}) {
+            auto oversized = signature;
+            appendChunk(oversized, "IHDR", createHeader(width, height));
+            appendChunk(oversized, "IDAT", storedRow);
+            writeFile(oversized);
+            REQUIRE(readPng(path).is_error());
+        }
+
+        // A valid size whose data cannot fit into the file
+        auto truncated = signature;
+        appendChunk(truncated, "IHDR", createHeader(4096, 4096));
+        appendChunk(truncated, "IDAT", storedRow);
+        writeFile(truncated);
+        REQUIRE(readPng(path).is_error());
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("compareImages honours the tolerance", "[ImageIO]") {
+    auto expected = createGradient(16, 16);
+    auto actual = expected;
+    actual.Pixels[0] += 2;
+    actual.Pixels[4 * 20] += 10;
+
+    auto difference = compareImages(actual, expected, 2);
+    REQUIRE_FALSE(difference.SizeMismatch);
+    REQUIRE(difference.MismatchedPixels == 1);
+    REQUIRE(difference.MaxChannelDelta == 10);
+
+    REQUIRE(compareImages(actual, expected, 10).MismatchedPixels == 0);
+    REQUIRE(compareImages(createGradient(8, 8), expected, 0).SizeMismatch);
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+#include "graphics/render_graph.h"
+
+using namespace TriHarder;
+
+namespace {
+    const RenderTextureDesc ColorDesc{1920, 1080, GL_RGBA16F};
+    const RenderTextureDesc DepthDesc{1920, 1080, GL_DEPTH24_STENCIL8};
+
+    void noExecute(const RenderPassContext&) {}
+}
+
+TEST_CASE("RenderGraph culls passes without consumers", "[RenderGraph]") {
+    RenderGraph graph;
+    auto backbuffer = graph.importBackbuffer(1920, 1080);
+    RenderResource scene = InvalidRenderResource;
+    RenderResource debug = InvalidRenderResource;
+
+    graph.addPass("scene", [&](RenderGraph::PassBuilder& builder) {
+        scene = builder.write(builder.create("scene.color", ColorDesc), LoadOp::Clear);
+    }, noExecute);
+    graph.addPass("debug", [&](RenderGraph::PassBuilder& builder) {
+        debug = builder.write(builder.create("debug.color", ColorDesc), LoadOp::Clear);
+    }, noExecute);
+    graph.addPass("present", [&](RenderGraph::PassBuilder& builder) {
+        builder.read(scene);
+        builder.write(backbuffer, LoadOp::DontCare);
+    }, noExecute);
+    graph.compile();
+
+    REQUIRE_FALSE(graph.isPassCulled("scene"));
+    REQUIRE(graph.isPassCulled("debug"));
+    REQUIRE_FALSE(graph.isPassCulled("present"));
+    REQUIRE(graph.getStats().CulledPasses == 1);
+    REQUIRE(graph.getStats().TransientResources == 1);
+    REQUIRE(graph.getPhysicalSlot(debug) == -1);
+}
+
+TEST_CASE("RenderGraph aliases transient textures with disjoint lifetimes", "[RenderGraph]") {
+    RenderGraph graph;
+    auto backbuffer = graph.importBackbuffer(1920, 1080);
+    RenderResource scene = InvalidRenderResource;
+    RenderResource depth = InvalidRenderResource;
+    RenderResource bright = InvalidRenderResource;
+    RenderResource blur = InvalidRenderResource;
+    RenderResource tonemapped = InvalidRenderResource;
+
+    graph.addPass("scene", [&](RenderGraph::PassBuilder& builder) {
+        scene = builder.write(builder.create("scene", ColorDesc), LoadOp::Clear);
+        depth = builder.write(builder.create("depth", DepthDesc), LoadOp::Clear);
+    }, noExecute);
+    graph.addPass("bright", [&](RenderGraph::PassBuilder& builder) {
+        builder.read(scene);
+        bright = builder.write(builder.create("bright", ColorDesc));
+    }, noExecute);
+    graph.addPass("blur", [&](RenderGraph::PassBuilder& builder) {
+        builder.read(bright);
+        blur = builder.write(builder.create("blur", ColorDesc));
+    }, noExecute);
+    graph.addPass("tonemap", [&](RenderGraph::PassBuilder& builder) {
+        builder.read(scene);
+        builder.read(blur);
+        tonemapped = builder.write(builder.create("tonemapped", ColorDesc));
+    }, noExecute);
+    graph.addPass("present", [&](RenderGraph::PassBuilder& builder) {
+        builder.read(tonemapped);
+        builder.write(backbuffer, LoadOp::DontCare);
+    }, noExecute);
+    graph.compile();
+
+    const auto& stats = graph.getStats();
+    REQUIRE(stats.CulledPasses == 0);
+    REQUIRE(stats.TransientResources == 5);
+
+    // "bright" is dead once "blur" ran, so "tonemapped" can reuse its texture
+    REQUIRE(graph.getPhysicalSlot(tonemapped) == graph.getPhysicalSlot(bright));
+    REQUIRE(graph.getPhysicalSlot(scene) != graph.getPhysicalSlot(blur));
+    REQUIRE(graph.getPhysicalSlot(depth) != graph.getPhysicalSlot(scene));
+    REQUIRE(stats.PhysicalTextures == 4);
+    REQUIRE(stats.TransientBytesWithAliasing < stats.TransientBytesWithoutAliasing);
+    REQUIRE(stats.Clears == 2);
+}
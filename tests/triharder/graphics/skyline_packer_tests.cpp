@@ -0,0 +1,43 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+#include "graphics/skyline_packer.h"
+
+using namespace TriHarder;
+
+static bool overlaps(const PackedRect& a, const PackedRect& b) {
+    return a.X < b.X + b.Width && b.X < a.X + a.Width && a.Y < b.Y + b.Height && b.Y < a.Y + a.Height;
+}
+
+TEST_CASE("SkylinePacker packs rectangles without overlap", "[SkylinePacker]") {
+    SkylinePacker packer(256, 256, 1);
+
+    SECTION("allocations stay inside the area and do not overlap") {
+        std::vector<PackedRect> rects;
+        for (uint32_t i = 0; i < 200; ++i) {
+            auto rect = packer.insert(5 + i % 13, 7 + i % 11);
+            REQUIRE(rect.has_value());
+            REQUIRE(rect->X + rect->Width <= 256);
+            REQUIRE(rect->Y + rect->Height <= 256);
+            for (const auto& other : rects) {
+                REQUIRE_FALSE(overlaps(*rect, other));
+            }
+            rects.push_back(*rect);
+        }
+        REQUIRE(packer.getOccupancy() > 0.0f);
+    }
+
+    SECTION("rectangles larger than the area are rejected") {
+        REQUIRE_FALSE(packer.insert(300, 10).has_value());
+        REQUIRE_FALSE(packer.insert(10, 300).has_value());
+    }
+
+    SECTION("a full packer accepts rectangles again after reset") {
+        while (packer.insert(31, 31).has_value()) {
+        }
+        REQUIRE_FALSE(packer.insert(31, 31).has_value());
+
+        packer.reset();
+        REQUIRE(packer.getOccupancy() == 0.0f);
+        REQUIRE(packer.insert(31, 31).has_value());
+    }
+}
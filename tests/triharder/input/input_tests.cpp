@@ -0,0 +1,179 @@
+#include <catch2/catch_test_macros.hpp>
+#include "input/input.h"
+
+using namespace TriHarder;
+
+static SDL_Event makeKeyEvent(Uint32 type, SDL_Scancode scancode) {
+    SDL_Event event{};
+    event.type = type;
+    event.key.keysym.scancode = scancode;
+    return event;
+}
+
+TEST_CASE("Input tracks key state and per-frame edges", "[Input]") {
+    Input input;
+    const auto key = SDL_SCANCODE_A;
+
+    input.beginFrame();
+    input.processEvent(makeKeyEvent(SDL_KEYDOWN, key));
+    REQUIRE(input.isKeyDown(key));
+    REQUIRE(input.isKeyPressed(key));
+
+    SECTION("pressed edge only lasts one frame") {
+        input.beginFrame();
+        REQUIRE(input.isKeyDown(key));
+        REQUIRE_FALSE(input.isKeyPressed(key));
+    }
+
+    SECTION("release produces a released edge") {
+        input.beginFrame();
+        input.processEvent(makeKeyEvent(SDL_KEYUP, key));
+        REQUIRE_FALSE(input.isKeyDown(key));
+        REQUIRE(input.isKeyReleased(key));
+    }
+
+    SECTION("repeated key events are ignored") {
+        input.beginFrame();
+        auto repeat = makeKeyEvent(SDL_KEYDOWN, key);
+        repeat.key.repeat = 1;
+        input.processEvent(repeat);
+        REQUIRE_FALSE(input.isKeyPressed(key));
+    }
+}
+
+TEST_CASE("Input latches edges until the next frame starts", "[Input]") {
+    Input input;
+    const auto key = SDL_SCANCODE_ESCAPE;
+    const ActionId fire = 1;
+    input.bindMouseButton(fire, SDL_BUTTON_LEFT);
+
+    SECTION("an edge from the second sample of a frame is kept for the rest of the frame") {
+        input.beginFrame();
+        // First sample before the simulation has no events, the second one before rendering has the press
+        input.processEvent(makeKeyEvent(SDL_KEYDOWN, key));
+        REQUIRE(input.isKeyPressed(key));
+
+        // A following sample within the same frame does not clear it
+        SDL_Event motion{};
+        motion.type = SDL_MOUSEMOTION;
+        input.processEvent(motion);
+        REQUIRE(input.isKeyPressed(key));
+
+        input.beginFrame();
+        REQUIRE(input.isKeyDown(key));
+        REQUIRE_FALSE(input.isKeyPressed(key));
+    }
+
+    SECTION("a press and release within one sample produces both edges") {
+        input.beginFrame();
+        input.processEvent(makeKeyEvent(SDL_KEYDOWN, key));
+        input.processEvent(makeKeyEvent(SDL_KEYUP, key));
+        REQUIRE_FALSE(input.isKeyDown(key));
+        REQUIRE(input.isKeyPressed(key));
+        REQUIRE(input.isKeyReleased(key));
+
+        SDL_Event button{};
+        button.button.button = SDL_BUTTON_LEFT;
+        button.type = SDL_MOUSEBUTTONDOWN;
+        input.processEvent(button);
+        button.type = SDL_MOUSEBUTTONUP;
+        input.processEvent(button);
+        REQUIRE(input.isMouseButtonPressed(SDL_BUTTON_LEFT));
+        REQUIRE(input.isMouseButtonReleased(SDL_BUTTON_LEFT));
+        REQUIRE(input.isActionPressed(fire));
+        REQUIRE(input.isActionReleased(fire));
+        REQUIRE_FALSE(input.isActionDown(fire));
+    }
+}
+
+TEST_CASE("Input tracks gamepad button edges", "[Input]") {
+    Input input;
+    input.connectVirtualGamepad(5);
+    const uint8_t button = SDL_CONTROLLER_BUTTON_A;
+
+    SDL_Event event{};
+    event.cbutton.which = 5;
+    event.cbutton.button = button;
+    input.beginFrame();
+    event.type = SDL_CONTROLLERBUTTONDOWN;
+    input.processEvent(event);
+    REQUIRE(input.isGamepadButtonDown(0, button));
+    REQUIRE(input.isGamepadButtonPressed(0, button));
+    REQUIRE_FALSE(input.isGamepadButtonReleased(0, button));
+
+    SECTION("release produces a released edge for one frame") {
+        input.beginFrame();
+        REQUIRE_FALSE(input.isGamepadButtonPressed(0, button));
+        event.type = SDL_CONTROLLERBUTTONUP;
+        input.processEvent(event);
+        REQUIRE_FALSE(input.isGamepadButtonDown(0, button));
+        REQUIRE(input.isGamepadButtonReleased(0, button));
+
+        input.beginFrame();
+        REQUIRE_FALSE(input.isGamepadButtonReleased(0, button));
+    }
+
+    SECTION("a press and release within one sample produces both edges") {
+        event.type = SDL_CONTROLLERBUTTONUP;
+        input.processEvent(event);
+        REQUIRE_FALSE(input.isGamepadButtonDown(0, button));
+        REQUIRE(input.isGamepadButtonPressed(0, button));
+        REQUIRE(input.isGamepadButtonReleased(0, button));
+    }
+}
+
+TEST_CASE("Input maps several bindings onto one action", "[Input]") {
+    Input input;
+    const ActionId jump = 3;
+    const auto space = SDL_SCANCODE_SPACE;
+    const auto up = SDL_SCANCODE_UP;
+    input.bindKey(jump, space);
+    input.bindKey(jump, up);
+
+    input.beginFrame();
+    input.processEvent(makeKeyEvent(SDL_KEYDOWN, space));
+    input.processEvent(makeKeyEvent(SDL_KEYDOWN, up));
+    REQUIRE(input.isActionPressed(jump));
+
+    input.beginFrame();
+    input.processEvent(makeKeyEvent(SDL_KEYUP, space));
+    REQUIRE(input.isActionDown(jump));
+    REQUIRE_FALSE(input.isActionReleased(jump));
+
+    input.processEvent(makeKeyEvent(SDL_KEYUP, up));
+    REQUIRE_FALSE(input.isActionDown(jump));
+    REQUIRE(input.isActionReleased(jump));
+}
+
+TEST_CASE("Input accumulates mouse movement per frame", "[Input]") {
+    Input input;
+    input.beginFrame();
+
+    SDL_Event motion{};
+    motion.type = SDL_MOUSEMOTION;
+    motion.motion.x = 10;
+    motion.motion.y = 20;
+    motion.motion.xrel = 3;
+    motion.motion.yrel = -2;
+    input.processEvent(motion);
+    input.processEvent(motion);
+
+    REQUIRE(input.getMouseX() == 10);
+    REQUIRE(input.getMouseDeltaX() == 6);
+    REQUIRE(input.getMouseDeltaY() == -4);
+
+    input.beginFrame();
+    REQUIRE(input.getMouseDeltaX() == 0);
+}
+
+TEST_CASE("Input records latency for presented frames", "[Input]") {
+    Input input;
+    input.beginFrame();
+    input.markPresented();
+    REQUIRE(input.getLatencyStats().Frames == 0);
+
+    input.processEvent(makeKeyEvent(SDL_KEYDOWN, SDL_SCANCODE_A));
+    input.markPresented();
+    REQUIRE(input.getLatencyStats().Frames == 1);
+    REQUIRE(input.getLatencyStats().AverageSampleToPresentMs >= 0.0);
+}
@@ -0,0 +1,247 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <random>
+#include "physics/spatial_hash_broadphase.h"
+#include "physics/sweep_and_prune_broadphase.h"
+
+using namespace TriHarder;
+
+static Aabb randomBox(std::mt19937& random, float worldSize, float maxSize) {
+    std::uniform_real_distribution<float> position(-worldSize, worldSize);
+    std::uniform_real_distribution<float> size(0.05f, maxSize);
+    Float3 min{position(random), position(random), position(random)};
+    return {min, {min.X + size(random), min.Y + size(random), min.Z + size(random)}};
+}
+
+static std::vector<BroadphasePair> bruteForcePairs(const std::vector<Aabb>& boxes, const std::vector<ProxyId>& ids) {
+    std::vector<BroadphasePair> pairs;
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        for (size_t j = i + 1; j < boxes.size(); ++j) {
+            if (boxes[i].overlaps(boxes[j])) {
+                pairs.push_back({std::min(ids[i], ids[j]), std::max(ids[i], ids[j])});
+            }
+        }
+    }
+    return pairs;
+}
+
+static void sortPairs(std::vector<BroadphasePair>& pairs) {
+    std::sort(pairs.begin(), pairs.end(), [](const BroadphasePair& a, const BroadphasePair& b) {
+        return a.A != b.A ? a.A < b.A : a.B < b.B;
+    });
+}
+
+static void checkBroadphase(IBroadphase& broadphase) {
+    std::mt19937 random(1234);
+    std::vector<Aabb> boxes;
+    std::vector<ProxyId> ids;
+    for (uint64_t i = 0; i < 500; ++i) {
+        // A few boxes span many cells of the spatial hash
+        boxes.push_back(randomBox(random, 20.0f, i % 50 == 0 ? 15.0f : 2.0f));
+        ids.push_back(broadphase.createProxy(boxes.back(), i));
+    }
+    broadphase.update();
+
+    SECTION("pairs match a brute force search") {
+        std::vector<BroadphasePair> pairs;
+        broadphase.findPairs(pairs);
+        auto expected = bruteForcePairs(boxes, ids);
+        sortPairs(pairs);
+        sortPairs(expected);
+        REQUIRE(pairs == expected);
+    }
+
+    SECTION("pairs follow moved proxies") {
+        for (size_t i = 0; i < boxes.size(); i += 3) {
+            float shift = (i % 2 == 0) ? 0.3f : 6.0f;
+            boxes[i].Min.X += shift;
+            boxes[i].Max.X += shift;
+            broadphase.moveProxy(ids[i], boxes[i]);
+        }
+        broadphase.update();
+
+        std::vector<BroadphasePair> pairs;
+        broadphase.findPairs(pairs);
+        auto expected = bruteForcePairs(boxes, ids);
+        sortPairs(pairs);
+        sortPairs(expected);
+        REQUIRE(pairs == expected);
+    }
+
+    SECTION("destroyed proxies no longer pair") {
+        for (size_t i = 0; i < boxes.size(); i += 2) {
+            broadphase.destroyProxy(ids[i]);
+        }
+        broadphase.update();
+        REQUIRE(broadphase.getProxyCount() == 250);
+
+        std::vector<Aabb> remainingBoxes;
+        std::vector<ProxyId> remainingIds;
+        for (size_t i = 1; i < boxes.size(); i += 2) {
+            remainingBoxes.push_back(boxes[i]);
+            remainingIds.push_back(ids[i]);
+        }
+
+        std::vector<BroadphasePair> pairs;
+        broadphase.findPairs(pairs);
+        auto expected = bruteForcePairs(remainingBoxes, remainingIds);
+        sortPairs(pairs);
+        sortPairs(expected);
+        REQUIRE(pairs == expected);
+    }
+
+    SECTION("queries match a brute force search") {
+        for (int query = 0; query < 20; ++query) {
+            auto box = randomBox(random, 20.0f, 8.0f);
+            std::vector<ProxyId> results;
+            broadphase.queryAabb(box, results);
+            std::sort(results.begin(), results.end());
+
+            std::vector<ProxyId> expected;
+            for (size_t i = 0; i < boxes.size(); ++i) {
+                if (boxes[i].overlaps(box)) {
+                    expected.push_back(ids[i]);
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+            REQUIRE(results == expected);
+
+            Float3 center = box.Min;
+            std::vector<ProxyId> inRadius;
+            broadphase.queryRadius(center, 3.0f, inRadius);
+            std::sort(inRadius.begin(), inRadius.end());
+            expected.clear();
+            for (size_t i = 0; i < boxes.size(); ++i) {
+                if (overlapsSphere(boxes[i], center, 3.0f)) {
+                    expected.push_back(ids[i]);
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+            REQUIRE(inRadius == expected);
+        }
+    }
+
+    SECTION("raycasts report every crossed proxy nearest first") {
+        Float3 origin{-25.0f, 0.5f, 0.5f};
+        Float3 direction{1.0f, 0.0f, 0.0f};
+        std::vector<RaycastHit> hits;
+        broadphase.raycast(origin, direction, 50.0f, hits);
+
+        Float3 inverse{1.0f, 1.0f / 0.0f, 1.0f / 0.0f};
+        size_t expected = 0;
+        for (const auto& box : boxes) {
+            float distance = 0.0f;
+            expected += intersectRay(box, origin, inverse, 50.0f, distance) ? 1 : 0;
+        }
+        REQUIRE(hits.size() == expected);
+        REQUIRE(std::is_sorted(hits.begin(), hits.end(), [](const RaycastHit& a, const RaycastHit& b) {
+            return a.Distance < b.Distance;
+        }));
+    }
+
+    SECTION("raycasts with a huge finite distance report every crossed proxy") {
+        Float3 origin{0.5f, -25.0f, 0.5f};
+        Float3 direction{0.0f, 1.0f, 0.0f};
+        const float maxDistance = std::numeric_limits<float>::max();
+        std::vector<RaycastHit> hits;
+        broadphase.raycast(origin, direction, maxDistance, hits);
+
+        Float3 inverse{1.0f / 0.0f, 1.0f, 1.0f / 0.0f};
+        size_t expected = 0;
+        for (const auto& box : boxes) {
+            float distance = 0.0f;
+            expected += intersectRay(box, origin, inverse, maxDistance, distance) ? 1 : 0;
+        }
+        REQUIRE(expected > 0);
+        REQUIRE(hits.size() == expected);
+    }
+}
+
+TEST_CASE("SpatialHashBroadphase finds overlaps", "[Broadphase]") {
+    SpatialHashBroadphase broadphase(2.0f);
+    checkBroadphase(broadphase);
+}
+
+TEST_CASE("SweepAndPruneBroadphase finds overlaps", "[Broadphase]") {
+    SweepAndPruneBroadphase broadphase;
+    checkBroadphase(broadphase);
+}
+
+//! @param axis Axis the moved proxies are shifted along.
+static void checkDeferredUpdates(IBroadphase& broadphase, int axis) {
+    std::mt19937 random(99);
+    std::vector<Aabb> boxes;
+    std::vector<ProxyId> ids;
+    for (uint64_t i = 0; i < 200; ++i) {
+        boxes.push_back(randomBox(random, 20.0f, 2.0f));
+        ids.push_back(broadphase.createProxy(boxes.back(), i));
+    }
+    broadphase.update();
+
+    auto query = [&](const Aabb& box) {
+        std::vector<ProxyId> results;
+        broadphase.queryAabb(box, results);
+        std::sort(results.begin(), results.end());
+        return results;
+    };
+    auto bruteForce = [&](const std::vector<Aabb>& state, const Aabb& box) {
+        std::vector<ProxyId> results;
+        for (size_t i = 0; i < state.size(); ++i) {
+            if (state[i].overlaps(box)) {
+                results.push_back(ids[i]);
+            }
+        }
+        std::sort(results.begin(), results.end());
+        return results;
+    };
+
+    auto moved = boxes;
+    for (size_t i = 0; i < moved.size(); i += 2) {
+        float shift = (i % 4 == 0) ? 30.0f : -30.0f;
+        moved[i].Min[axis] += shift;
+        moved[i].Max[axis] += shift;
+        broadphase.moveProxy(ids[i], moved[i]);
+    }
+    ProxyId added = broadphase.createProxy({{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}}, 200);
+    REQUIRE(broadphase.getProxyCount() == 201);
+    REQUIRE(broadphase.getBounds(ids[0]).Min.X == moved[0].Min.X);
+
+    for (int i = 0; i < 20; ++i) {
+        auto box = randomBox(random, 50.0f, 10.0f);
+        REQUIRE(query(box) == bruteForce(boxes, box));
+    }
+
+    broadphase.update();
+    moved.push_back({{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}});
+    ids.push_back(added);
+    for (int i = 0; i < 20; ++i) {
+        auto box = randomBox(random, 50.0f, 10.0f);
+        REQUIRE(query(box) == bruteForce(moved, box));
+    }
+}
+
+TEST_CASE("SpatialHashBroadphase queries see the state of the last update", "[Broadphase]") {
+    SpatialHashBroadphase broadphase(2.0f);
+    checkDeferredUpdates(broadphase, 0);
+}
+
+TEST_CASE("SweepAndPruneBroadphase queries see the state of the last update", "[Broadphase]") {
+    SweepAndPruneBroadphase broadphase;
+    // Moving far along the sort axis would break the order of the sorted entries
+    checkDeferredUpdates(broadphase, broadphase.getSortAxis());
+}
+
+TEST_CASE("Ray and sphere helpers", "[Broadphase]") {
+    Aabb box{{1.0f, -1.0f, -1.0f}, {2.0f, 1.0f, 1.0f}};
+    float distance = 0.0f;
+
+    REQUIRE(intersectRay(box, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f / 0.0f, 1.0f / 0.0f}, 10.0f, distance));
+    REQUIRE(distance == 1.0f);
+    REQUIRE_FALSE(intersectRay(box, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f / 0.0f, 1.0f / 0.0f}, 0.5f, distance));
+    REQUIRE_FALSE(intersectRay(box, {0.0f, 0.0f, 0.0f}, {-1.0f, 1.0f / 0.0f, 1.0f / 0.0f}, 10.0f, distance));
+
+    REQUIRE(overlapsSphere(box, {0.0f, 0.0f, 0.0f}, 1.0f));
+    REQUIRE_FALSE(overlapsSphere(box, {0.0f, 0.0f, 0.0f}, 0.9f));
+}
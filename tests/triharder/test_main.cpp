@@ -1,2 +1,15 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch_all.hpp>
+#include "core/logging.h"
+
+//! Tests log to the console only, a file sink would write logs/ into the working directory.
+class TestLogConfiguration : public Catch::EventListenerBase {
+public:
+    using Catch::EventListenerBase::EventListenerBase;
+
+    void testRunStarting(const Catch::TestRunInfo&) override {
+        TriHarder::LogManager::getInstance().setDefaultTargets(TriHarder::LogTargets::Console);
+    }
+};
+
+CATCH_REGISTER_LISTENER(TestLogConfiguration)